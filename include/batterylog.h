@@ -0,0 +1,42 @@
+#pragma once
+
+#include <3ds.h>
+
+#include "sampler.h"
+
+typedef enum {
+    BATTERY_SAMPLE_CHARGING = BIT(0),
+    BATTERY_SAMPLE_ADAPTER = BIT(1)
+} BatterySampleFlags;
+
+typedef struct {
+    u32 time;        // Seconds since the recording started
+    u8 percentage;
+    u8 voltage;      // MCU units, 5 V / 256
+    u8 temperature;  // °C
+    u8 flags;        // BatterySampleFlags
+} BatterySample;
+
+// sdmc:/3ds/3dsident_battery.bin is a BatteryLogHeader followed by { BatteryBlockHeader, u8 data[length] } blocks,
+// one appended every time the block being filled in memory is full. Decode with tools/batterydecode.
+typedef struct {
+    char magic[4]; // "3DSB"
+    u16 version;
+    u16 blockSize;
+    u64 startTime; // osGetTime() at the first sample, milliseconds since 1900
+} BatteryLogHeader;
+
+typedef struct {
+    u16 length;
+    u16 count;
+} BatteryBlockHeader;
+
+namespace BatteryLog {
+    void Start(u32 interval);
+    void Stop(void);
+    void SetInterval(u32 interval);
+    u32 GetInterval(void);
+    void Record(const LiveInfo &info);
+    u32 GetCount(void);
+    u32 DecodeBlock(const u8 *data, u32 length, u32 skip, BatterySample *samples, u32 max);
+}
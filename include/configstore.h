@@ -0,0 +1,70 @@
+#pragma once
+
+#include <3ds.h>
+#include <memory>
+
+// Typed views of the config savegame blocks 3DSident reads, each tagged with its block ID.
+struct BacklightControlBlock {
+    static constexpr u32 id = 0x00050001;
+    u8 powerSavingEnabled;
+    u8 brightnessLevel;
+};
+
+struct AutoBrightnessBlock {
+    static constexpr u32 id = 0x00050009;
+    u32 unk1;
+    bool autoBrightnessEnabled;
+    u8 unk2[3];
+};
+
+struct SoundOutputModeBlock {
+    static constexpr u32 id = 0x00070001;
+    u8 mode;
+};
+
+struct UsernameBlock {
+    static constexpr u32 id = 0x000A0000;
+    u16 username[10];
+    u32 zero;
+    u32 ngWord;
+};
+
+struct BirthdayBlock {
+    static constexpr u32 id = 0x000A0001;
+    u8 month;
+    u8 day;
+};
+
+struct ParentalEmailBlock {
+    static constexpr u32 id = 0x000C0002;
+    u8 unk;
+    char email[0x1FF];
+};
+
+struct EulaVersionBlock {
+    static constexpr u32 id = 0x000D0000;
+    u8 minor;
+    u8 major;
+    u8 padding[2];
+};
+
+struct ParentalControlBlock {
+    static constexpr u32 id = 0x00100001;
+    u8 unk[13];
+    u8 pin[4];
+    u16 secretAnswer[64];
+    u8 padding[2];
+};
+
+namespace ConfigStore {
+    void Init(void);
+    void Exit(void);
+    void Invalidate(void);
+    bool GetBlock(u32 id, void *block, u32 size);
+
+    // Copies the block out of the store, false if it couldn't be read. Safe from any thread, a reload after
+    // Invalidate() happens under the same lock as the copy.
+    template<typename T> bool Get(T &block) {
+        return ConfigStore::GetBlock(T::id, std::addressof(block), sizeof(T));
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <3ds.h>
+
+#include "writer.h"
+
+typedef enum {
+    DISK_TEST_SEQUENTIAL_WRITE = 0,
+    DISK_TEST_SEQUENTIAL_READ,
+    DISK_TEST_RANDOM_WRITE,
+    DISK_TEST_RANDOM_READ,
+    DISK_TEST_MAX
+} DiskTest;
+
+typedef struct {
+    WriterBackend backend;  // WRITER_BACKEND_FS for the SD archive, WRITER_BACKEND_POSIX for a host file
+    const char *path;       // Scratch file, created by the benchmark and deleted when it finishes
+    u32 fileSize;
+    u32 blockSize;          // Sequential transfer size
+    u32 randomBlockSize;
+    u32 randomOps;
+    u32 queueDepth;         // Requests in flight, each with its own buffer
+} DiskBenchConfig;
+
+typedef struct {
+    Result result;
+    u32 ops;
+    u32 queueDepth;         // Depth actually reached, lower than configured if a worker couldn't be started
+    u64 bytes;
+    u64 ticks;
+    float mbPerSecond;
+    float iops;
+    u32 latency50;          // Per request latency percentiles in microseconds
+    u32 latency90;
+    u32 latency99;
+    u32 latencyMax;
+} DiskBenchResult;
+
+namespace DiskBench {
+    static const u32 maxQueueDepth = 4;
+
+    void GetDefaultConfig(DiskBenchConfig &config);
+    Result Run(const DiskBenchConfig &config, DiskBenchResult *results);
+    bool Start(const DiskBenchConfig &config);
+    void Stop(void);
+    bool IsRunning(void);
+    float GetProgress(void);
+    void GetResults(DiskBenchResult *results);
+    const char *GetTestName(DiskTest test);
+}
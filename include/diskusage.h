@@ -0,0 +1,48 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef enum {
+    DISK_USAGE_SDMC = 0,
+    DISK_USAGE_NAND_CTR,    // Listed read-only
+    DISK_USAGE_NAND_TWL,
+    DISK_USAGE_MAX
+} DiskUsageArchive;
+
+// One directory of the tree. Children are a linked list through firstChild/nextSibling, files are only counted.
+typedef struct {
+    u32 parent;
+    u32 firstChild;
+    u32 nextSibling;
+    u32 name;               // Offset into the name pool
+    u64 ownBytes;           // Files directly inside
+    u64 totalBytes;         // Including every subdirectory
+    u32 files;
+    u32 signature;          // Hash of the last listing, a different one marks the directory as changed
+    u32 generation;         // Walk that last saw this directory
+} DiskUsageNode;
+
+typedef struct {
+    u32 nodes;
+    u32 listed;             // Directories listed by the current or last walk
+    u32 changed;            // Of those, how many differ from the cached tree
+    u32 pending;            // Directories still queued
+    u32 truncated;          // Directories left out because the tree is full
+    u32 errors;
+} DiskUsageStats;
+
+namespace DiskUsage {
+    static const u32 none = 0xFFFFFFFF;
+
+    bool Start(DiskUsageArchive archive);
+    bool Refresh(u32 node);
+    bool Step(u64 budget);
+    void Stop(void);
+    bool IsBusy(void);
+    DiskUsageArchive GetArchive(void);
+    void GetStats(DiskUsageStats &stats);
+    const DiskUsageNode *GetNode(u32 node);
+    const char *GetName(u32 node);
+    u32 GetChildren(u32 node, u32 *children, u32 max);
+    const char *GetArchiveName(DiskUsageArchive archive);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "probe.h"
+#include "writer.h"
+
+typedef enum {
+    EXPORT_FORMAT_JSON = 0,
+    EXPORT_FORMAT_CSV,
+    EXPORT_FORMAT_BINARY,
+    EXPORT_FORMAT_MAX
+} ExportFormat;
+
+namespace Export {
+    void WriteJsonString(FileWriter &writer, const char *text, u32 length);
+    Result Write(FileWriter &writer, ExportFormat format, const ProbeResults &results, u32 mask, bool displayInfo);
+    Result Save(WriterBackend backend, const char *path, const ProbeResults &results, u32 mask, bool displayInfo);
+}
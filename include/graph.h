@@ -0,0 +1,29 @@
+#pragma once
+
+#include <3ds.h>
+
+// Scrolling time series, decimated to one min/max column per pixel as samples arrive. Drawing a series costs one
+// column per pixel however long its history is.
+typedef struct {
+    float min;
+    float max;
+    float last;
+} GraphColumn;
+
+typedef struct {
+    GraphColumn columns[400];
+    u32 width;            // Columns in use, one per pixel
+    u32 samplesPerColumn;
+    u32 head;             // Newest column
+    u32 count;            // Columns filled so far
+    u32 pending;          // Samples already in the newest column
+    float rangeMin;
+    float rangeMax;
+} GraphSeries;
+
+namespace Graph {
+    void Init(GraphSeries &series, u32 width, u32 samplesPerColumn, float rangeMin, float rangeMax);
+    void Push(GraphSeries &series, float value);
+    void Load(GraphSeries &series, const float *values, u32 count);
+    const GraphColumn &GetColumn(const GraphSeries &series, u32 index);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <3ds.h>
+
+#include "probe.h"
+#include "sampler.h"
+
+typedef struct {
+    u32 connections;        // Open right now
+    u32 accepted;
+    u32 requests;
+    u32 errors;             // Requests answered with a 4xx or 5xx status
+    u64 bytes;
+    u32 reportVersion;      // Publishes serialized so far, 0 until the first
+    u32 liveVersion;
+} HttpServerStats;
+
+namespace HttpServer {
+    static const u16 defaultPort = 8080;
+
+    void Publish(const ProbeResults &results, u32 mask, bool displayInfo);
+    void PublishLive(const LiveInfo &info);
+    Result Open(u16 port);
+    void Poll(int timeout);
+    void Close(void);
+    bool Start(u16 port);
+    void Stop(void);
+    bool IsRunning(void);
+    void GetStats(HttpServerStats &stats);
+}
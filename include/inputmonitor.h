@@ -0,0 +1,44 @@
+#pragma once
+
+#include <3ds.h>
+
+#include "stickstats.h"
+#include "touchtest.h"
+
+typedef struct {
+    u32 updates;                 // Pad updates seen
+    u32 missed;                  // Updates HID overwrote before the monitor could see them
+    u64 firstTick;               // HID timestamp of the first and latest update
+    u64 lastTick;
+    double intervalMean;         // Ticks between HID updates, running mean and sum of squared differences
+    double intervalM2;
+    u64 delayTotal;              // Ticks from HID writing an update to the monitor seeing it
+    u32 intervalHistogram[64];   // 0.25 ms buckets, the last one also counts everything longer
+    u32 latencies;
+    u64 latencyTotal;
+    u64 latencyMax;
+    u32 latencyHistogram[64];    // 1 ms buckets
+} InputTiming;
+
+// One entry of the stick trace, written for every HID pad update. Replay with tools/stickreplay.
+typedef struct {
+    u64 tick;
+    s16 padX;
+    s16 padY;
+    s16 stickX;
+    s16 stickY;
+} StickTraceSample;
+
+namespace InputMonitor {
+    void Start(void);
+    void Stop(void);
+    void Reset(void);
+    void GetTiming(InputTiming &timing);
+    bool TakePress(u32 keys, u64 &tick);
+    void RecordLatency(u64 ticks);
+    Result Export(const char *path);
+    void GetSticks(StickInfo &pad, StickInfo &stick);
+    bool HasCstick(void);
+    Result ExportSticks(const char *path);
+    u32 ReadTouch(u32 from, TouchSample *samples, u32 max);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <3ds.h>
+
+#if defined BUILD_TRACE
+namespace IPCStats {
+    void Init(void);
+    void Register(const char *name, Handle *session);
+    bool Dump(const char *path);
+}
+#endif
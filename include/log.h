@@ -1,9 +1,51 @@
 #pragma once
 
 #include <3ds.h>
+#include <cstdarg>
+
+typedef enum {
+    LOG_LEVEL_TRACE = 0,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_MAX
+} LogLevel;
+
+typedef enum {
+    LOG_FORMAT_TEXT = 0,
+    LOG_FORMAT_BINARY
+} LogFormat;
+
+// Binary logs start with this header, followed by LogRecordHeader + text records. Decode with tools/logdecode.
+typedef struct {
+    char magic[4]; // "3DSL"
+    u16 version;
+    u16 reserved;
+    u32 tickRate;
+    u32 reserved2;
+    u64 baseTick;
+} LogFileHeader;
+
+typedef struct {
+    u64 tick;
+    u8 level;
+    u8 reserved;
+    u16 length;
+} LogRecordHeader;
 
 namespace Log {
-    Result Open(void);
+    // Records are queued without blocking and written by a background thread, so every level can be used from the
+    // render loop. When the queue is full the record is dropped and counted instead.
+    Result Open(LogFormat format = LOG_FORMAT_TEXT);
     Result Close(void);
-    void Error(const char *data, ...);
+    void SetLevel(LogLevel level);
+    bool IsEnabled(LogLevel level);
+    void WriteV(LogLevel level, const char *format, va_list args);
+    void Write(LogLevel level, const char *format, ...);
+    void Debug(const char *format, ...);
+    void Info(const char *format, ...);
+    void Warn(const char *format, ...);
+    void Error(const char *format, ...);
+    u32 GetDropped(LogLevel level);
 }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <3ds.h>
+
+namespace LogScanner {
+    // A "key<value>terminator" pair to pull out of a log. The value runs from the first occurrence of key up to the
+    // first occurrence of terminators[0] after it, or of terminators[1] (may be nullptr) if the former never follows.
+    typedef struct {
+        const char *key;
+        const char *terminators[2];
+        char value[32];
+
+        // Scan state, cleared by Reset()
+        u32 keyLength;
+        u32 terminatorLength[2];
+        u32 keyMatched;
+        u32 consumed;
+        u32 terminatorMatched[2];
+        s32 length[2];
+        bool done;
+    } Field;
+
+    void Reset(Field *fields, u32 count);
+    bool Feed(Field *fields, u32 count, const char *data, u32 size);
+    const char *GetValue(Field &field);
+    Result ScanFile(FS_ArchiveID archiveId, const char *path, Field *fields, u32 count);
+}
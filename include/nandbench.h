@@ -0,0 +1,33 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef enum {
+    NAND_BENCH_CTR = 0,  // ARCHIVE_NAND_CTR_FS
+    NAND_BENCH_TWL,      // ARCHIVE_NAND_TWL_FS
+    NAND_BENCH_MAX
+} NandBenchArchive;
+
+typedef struct {
+    Result result;
+    u32 files;
+    u32 reads;
+    u32 errors;             // Files or reads that failed, the walk carries on past them
+    u64 bytes;
+    u64 ticks;              // Time spent inside FSFILE_Read
+    float mbPerSecond;
+    u32 latency50;          // Per read latency percentiles in microseconds
+    u32 latency90;
+    u32 latency99;
+    u32 latencyMax;
+    u32 histogram[64];      // Quarter octave buckets, bucket n counts reads of about 2^(n / 4) microseconds
+} NandBenchResult;
+
+namespace NandBench {
+    bool Start(u32 chunkSize, u32 budget);
+    void Stop(void);
+    bool IsRunning(void);
+    float GetProgress(void);
+    void GetResults(NandBenchResult *results);
+    const char *GetArchiveName(NandBenchArchive archive);
+}
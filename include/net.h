@@ -0,0 +1,16 @@
+#pragma once
+
+#include <3ds.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace Net {
+    // A peer that goes away mid-send() raises SIGPIPE where the flag exists, it is an error return instead.
+#if defined MSG_NOSIGNAL
+    static const int sendFlags = MSG_NOSIGNAL;
+#else
+    static const int sendFlags = 0;
+#endif
+
+    Result Resolve(const char *host, u16 port, struct sockaddr_in &address);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef enum {
+    NET_TEST_TCP_UPLOAD = 0,
+    NET_TEST_TCP_DOWNLOAD,
+    NET_TEST_UDP_PING,
+    NET_TEST_MAX
+} NetTest;
+
+typedef struct {
+    const char *host;       // Machine running tools/netserver, dotted IPv4 or a name
+    u16 port;               // Same number for the TCP and the UDP side
+    u32 bytes;              // Transferred by each TCP test
+    u32 bufferSize;         // One send()/recv() worth, allocated once per run
+    u32 pings;
+    u32 pingSize;
+    u32 pingInterval;       // Milliseconds between pings
+    u32 timeout;            // Milliseconds before a stalled transfer fails or a ping counts as lost
+} NetBenchConfig;
+
+typedef struct {
+    Result result;          // 0, or minus the errno of the call that failed
+    u64 bytes;
+    u64 ticks;
+    float mbitPerSecond;
+    u32 sent;               // UDP only
+    u32 received;
+    float loss;             // Percent of pings without a reply in time
+    u32 rtt50;              // Round trip percentiles in microseconds
+    u32 rtt90;
+    u32 rtt99;
+    u32 rttMax;
+} NetBenchResult;
+
+// Wire format shared with tools/netserver. Fields are little endian, which both ends are.
+typedef struct {
+    u32 magic;
+    u32 mode;               // NET_TEST_TCP_UPLOAD or NET_TEST_TCP_DOWNLOAD
+    u64 bytes;
+} NetBenchRequest;
+
+typedef struct {
+    u32 magic;
+    u32 sequence;
+    u64 tick;               // Sender's clock, echoed back untouched
+} NetBenchPing;
+
+namespace NetBench {
+    static const u32 magic = 0x4E334453;
+    static const u16 defaultPort = 5311;
+
+    void GetDefaultConfig(NetBenchConfig &config);
+    Result Run(const NetBenchConfig &config, NetBenchResult *results);
+    bool Start(const NetBenchConfig &config);
+    void Stop(void);
+    bool IsRunning(void);
+    float GetProgress(void);
+    void GetResults(NetBenchResult *results);
+    const char *GetTestName(NetTest test);
+}
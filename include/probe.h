@@ -0,0 +1,34 @@
+#pragma once
+
+#include "service.h"
+
+typedef enum {
+    PROBE_KERNEL_INFO = 0,
+    PROBE_SYSTEM_INFO,
+    PROBE_NNID_INFO,
+    PROBE_CONFIG_INFO,
+    PROBE_HARDWARE_INFO,
+    PROBE_WIFI_INFO,
+    PROBE_STORAGE_INFO,
+    PROBE_MISC_INFO,
+    PROBE_SYSTEM_STATE_INFO,
+    PROBE_MAX
+} ProbeId;
+
+typedef struct {
+    KernelInfo kernelInfo;
+    SystemInfo systemInfo;
+    NNIDInfo nnidInfo;
+    ConfigInfo configInfo;
+    HardwareInfo hardwareInfo;
+    WifiInfo wifiInfo;
+    StorageInfo storageInfo;
+    MiscInfo miscInfo;
+    SystemStateInfo systemStateInfo;
+} ProbeResults;
+
+namespace Probe {
+    void Start(void);
+    void Stop(void);
+    u32 Read(ProbeResults &results);
+}
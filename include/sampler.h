@@ -0,0 +1,44 @@
+#pragma once
+
+#include "service.h"
+
+typedef enum {
+    SAMPLER_FIELD_BATTERY_PERCENTAGE = 0,
+    SAMPLER_FIELD_BATTERY_CHARGING,
+    SAMPLER_FIELD_BATTERY_VOLTAGE,
+    SAMPLER_FIELD_BATTERY_TEMPERATURE,
+    SAMPLER_FIELD_ADAPTER_STATE,
+    SAMPLER_FIELD_MCU_FIRMWARE,
+    SAMPLER_FIELD_AUDIO_JACK,
+    SAMPLER_FIELD_CARD_SLOT,
+    SAMPLER_FIELD_SD_INSERTED,
+    SAMPLER_FIELD_BRIGHTNESS,
+    SAMPLER_FIELD_WIFI_STRENGTH,
+    SAMPLER_FIELD_HOSTNAME,
+    SAMPLER_FIELD_STORAGE,
+    SAMPLER_FIELD_MAX
+} SamplerField;
+
+typedef struct {
+    u8 batteryPercentage;
+    bool batteryCharging;
+    u8 batteryVoltage;
+    u8 batteryTemperature;
+    bool adapterConnected;
+    u8 mcuFwVerHigh;
+    u8 mcuFwVerLow;
+    bool audioJackInserted;
+    bool cardSlotInserted;
+    bool sdInserted;
+    u32 brightness;
+    u8 wifiStrength;
+    char hostname[64];
+    StorageInfo storage;
+    u32 valid; // Bit per SamplerField, set when its latest sample succeeded
+} LiveInfo;
+
+namespace Sampler {
+    void Start(void);
+    void Stop(void);
+    bool Read(LiveInfo &info);
+}
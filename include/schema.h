@@ -0,0 +1,44 @@
+#pragma once
+
+#include "probe.h"
+
+typedef enum {
+    FIELD_STRING = 0, // const char * member
+    FIELD_CHARS,      // Inline NUL padded char array
+    FIELD_UNSIGNED,   // Unsigned integer of 1, 2, 4 or 8 bytes
+    FIELD_SIGNED,     // Signed integer of 1, 2, 4 or 8 bytes
+    FIELD_BOOL
+} FieldType;
+
+enum {
+    FIELD_FLAG_PERSISTED = BIT(0), // Kept in the snapshot cache, secrets never are
+    FIELD_FLAG_PRIVATE = BIT(1)    // Hidden on screen and in reports while displayInfo is off
+};
+
+typedef struct {
+    const char *name;
+    FieldType type;
+    u8 flags;
+    u16 offset;
+    u16 size;
+} FieldInfo;
+
+typedef struct {
+    ProbeId id;
+    const char *name;
+    u16 offset;
+    const FieldInfo *fields;
+    u32 count;
+} GroupInfo;
+
+// Describes every ProbeResults field, so the snapshot cache and the report exporter can walk them generically.
+namespace Schema {
+    const GroupInfo *GetGroups(u32 &count);
+    const GroupInfo *GetGroup(ProbeId id);
+    u8 *GetField(ProbeResults &results, const GroupInfo &group, const FieldInfo &field);
+    const u8 *GetField(const ProbeResults &results, const GroupInfo &group, const FieldInfo &field);
+    const char *GetString(const u8 *member);
+    void SetString(u8 *member, const char *string);
+    u64 GetUnsigned(const u8 *member, u32 size);
+    s64 GetSigned(const u8 *member, u32 size);
+}
@@ -57,6 +57,7 @@ typedef struct {
 } WifiInfo;
 
 typedef struct {
+    FS_ArchiveResource resource[4]; // Last resource each size below was derived from
     u64 usedSize[4];
     u64 totalSize[4];
     char freeSizeString[4][16];
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdio>
+
+#include "probe.h"
+
+namespace Snapshot {
+    u32 Load(const char *path, ProbeResults &results);
+    u32 Merge(ProbeId id, ProbeResults &results, const ProbeResults &fresh);
+    bool Save(const char *path, const ProbeResults &results, u32 mask);
+    void Print(std::FILE *file, const ProbeResults &results, u32 mask);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <3ds.h>
+
+// Running statistics for one analog stick, every sample is folded in with O(1) work and nothing is rescanned.
+typedef struct {
+    u32 count;
+    double meanX;        // Welford running means and sums of squared differences
+    double meanY;
+    double m2X;
+    double m2Y;
+    s16 minX;
+    s16 maxX;
+    s16 minY;
+    s16 maxY;
+    u32 deadZone;        // Radius below which the stick counts as centred
+    u32 outside;         // Samples beyond the dead zone
+    u32 excursions;      // Times the stick left the dead zone
+    u32 maxRadius;
+    bool wasOutside;
+    u32 coveredCells;    // Occupancy cells with at least one sample
+    u32 occupancy[32][32];
+} StickInfo;
+
+namespace StickStats {
+    static const s32 range = 160;   // Positions are clamped to [-range, range), 10 units per occupancy cell
+
+    void Init(StickInfo &stats, u32 deadZone);
+    void Add(StickInfo &stats, s16 x, s16 y);
+    double GetStdDevX(const StickInfo &stats);
+    double GetStdDevY(const StickInfo &stats);
+}
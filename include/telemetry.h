@@ -0,0 +1,75 @@
+#pragma once
+
+#include <3ds.h>
+
+#include "sampler.h"
+
+typedef enum {
+    TELEMETRY_FLAG_CHARGING = BIT(0),
+    TELEMETRY_FLAG_ADAPTER = BIT(1),
+    TELEMETRY_FLAG_SD_INSERTED = BIT(2)
+} TelemetryFlags;
+
+typedef struct {
+    const char *host;       // Machine running tools/collector, dotted IPv4 or a name
+    u16 port;
+    u32 period;             // Milliseconds between samples
+    u32 batch;              // Samples per datagram, at most Telemetry::maxSamples
+    u32 flushInterval;      // Milliseconds a partly filled datagram may wait before it is sent anyway
+} TelemetryConfig;
+
+typedef struct {
+    Result result;          // 0, or minus the errno of the last send that failed
+    u32 session;
+    u32 samples;
+    u32 datagrams;          // Sent, including the ones that failed
+    u32 errors;             // Sends that failed, the collector sees each one as a gap in the sequence
+    u64 bytes;
+} TelemetryStats;
+
+// Wire format shared with tools/collector. Fields are little endian, which both ends are, and naturally aligned so
+// neither struct has padding: a 16 byte TelemetryHeader followed by count 24 byte samples. Datagrams are never
+// retransmitted, the collector counts gaps in sequence.
+typedef struct {
+    u32 magic;
+    u16 version;
+    u16 count;
+    u32 session;            // Random per Open(), each session numbers its datagrams from 0
+    u32 sequence;
+} TelemetryHeader;
+
+typedef struct {
+    u32 time;               // Milliseconds since the session was opened
+    u16 valid;              // Bit per SamplerField, set when the value below it comes from was sampled
+    u8 flags;               // TelemetryFlags
+    u8 batteryPercentage;
+    u8 batteryVoltage;      // MCU units, 5 V / 256
+    u8 batteryTemperature;  // °C
+    u8 wifiStrength;        // 0 to 3
+    u8 reserved;
+    u16 frameTimeAvg;       // Microseconds, over the frames since the previous sample, 0 when none were recorded
+    u16 frameTimeMax;
+    u32 sdFree;             // MiB
+    u32 nandFree;           // MiB, CTR NAND
+} TelemetrySample;
+
+namespace Telemetry {
+    static const u32 magic = 0x54334453;
+    static const u16 version = 1;
+    static const u16 defaultPort = 5313;
+    // 1500 byte Ethernet MTU less the IPv4 and UDP headers, larger datagrams would be fragmented.
+    static const u32 maxDatagram = 1472;
+    static const u32 maxSamples = (maxDatagram - sizeof(TelemetryHeader)) / sizeof(TelemetrySample);
+
+    void GetDefaultConfig(TelemetryConfig &config);
+    void MakeSample(TelemetrySample &sample, const LiveInfo &info, u32 time);
+    void RecordFrame(u64 ticks);
+    Result Open(const TelemetryConfig &config);
+    Result Add(const TelemetrySample &sample);
+    Result Flush(void);
+    void Close(void);
+    bool Start(const TelemetryConfig &config);
+    void Stop(void);
+    bool IsRunning(void);
+    void GetStats(TelemetryStats &stats);
+}
@@ -2,7 +2,7 @@
 
 #include <citro2d.h>
 
-extern C2D_Image banner, driveIcon, menuIcon[10], btnA, btnB, btnX, btnY, btnStartSelect, btnL, btnR,
+extern C2D_Image banner, driveIcon, menuIcon[11], btnA, btnB, btnX, btnY, btnStartSelect, btnL, btnR,
     btnZL, btnZR, btnDpad, btnCpad, btnCstick, btnHome, cursor, volumeIcon;
 
 namespace Textures {
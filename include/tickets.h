@@ -0,0 +1,23 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef struct {
+    u32 tickets;
+    u32 titles;            // Installed titles on NAND and SD, duplicates across media counted once
+    u32 matched;
+    u32 orphanTickets;     // Tickets with no installed title
+    u32 missingTickets;    // Installed titles with no ticket
+} TicketJoinCounts;
+
+namespace Tickets {
+    u32 Join(const u64 *tickets, u32 ticketCount, const u64 *titles, u32 titleCount, u64 *orphans, u64 *missing, TicketJoinCounts &counts);
+    bool Start(void);
+    void Stop(void);
+    bool IsRunning(void);
+    Result GetResult(void);
+    void GetCounts(TicketJoinCounts &counts);
+    const u64 *GetOrphans(void);
+    const u64 *GetMissing(void);
+    Result Export(const char *path);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef enum {
+    TITLE_SORT_ID = 0,
+    TITLE_SORT_SIZE,
+    TITLE_SORT_CATEGORY,
+    TITLE_SORT_VERSION,
+    TITLE_SORT_MAX
+} TitleSortKey;
+
+// Struct of arrays, one column per field so a sort only touches the column it compares. order is the current sort
+// permutation, row i of the sorted view is index order[i] of every column.
+typedef struct {
+    u32 count;
+    u64 *ids;
+    u64 *sizes;
+    u16 *versions;
+    u16 *categories;            // Bits 32-47 of the title ID, 0x0000 application, 0x000E update, 0x008C DLC...
+    u8 *media;                  // FS_MediaType
+    u32 *order;
+    u32 mediaCounts[3];         // Per FS_MediaType: NAND, SD, game card
+    u64 mediaSizes[3];
+    u32 errors;                 // Titles AM couldn't describe, left with a zero size
+    Result result;              // amInit() failure, nothing was listed
+    Result mediaResults[3];     // Per FS_MediaType, the AM_GetTitleCount() failure that left it out
+} TitleTable;
+
+namespace Titles {
+    bool Start(void);
+    void Stop(void);
+    bool IsRunning(void);
+    float GetProgress(void);
+    const TitleTable &GetTable(void);
+    void Sort(TitleSortKey key);
+    const char *GetSortName(TitleSortKey key);
+    const char *GetMediaName(FS_MediaType media);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <3ds.h>
+
+// A captured touch sample, x is touchPenUp where the pen was lifted.
+typedef struct {
+    u16 x;
+    u16 y;
+} TouchSample;
+
+static const u16 touchPenUp = 0xFFFF;
+
+// Coverage of the 320x240 panel in 8x8 cells, and the grid linearity test. Both are updated sample by sample.
+typedef struct {
+    u16 coverage[30][40];
+    u32 coveredCells;
+    u32 samples;
+    bool penDown;
+    bool gridRunning;
+    u32 target;               // Next grid target, gridColumns * gridRows once every target was hit
+    u32 pressSamples;         // Samples of the current press, averaged when the pen is lifted
+    u32 pressX;
+    u32 pressY;
+    s16 errorX[4][5];         // Measured minus expected position of each grid target
+    s16 errorY[4][5];
+} TouchInfo;
+
+namespace TouchTest {
+    static const u32 gridColumns = 5, gridRows = 4;
+
+    void Init(TouchInfo &info);
+    void Add(TouchInfo &info, const TouchSample &sample);
+    void StartGrid(TouchInfo &info);
+    void GetTarget(u32 index, u16 &x, u16 &y);
+    u32 GetDeadCells(const TouchInfo &info);
+    float GetError(const TouchInfo &info, u32 index);
+    Result Export(const TouchInfo &info, const char *path);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <3ds.h>
+
+#if defined BUILD_TRACE
+namespace Trace {
+    void Init(void);
+    void Record(const char *name, u64 begin, u64 end);
+    bool Dump(const char *path);
+
+    class Scope {
+        public:
+            explicit Scope(const char *name) : name(name), begin(svcGetSystemTick()) {}
+            ~Scope() {
+                Trace::Record(name, begin, svcGetSystemTick());
+            }
+
+        private:
+            const char *name;
+            u64 begin;
+    };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
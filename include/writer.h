@@ -0,0 +1,30 @@
+#pragma once
+
+#include <3ds.h>
+
+typedef enum {
+    WRITER_BACKEND_FS = 0, // FSUSER on the SD archive, paths are relative to the SD root
+    WRITER_BACKEND_POSIX,  // open/write, for sdmc:/ paths through newlib or host builds
+    WRITER_BACKEND_MEMORY  // Into a caller's buffer, see Writer::OpenMemory()
+} WriterBackend;
+
+typedef struct {
+    WriterBackend backend;
+    FS_Archive archive;
+    Handle handle;
+    int fd;
+    u8 *memory;
+    u32 capacity;
+    u64 offset;
+    u32 length;
+    Result result; // First failure, later writes are dropped
+    u8 buffer[0x4000];
+} FileWriter;
+
+namespace Writer {
+    Result Open(FileWriter &writer, WriterBackend backend, const char *path);
+    Result OpenMemory(FileWriter &writer, void *data, u32 capacity);
+    void Write(FileWriter &writer, const void *data, u32 size);
+    void Printf(FileWriter &writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+    Result Close(FileWriter &writer);
+}
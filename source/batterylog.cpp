@@ -0,0 +1,286 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstring>
+
+#include "batterylog.h"
+#include "log.h"
+
+// Samples are encoded into one block in memory, which is appended to the file on the SD card once it is full. Every
+// block starts with a keyframe, so blocks decode on their own:
+//   Keyframe { varint time, varint interval, u8 percentage, u8 voltage, u8 temperature, u8 flags }
+//   Delta    { u8 mask, [varint time delta], [zigzag percentage], [zigzag voltage], [zigzag temperature], [u8 flags] }
+// A mask bit is set for each value that changed, the time delta is only stored when it isn't the block's interval.
+// A steady sample costs one byte, typical ones two or three.
+
+namespace BatteryLog {
+    enum {
+        DELTA_TIME = BIT(0),
+        DELTA_PERCENTAGE = BIT(1),
+        DELTA_VOLTAGE = BIT(2),
+        DELTA_TEMPERATURE = BIT(3),
+        DELTA_FLAGS = BIT(4)
+    };
+
+    // A steady sample encodes to a byte or two, so a block reaches the SD card every 20 to 40 minutes at the default
+    // 10 second interval.
+    static const u32 batteryBlockSize = 256;
+    static const u32 batteryMaxRecordSize = 14;
+    static const char *batteryPath = "sdmc:/3ds/3dsident_battery.bin";
+
+    static u8 batteryBlock[batteryBlockSize];
+    static u16 batteryLength = 0, batteryCount = 0;
+    static u32 batteryTotal = 0;
+    static u32 batteryInterval = 10, batteryBlockInterval = 0;
+    static u64 batteryStartTime = 0;
+    static BatterySample batteryLast;
+    static bool batteryRunning = false, batteryFileValid = false;
+    static LightLock batteryLock;
+
+    static u32 PutVarint(u8 *out, u32 value) {
+        u32 size = 0;
+
+        while (value >= 0x80) {
+            out[size++] = static_cast<u8>(value) | 0x80;
+            value >>= 7;
+        }
+
+        out[size++] = static_cast<u8>(value);
+        return size;
+    }
+
+    static bool GetVarint(const u8 *data, u32 length, u32 &position, u32 &value) {
+        value = 0;
+
+        for (u32 shift = 0; (position < length) && (shift < 32); shift += 7) {
+            u8 byte = data[position++];
+            value |= static_cast<u32>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static u32 PutDelta(u8 *out, u8 current, u8 previous) {
+        s32 delta = static_cast<s32>(current) - static_cast<s32>(previous);
+        return BatteryLog::PutVarint(out, static_cast<u32>((delta << 1) ^ (delta >> 31)));
+    }
+
+    static bool GetDelta(const u8 *data, u32 length, u32 &position, u8 &value) {
+        u32 zigzag = 0;
+
+        if (!BatteryLog::GetVarint(data, length, position, zigzag)) {
+            return false;
+        }
+
+        value = static_cast<u8>(value + static_cast<s32>((zigzag >> 1) ^ (0 - (zigzag & 1))));
+        return true;
+    }
+
+    static void Append(void) {
+        std::FILE *file = std::fopen(batteryPath, batteryFileValid? "ab" : "wb");
+        if (!file) {
+            Log::Error("%s: can't open %s\n", __func__, batteryPath);
+            return;
+        }
+
+        if (!batteryFileValid) {
+            BatteryLogHeader header = { { '3', 'D', 'S', 'B' }, 1, batteryBlockSize, batteryStartTime };
+            std::fwrite(std::addressof(header), sizeof(header), 1, file);
+            batteryFileValid = true;
+        }
+
+        BatteryBlockHeader header = { batteryLength, batteryCount };
+        std::fwrite(std::addressof(header), sizeof(header), 1, file);
+        std::fwrite(batteryBlock, 1, batteryLength, file);
+        std::fclose(file);
+    }
+
+    // Caller holds batteryLock. A completed block is appended to the SD card before the next one starts in its place.
+    static void Encode(const BatterySample &sample) {
+        bool keyframe = (batteryCount == 0) || (batteryBlockInterval != batteryInterval) || (batteryLength + batteryMaxRecordSize > batteryBlockSize);
+
+        if (keyframe && batteryCount) {
+            BatteryLog::Append();
+        }
+
+        if (keyframe) {
+            batteryLength = 0;
+            batteryCount = 0;
+            batteryBlockInterval = batteryInterval;
+        }
+
+        u8 *out = batteryBlock + batteryLength;
+        u32 size = 0;
+
+        if (keyframe) {
+            size += BatteryLog::PutVarint(out + size, sample.time);
+            size += BatteryLog::PutVarint(out + size, batteryBlockInterval);
+            out[size++] = sample.percentage;
+            out[size++] = sample.voltage;
+            out[size++] = sample.temperature;
+            out[size++] = sample.flags;
+        }
+        else {
+            u32 elapsed = sample.time - batteryLast.time;
+            u8 mask = (elapsed != batteryBlockInterval? DELTA_TIME : 0) | (sample.percentage != batteryLast.percentage? DELTA_PERCENTAGE : 0) |
+                (sample.voltage != batteryLast.voltage? DELTA_VOLTAGE : 0) | (sample.temperature != batteryLast.temperature? DELTA_TEMPERATURE : 0) |
+                (sample.flags != batteryLast.flags? DELTA_FLAGS : 0);
+
+            out[size++] = mask;
+
+            if (mask & DELTA_TIME) {
+                size += BatteryLog::PutVarint(out + size, elapsed);
+            }
+            if (mask & DELTA_PERCENTAGE) {
+                size += BatteryLog::PutDelta(out + size, sample.percentage, batteryLast.percentage);
+            }
+            if (mask & DELTA_VOLTAGE) {
+                size += BatteryLog::PutDelta(out + size, sample.voltage, batteryLast.voltage);
+            }
+            if (mask & DELTA_TEMPERATURE) {
+                size += BatteryLog::PutDelta(out + size, sample.temperature, batteryLast.temperature);
+            }
+            if (mask & DELTA_FLAGS) {
+                out[size++] = sample.flags;
+            }
+        }
+
+        batteryLength += size;
+        batteryCount++;
+        batteryTotal++;
+        batteryLast = sample;
+    }
+
+    // Decodes one block, skipping its first skip samples. Returns the number of samples written to samples.
+    u32 DecodeBlock(const u8 *data, u32 length, u32 skip, BatterySample *samples, u32 max) {
+        BatterySample sample = { 0 };
+        u32 position = 0, interval = 0, count = 0, decoded = 0;
+
+        if (!BatteryLog::GetVarint(data, length, position, sample.time) || !BatteryLog::GetVarint(data, length, position, interval) ||
+            (position + 4 > length)) {
+            return 0;
+        }
+
+        sample.percentage = data[position++];
+        sample.voltage = data[position++];
+        sample.temperature = data[position++];
+        sample.flags = data[position++];
+
+        while (true) {
+            if (decoded >= skip) {
+                if (count >= max) {
+                    break;
+                }
+
+                samples[count++] = sample;
+            }
+
+            decoded++;
+
+            if (position >= length) {
+                break;
+            }
+
+            u8 mask = data[position++];
+            u32 elapsed = interval;
+
+            if ((mask & DELTA_TIME) && !BatteryLog::GetVarint(data, length, position, elapsed)) {
+                break;
+            }
+            if ((mask & DELTA_PERCENTAGE) && !BatteryLog::GetDelta(data, length, position, sample.percentage)) {
+                break;
+            }
+            if ((mask & DELTA_VOLTAGE) && !BatteryLog::GetDelta(data, length, position, sample.voltage)) {
+                break;
+            }
+            if ((mask & DELTA_TEMPERATURE) && !BatteryLog::GetDelta(data, length, position, sample.temperature)) {
+                break;
+            }
+            if (mask & DELTA_FLAGS) {
+                if (position >= length) {
+                    break;
+                }
+
+                sample.flags = data[position++];
+            }
+
+            sample.time += elapsed;
+        }
+
+        return count;
+    }
+
+    void Start(u32 interval) {
+        LightLock_Init(std::addressof(batteryLock));
+        batteryInterval = interval? interval : 1;
+        batteryLength = 0;
+        batteryCount = 0;
+        batteryTotal = 0;
+        batteryStartTime = 0;
+        batteryFileValid = false;
+        batteryRunning = true;
+    }
+
+    // Writes the partially filled block, so the file ends with the latest sample.
+    void Stop(void) {
+        LightLock_Lock(std::addressof(batteryLock));
+
+        if (batteryRunning && batteryCount) {
+            BatteryLog::Append();
+        }
+
+        batteryRunning = false;
+        LightLock_Unlock(std::addressof(batteryLock));
+    }
+
+    void SetInterval(u32 interval) {
+        LightLock_Lock(std::addressof(batteryLock));
+        batteryInterval = interval? interval : 1;
+        LightLock_Unlock(std::addressof(batteryLock));
+    }
+
+    u32 GetInterval(void) {
+        return batteryInterval;
+    }
+
+    // Called by the sampler thread after every pass, records a sample once the interval has elapsed and every battery
+    // field has a valid reading.
+    void Record(const LiveInfo &info) {
+        const u32 required = BIT(SAMPLER_FIELD_BATTERY_PERCENTAGE) | BIT(SAMPLER_FIELD_BATTERY_CHARGING) | BIT(SAMPLER_FIELD_BATTERY_VOLTAGE) |
+            BIT(SAMPLER_FIELD_BATTERY_TEMPERATURE) | BIT(SAMPLER_FIELD_ADAPTER_STATE);
+
+        if ((info.valid & required) != required) {
+            return;
+        }
+
+        u64 now = osGetTime();
+        LightLock_Lock(std::addressof(batteryLock));
+
+        if (!batteryRunning) {
+            LightLock_Unlock(std::addressof(batteryLock));
+            return;
+        }
+
+        if (!batteryStartTime) {
+            batteryStartTime = now;
+        }
+
+        u32 time = static_cast<u32>((now - batteryStartTime) / 1000);
+
+        if ((batteryTotal == 0) || (time - batteryLast.time >= batteryInterval)) {
+            BatterySample sample = { time, info.batteryPercentage, info.batteryVoltage, info.batteryTemperature,
+                static_cast<u8>((info.batteryCharging? BATTERY_SAMPLE_CHARGING : 0) | (info.adapterConnected? BATTERY_SAMPLE_ADAPTER : 0)) };
+
+            BatteryLog::Encode(sample);
+        }
+
+        LightLock_Unlock(std::addressof(batteryLock));
+    }
+
+    u32 GetCount(void) {
+        return batteryTotal;
+    }
+}
@@ -1,45 +1,14 @@
 #include <3ds.h>
 #include <cstdio>
 
-#include "log.h"
+#include "configstore.h"
 #include "utils.h"
 
 namespace Config {
-    struct UsernameBlock {
-        u16 username[10];
-        u32 zero;
-        u32 ngWord;
-    };
-    
-    struct EulaVersionBlock {
-        u8 minor;
-        u8 major;
-        u8 padding[2];
-    };
-    
-    struct BirthdayBlock {
-        u8 month;
-        u8 day;
-    };
-
-    struct ParentalControlBlock {
-        u8 unk[13];
-        u8 pin[4];
-        u16 secretAnswer[64];
-        u8 padding[2];
-    };
-    
-    struct BacklightControlBlock {
-        u8 powerSavingEnabled;
-        u8 brightnessLevel;
-    };
-    
     const char *GetUsername(void) {
-        Result ret = 0;
         UsernameBlock usernameBlock;
-        
-        if (R_FAILED(ret = CFGU_GetConfigInfoBlk2(sizeof(UsernameBlock), 0x000A0000, std::addressof(usernameBlock)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+
+        if (!ConfigStore::Get(usernameBlock)) {
             return "unknown";
         }
 
@@ -49,11 +18,9 @@ namespace Config {
     }
 
     const char *GetBirthday(void) {
-        Result ret = 0;
         BirthdayBlock birthdayBlock;
 
-        if (R_FAILED(ret = CFGU_GetConfigInfoBlk2(sizeof(BirthdayBlock), 0x000A0001, std::addressof(birthdayBlock)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if (!ConfigStore::Get(birthdayBlock)) {
             return "unknown";
         }
         
@@ -68,11 +35,9 @@ namespace Config {
     }
     
     const char *GetEulaVersion(void) {
-        Result ret = 0;
         EulaVersionBlock eulaVersionBlock;
 
-        if (R_FAILED(ret = CFGU_GetConfigInfoBlk2(sizeof(EulaVersionBlock), 0x000D0000, std::addressof(eulaVersionBlock)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if (!ConfigStore::Get(eulaVersionBlock)) {
             return "unknown";
         }
 
@@ -82,11 +47,9 @@ namespace Config {
     }
     
     const char *GetParentalPin(void) {
-        Result ret = 0;
         ParentalControlBlock parentalControlBlock;
         
-        if (R_FAILED(ret = CFG_GetConfigInfoBlk8(sizeof(ParentalControlBlock), 0x00100001, std::addressof(parentalControlBlock)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if (!ConfigStore::Get(parentalControlBlock)) {
             return "unknown";
         }
         
@@ -97,25 +60,21 @@ namespace Config {
     }
     
     const char *GetParentalEmail(void) {
-        Result ret = 0;
-        u8 data[0x200];
+        ParentalEmailBlock parentalEmailBlock;
 
-        if (R_FAILED(ret = CFGU_GetConfigInfoBlk2(sizeof(data), 0x000C0002, data))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if (!ConfigStore::Get(parentalEmailBlock)) {
             return "unknown";
         }
 
         static char email[0x200];
-        std::snprintf(email, 0x200, "%s", (data + 1));
+        std::snprintf(email, 0x200, "%.*s", static_cast<int>(sizeof(parentalEmailBlock.email)), parentalEmailBlock.email);
         return email;
     }
 
     const char *GetParentalSecretAnswer(void) {
-        Result ret = 0;
         ParentalControlBlock parentalControlBlock;
 
-        if (R_FAILED(ret = CFG_GetConfigInfoBlk8(sizeof(ParentalControlBlock), 0x00100001, std::addressof(parentalControlBlock)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if (!ConfigStore::Get(parentalControlBlock)) {
             return "unknown";
         }
 
@@ -127,7 +86,7 @@ namespace Config {
     const char *GetPowersaveStatus(void) {
         BacklightControlBlock backlightControlBlock;
         
-        if (R_FAILED(CFG_GetConfigInfoBlk8(sizeof(BacklightControlBlock), 0x00050001, std::addressof(backlightControlBlock)))) {
+        if (!ConfigStore::Get(backlightControlBlock)) {
             return "unknown";
         }
 
@@ -0,0 +1,114 @@
+#include <3ds.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "configstore.h"
+#include "log.h"
+
+namespace ConfigStore {
+    typedef struct {
+        u32 id;
+        u32 size;
+        bool system;   // Only readable through cfg:s/cfg:i (CFG_GetConfigInfoBlk8)
+        bool reloaded; // Can be changed from the HOME menu while 3DSident is running
+    } BlockInfo;
+
+    // Sorted by ID. Each block is fetched with one request on first use and served from storeData after that.
+    static const BlockInfo storeBlocks[] = {
+        { BacklightControlBlock::id, sizeof(BacklightControlBlock), true, true },
+        { AutoBrightnessBlock::id, sizeof(AutoBrightnessBlock), true, true },
+        { SoundOutputModeBlock::id, sizeof(SoundOutputModeBlock), false, true },
+        { UsernameBlock::id, sizeof(UsernameBlock), false, false },
+        { BirthdayBlock::id, sizeof(BirthdayBlock), false, false },
+        { ParentalEmailBlock::id, sizeof(ParentalEmailBlock), false, false },
+        { EulaVersionBlock::id, sizeof(EulaVersionBlock), false, false },
+        { ParentalControlBlock::id, sizeof(ParentalControlBlock), true, false }
+    };
+
+    static const u32 storeBlockCount = sizeof(storeBlocks) / sizeof(storeBlocks[0]);
+    alignas(8) static u8 storeData[0x300];
+    static u32 storeOffsets[storeBlockCount];
+    static Result storeResults[storeBlockCount];
+    static bool storeLoaded[storeBlockCount];
+    static LightLock storeLock;
+    static aptHookCookie storeHookCookie;
+
+    static void AptHook(APT_HookType hook, void *param) {
+        if ((hook == APTHOOK_ONRESTORE) || (hook == APTHOOK_ONWAKEUP)) {
+            ConfigStore::Invalidate();
+        }
+    }
+
+    void Init(void) {
+        u32 offset = 0;
+
+        for (u32 i = 0; i < storeBlockCount; i++) {
+            storeOffsets[i] = offset;
+            storeLoaded[i] = false;
+            offset += (storeBlocks[i].size + 7) & ~7;
+        }
+
+        if (offset > sizeof(storeData)) {
+            Log::Error("%s: blocks need 0x%lx bytes, store holds 0x%x\n", __func__, offset, sizeof(storeData));
+        }
+
+        LightLock_Init(std::addressof(storeLock));
+        aptHook(std::addressof(storeHookCookie), ConfigStore::AptHook, nullptr);
+    }
+
+    void Exit(void) {
+        aptUnhook(std::addressof(storeHookCookie));
+    }
+
+    // Drops the blocks the user can change outside of 3DSident, they are fetched again on next use. Readers only ever
+    // get copies (the sound output mode is read on the probe worker too), so a reload never changes a block in use.
+    void Invalidate(void) {
+        LightLock_Lock(std::addressof(storeLock));
+
+        for (u32 i = 0; i < storeBlockCount; i++) {
+            if (storeBlocks[i].reloaded) {
+                storeLoaded[i] = false;
+            }
+        }
+
+        LightLock_Unlock(std::addressof(storeLock));
+    }
+
+    bool GetBlock(u32 id, void *out, u32 size) {
+        const BlockInfo *block = std::lower_bound(storeBlocks, storeBlocks + storeBlockCount, id, [](const BlockInfo &info, u32 id) {
+            return info.id < id;
+        });
+
+        if ((block == storeBlocks + storeBlockCount) || (block->id != id) || (block->size != size)) {
+            return false;
+        }
+
+        u32 index = block - storeBlocks;
+        u8 *data = storeData + storeOffsets[index];
+
+        if (storeOffsets[index] + block->size > sizeof(storeData)) {
+            return false;
+        }
+
+        LightLock_Lock(std::addressof(storeLock));
+
+        if (!storeLoaded[index]) {
+            storeResults[index] = block->system? CFG_GetConfigInfoBlk8(block->size, block->id, data) : CFGU_GetConfigInfoBlk2(block->size, block->id, data);
+            storeLoaded[index] = true;
+
+            if (R_FAILED(storeResults[index])) {
+                Log::Error("%s(0x%08lx) failed: 0x%x\n", __func__, block->id, storeResults[index]);
+            }
+        }
+
+        Result ret = storeResults[index];
+
+        if (R_SUCCEEDED(ret)) {
+            std::memcpy(out, data, size);
+        }
+
+        LightLock_Unlock(std::addressof(storeLock));
+        return R_SUCCEEDED(ret);
+    }
+}
@@ -0,0 +1,394 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include "diskbench.h"
+#include "fs.h"
+#include "log.h"
+
+// Each test hands out request indices from a shared counter to up to maxQueueDepth workers, every worker owning a
+// buffer and (on the FS backend) a file session of its own. While one request is in flight the next worker already
+// has its buffer filled and its request queued, so the card never waits on the app between transfers.
+
+namespace DiskBench {
+    typedef struct {
+        WriterBackend backend;
+        FS_Archive archive;
+        Handle handles[maxQueueDepth];
+        int fd;
+    } BenchFile;
+
+    typedef struct {
+        const DiskBenchConfig *config;
+        BenchFile *file;
+        DiskTest test;
+        u32 ops;
+        u32 blockSize;
+        u32 blocks;
+        u32 *latencies;
+        std::atomic<u32> next;
+        std::atomic<u32> completed;
+        std::atomic<Result> result;
+    } BenchJob;
+
+    typedef struct {
+        BenchJob *job;
+        u32 index;
+        u8 *buffer;
+        u32 seed;
+    } BenchSlot;
+
+    static const Result benchCancelled = -1;
+    static const char *benchTestNames[DISK_TEST_MAX] = { "Sequential write", "Sequential read", "Random write", "Random read" };
+
+    static Thread benchThread = nullptr;
+    static DiskBenchConfig benchConfig;
+    static DiskBenchResult benchResults[DISK_TEST_MAX];
+    static std::atomic<bool> benchRunning, benchCancel;
+    static std::atomic<u32> benchDone;
+    static u32 benchTotal = 0;
+
+    static void CloseFile(BenchFile &file, const char *path) {
+        if (file.backend == WRITER_BACKEND_POSIX) {
+            if (file.fd >= 0) {
+                close(file.fd);
+                unlink(path);
+            }
+
+            return;
+        }
+
+        for (u32 i = 0; i < maxQueueDepth; i++) {
+            if (file.handles[i]) {
+                FSFILE_Close(file.handles[i]);
+            }
+        }
+
+        FSUSER_DeleteFile(file.archive, fsMakePath(PATH_ASCII, path));
+        FS::CloseArchive(file.archive);
+    }
+
+    static Result OpenFile(BenchFile &file, const DiskBenchConfig &config, u32 depth) {
+        Result ret = 0;
+
+        file.backend = config.backend;
+        file.fd = -1;
+        std::memset(file.handles, 0, sizeof(file.handles));
+
+        if (config.backend == WRITER_BACKEND_POSIX) {
+            if ((file.fd = open(config.path, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+                Log::Error("%s(open) failed: %s\n", __func__, config.path);
+                return -1;
+            }
+
+            if (ftruncate(file.fd, config.fileSize) != 0) {
+                Log::Error("%s(ftruncate) failed: %s\n", __func__, config.path);
+                DiskBench::CloseFile(file, config.path);
+                return -1;
+            }
+
+            return 0;
+        }
+
+        if (R_FAILED(ret = FS::OpenArchive(std::addressof(file.archive), ARCHIVE_SDMC))) {
+            Log::Error("%s(FS::OpenArchive) failed: 0x%x\n", __func__, ret);
+            return ret;
+        }
+
+        // Left over by an interrupted run, creating the file at its full size fails if it still exists.
+        FSUSER_DeleteFile(file.archive, fsMakePath(PATH_ASCII, config.path));
+
+        if (R_FAILED(ret = FSUSER_CreateFile(file.archive, fsMakePath(PATH_ASCII, config.path), 0, config.fileSize))) {
+            Log::Error("%s(FSUSER_CreateFile) failed: 0x%x\n", __func__, ret);
+            FS::CloseArchive(file.archive);
+            return ret;
+        }
+
+        for (u32 i = 0; i < depth; i++) {
+            if (R_FAILED(ret = FSUSER_OpenFile(std::addressof(file.handles[i]), file.archive, fsMakePath(PATH_ASCII, config.path), FS_OPEN_READ | FS_OPEN_WRITE, 0))) {
+                Log::Error("%s(FSUSER_OpenFile) failed: 0x%x\n", __func__, ret);
+                DiskBench::CloseFile(file, config.path);
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    static Result Transfer(BenchFile &file, u32 slot, bool write, u64 offset, u8 *buffer, u32 size) {
+        if (file.backend == WRITER_BACKEND_POSIX) {
+            ssize_t ret = write? pwrite(file.fd, buffer, size, offset) : pread(file.fd, buffer, size, offset);
+            return ret == static_cast<ssize_t>(size)? 0 : -1;
+        }
+
+        Result ret = 0;
+        u32 bytes = 0;
+
+        if (write) {
+            ret = FSFILE_Write(file.handles[slot], std::addressof(bytes), offset, buffer, size, 0);
+        }
+        else {
+            ret = FSFILE_Read(file.handles[slot], std::addressof(bytes), offset, buffer, size);
+        }
+
+        return R_FAILED(ret)? ret : (bytes == size? 0 : -1);
+    }
+
+    // Writes everything out and, on the host, drops the file from the page cache so the reads that follow measure
+    // the device rather than memory.
+    static void Sync(BenchFile &file) {
+        if (file.backend == WRITER_BACKEND_POSIX) {
+            fsync(file.fd);
+#if defined POSIX_FADV_DONTNEED
+            posix_fadvise(file.fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+            return;
+        }
+
+        for (u32 i = 0; i < maxQueueDepth; i++) {
+            if (file.handles[i]) {
+                FSFILE_Flush(file.handles[i]);
+            }
+        }
+    }
+
+    static void Worker(void *arg) {
+        BenchSlot *slot = static_cast<BenchSlot *>(arg);
+        BenchJob &job = *slot->job;
+        bool write = (job.test == DISK_TEST_SEQUENTIAL_WRITE) || (job.test == DISK_TEST_RANDOM_WRITE);
+        bool sequential = (job.test == DISK_TEST_SEQUENTIAL_WRITE) || (job.test == DISK_TEST_SEQUENTIAL_READ);
+
+        for (u32 i = job.next.fetch_add(1); i < job.ops; i = job.next.fetch_add(1)) {
+            if (benchCancel.load(std::memory_order_relaxed) || R_FAILED(job.result.load(std::memory_order_relaxed))) {
+                break;
+            }
+
+            u64 block = i;
+
+            if (!sequential) {
+                slot->seed ^= slot->seed << 13;
+                slot->seed ^= slot->seed >> 17;
+                slot->seed ^= slot->seed << 5;
+                block = slot->seed % job.blocks;
+            }
+
+            // Every block written carries its own index, so no two requests write identical data.
+            if (write) {
+                std::memcpy(slot->buffer, std::addressof(i), sizeof(i));
+            }
+
+            u64 start = svcGetSystemTick();
+            Result ret = DiskBench::Transfer(*job.file, slot->index, write, block * job.blockSize, slot->buffer, job.blockSize);
+            u32 latency = static_cast<u32>((svcGetSystemTick() - start) / CPU_TICKS_PER_USEC);
+
+            if (R_FAILED(ret)) {
+                Result expected = 0;
+                job.result.compare_exchange_strong(expected, ret);
+                break;
+            }
+
+            job.latencies[job.completed.fetch_add(1, std::memory_order_relaxed)] = latency;
+            benchDone.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void RunTest(const DiskBenchConfig &config, BenchFile &file, DiskTest test, BenchSlot *slots, u32 depth, u32 *latencies, DiskBenchResult &result) {
+        bool sequential = (test == DISK_TEST_SEQUENTIAL_WRITE) || (test == DISK_TEST_SEQUENTIAL_READ);
+        BenchJob job;
+        Thread threads[maxQueueDepth] = { nullptr };
+        s32 priority = 0x30;
+
+        job.config = std::addressof(config);
+        job.file = std::addressof(file);
+        job.test = test;
+        job.blockSize = sequential? config.blockSize : config.randomBlockSize;
+        job.blocks = config.fileSize / job.blockSize;
+        job.ops = sequential? job.blocks : config.randomOps;
+        job.latencies = latencies;
+        job.next.store(0, std::memory_order_relaxed);
+        job.completed.store(0, std::memory_order_relaxed);
+        job.result.store(0, std::memory_order_relaxed);
+
+        svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE);
+        result.queueDepth = 1;
+
+        for (u32 i = 0; i < depth; i++) {
+            slots[i].job = std::addressof(job);
+        }
+
+        u64 start = svcGetSystemTick();
+
+        // The calling thread works the first slot itself, and every request if no worker thread could be started.
+        for (u32 i = 1; i < depth; i++) {
+            if (!(threads[i] = threadCreate(DiskBench::Worker, std::addressof(slots[i]), 0x4000, priority, -2, false))) {
+                Log::Error("%s(threadCreate) failed\n", __func__);
+                break;
+            }
+
+            result.queueDepth++;
+        }
+
+        DiskBench::Worker(std::addressof(slots[0]));
+
+        for (u32 i = 1; i < depth; i++) {
+            if (threads[i]) {
+                threadJoin(threads[i], U64_MAX);
+                threadFree(threads[i]);
+            }
+        }
+
+        if ((test == DISK_TEST_SEQUENTIAL_WRITE) || (test == DISK_TEST_RANDOM_WRITE)) {
+            DiskBench::Sync(file);
+        }
+
+        result.ticks = svcGetSystemTick() - start;
+        result.result = benchCancel.load(std::memory_order_relaxed)? benchCancelled : job.result.load(std::memory_order_relaxed);
+        result.ops = job.completed.load(std::memory_order_relaxed);
+        result.bytes = static_cast<u64>(result.ops) * job.blockSize;
+
+        if ((result.ops == 0) || (result.ticks == 0)) {
+            return;
+        }
+
+        double seconds = static_cast<double>(result.ticks) / SYSCLOCK_ARM11;
+        result.mbPerSecond = static_cast<float>((result.bytes / seconds) / (1024.0 * 1024.0));
+        result.iops = static_cast<float>(result.ops / seconds);
+
+        std::sort(latencies, latencies + result.ops);
+        result.latency50 = latencies[(result.ops * 50) / 100];
+        result.latency90 = latencies[(result.ops * 90) / 100];
+        result.latency99 = latencies[(result.ops * 99) / 100];
+        result.latencyMax = latencies[result.ops - 1];
+    }
+
+    void GetDefaultConfig(DiskBenchConfig &config) {
+        config.backend = WRITER_BACKEND_FS;
+        config.path = "/3ds/3dsident_bench.tmp";
+        config.fileSize = 16 * 1024 * 1024;
+        config.blockSize = 256 * 1024;
+        config.randomBlockSize = 4 * 1024;
+        config.randomOps = 1024;
+        config.queueDepth = 2;
+    }
+
+    // Runs the four tests in order against one scratch file, the sequential write also lays out the data the other
+    // tests read and overwrite. Stops at the first test that fails.
+    Result Run(const DiskBenchConfig &config, DiskBenchResult *results) {
+        Result ret = 0;
+        BenchFile file;
+        BenchSlot slots[maxQueueDepth];
+        u32 depth = std::clamp<u32>(config.queueDepth, 1, maxQueueDepth);
+        u32 bufferSize = std::max(config.blockSize, config.randomBlockSize);
+        u32 maxOps = std::max(config.fileSize / config.blockSize, config.randomOps);
+
+        std::memset(results, 0, sizeof(DiskBenchResult) * DISK_TEST_MAX);
+        std::memset(slots, 0, sizeof(slots));
+
+        if ((config.blockSize == 0) || (config.randomBlockSize == 0) || (config.fileSize < bufferSize)) {
+            return -1;
+        }
+
+        u32 *latencies = new u32[maxOps];
+
+        for (u32 i = 0; i < depth; i++) {
+            slots[i].index = i;
+            slots[i].seed = 0x9E3779B9 * (i + 1);
+
+            if (!(slots[i].buffer = static_cast<u8 *>(memalign(0x1000, bufferSize)))) {
+                Log::Error("%s(memalign) failed\n", __func__);
+                depth = i;
+                break;
+            }
+
+            for (u32 j = 0; j < bufferSize; j++) {
+                slots[i].buffer[j] = static_cast<u8>((j * 131) + i);
+            }
+        }
+
+        if (depth == 0) {
+            ret = -1;
+        }
+        else if (R_SUCCEEDED(ret = DiskBench::OpenFile(file, config, depth))) {
+            for (int i = 0; i < DISK_TEST_MAX; i++) {
+                DiskBench::RunTest(config, file, static_cast<DiskTest>(i), slots, depth, latencies, results[i]);
+
+                if (R_FAILED(ret = results[i].result)) {
+                    break;
+                }
+            }
+
+            DiskBench::CloseFile(file, config.path);
+        }
+
+        for (u32 i = 0; i < maxQueueDepth; i++) {
+            free(slots[i].buffer);
+        }
+
+        delete[] latencies;
+        return ret;
+    }
+
+    static void Controller(void *arg) {
+        DiskBench::Run(benchConfig, benchResults);
+        benchRunning.store(false, std::memory_order_release);
+    }
+
+    // Runs the benchmark on a thread below the caller's priority, so the UI keeps drawing the progress.
+    bool Start(const DiskBenchConfig &config) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        DiskBench::Stop();
+        std::memset(benchResults, 0, sizeof(benchResults));
+        benchConfig = config;
+        benchTotal = (config.fileSize / config.blockSize) * 2 + config.randomOps * 2;
+        benchDone.store(0, std::memory_order_relaxed);
+        benchCancel.store(false, std::memory_order_relaxed);
+        benchRunning.store(true, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(benchThread = threadCreate(DiskBench::Controller, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            benchRunning.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Cancels a run still in progress, the scratch file is removed either way.
+    void Stop(void) {
+        if (!benchThread) {
+            return;
+        }
+
+        benchCancel.store(true, std::memory_order_relaxed);
+        threadJoin(benchThread, U64_MAX);
+        threadFree(benchThread);
+        benchThread = nullptr;
+    }
+
+    bool IsRunning(void) {
+        return benchRunning.load(std::memory_order_acquire);
+    }
+
+    float GetProgress(void) {
+        return benchTotal? static_cast<float>(benchDone.load(std::memory_order_relaxed)) / benchTotal : 0.f;
+    }
+
+    // Only valid once IsRunning() returns false.
+    void GetResults(DiskBenchResult *results) {
+        std::memcpy(results, benchResults, sizeof(benchResults));
+    }
+
+    const char *GetTestName(DiskTest test) {
+        return test < DISK_TEST_MAX? benchTestNames[test] : "";
+    }
+}
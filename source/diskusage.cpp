@@ -0,0 +1,422 @@
+#include <3ds.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "diskusage.h"
+#include "fs.h"
+#include "log.h"
+#include "utils.h"
+
+// Incremental du. The walk is a depth first traversal over an explicit stack of directory nodes, with at most one
+// directory handle open at a time. Step() does as much of it as fits in the time it is given and returns, so the UI
+// drives it a slice per frame and pausing is simply not calling it.
+//
+// FS reports no modification times. Every walk re-lists its directories (entries come with their sizes, so this is
+// one FSDIR_Read per 64 entries), and a directory whose listing hashes the same as before keeps its nodes untouched.
+// Only changed directories gain or lose child nodes. Refresh() re-walks one subtree when only part of the card changed.
+
+namespace DiskUsage {
+    static const FS_ArchiveID duArchiveIds[DISK_USAGE_MAX] = { ARCHIVE_SDMC, ARCHIVE_NAND_CTR_FS, ARCHIVE_NAND_TWL_FS };
+    static const char *duArchiveNames[DISK_USAGE_MAX] = { "SD card", "CTR NAND", "TWL NAND" };
+    static const u32 duMaxNodes = 8192;
+    static const u32 duNamePoolSize = 128 * 1024;
+    static const u32 duBatch = 64;
+
+    static DiskUsageNode duNodes[duMaxNodes];
+    static char duNames[duNamePoolSize];
+    static u32 duStack[duMaxNodes];
+    static u32 duOrder[duMaxNodes];
+    static FS_DirectoryEntry duEntries[duBatch];
+    static u32 duNodeCount = 0, duFreeList = none, duNameUsed = 0, duNameFreed = 0, duStackSize = 0, duGeneration = 0;
+    static DiskUsageArchive duArchiveId = DISK_USAGE_MAX;
+    static FS_Archive duArchive;
+    static bool duArchiveOpen = false;
+    static DiskUsageStats duStats;
+
+    // Directory being listed, its handle stays open across Step() calls.
+    static u32 duCurrent = none, duSignature = 0, duFiles = 0;
+    static u64 duOwnBytes = 0;
+    static Handle duHandle;
+
+    // Freed nodes leave their names behind in the pool. Once it fills up, the names still in use are moved down over
+    // them, in pool order so every move goes towards the start and never overwrites a name yet to be moved.
+    static void CompactNames(void) {
+        u32 count = 0, used = 0;
+
+        for (u32 i = 0; i < duNodeCount; i++) {
+            if (duNodes[i].generation != none) {
+                duOrder[count++] = i;
+            }
+        }
+
+        std::sort(duOrder, duOrder + count, [](u32 a, u32 b) {
+            return duNodes[a].name < duNodes[b].name;
+        });
+
+        for (u32 i = 0; i < count; i++) {
+            DiskUsageNode &node = duNodes[duOrder[i]];
+            u32 length = std::strlen(duNames + node.name) + 1;
+            std::memmove(duNames + used, duNames + node.name, length);
+            node.name = used;
+            used += length;
+        }
+
+        duNameUsed = used;
+        duNameFreed = 0;
+    }
+
+    static u32 AddName(const char *name) {
+        u32 length = std::strlen(name) + 1;
+
+        if ((duNameUsed + length > duNamePoolSize) && duNameFreed) {
+            DiskUsage::CompactNames();
+        }
+
+        if (duNameUsed + length > duNamePoolSize) {
+            return none;
+        }
+
+        std::memcpy(duNames + duNameUsed, name, length);
+        duNameUsed += length;
+        return duNameUsed - length;
+    }
+
+    static u32 AllocateNode(u32 parent, const char *name) {
+        u32 node = duFreeList, offset = none;
+
+        if (((node == none) && (duNodeCount == duMaxNodes)) || ((offset = DiskUsage::AddName(name)) == none)) {
+            return none;
+        }
+
+        if (node != none) {
+            duFreeList = duNodes[node].nextSibling;
+        }
+        else {
+            node = duNodeCount++;
+        }
+
+        std::memset(std::addressof(duNodes[node]), 0, sizeof(DiskUsageNode));
+        duNodes[node].parent = parent;
+        duNodes[node].firstChild = none;
+        duNodes[node].name = offset;
+
+        if (parent != none) {
+            duNodes[node].nextSibling = duNodes[parent].firstChild;
+            duNodes[parent].firstChild = node;
+        }
+        else {
+            duNodes[node].nextSibling = none;
+        }
+
+        duStats.nodes++;
+        return node;
+    }
+
+    // Post order without a stack: always descend through firstChild, release the leaf reached and continue with its
+    // sibling or, once there is none, its parent that has just become a leaf. The caller unlinks root itself.
+    static void FreeSubtree(u32 root) {
+        u32 node = root;
+
+        while (true) {
+            while (duNodes[node].firstChild != none) {
+                node = duNodes[node].firstChild;
+            }
+
+            u32 parent = duNodes[node].parent, next = duNodes[node].nextSibling;
+            duNodes[node].nextSibling = duFreeList;
+            duNodes[node].generation = none;
+            duNameFreed += std::strlen(duNames + duNodes[node].name) + 1;
+            duFreeList = node;
+            duStats.nodes--;
+
+            if (node == root) {
+                break;
+            }
+
+            duNodes[parent].firstChild = next;
+            node = next != none? next : parent;
+        }
+    }
+
+    static u32 FindChild(u32 parent, const char *name) {
+        for (u32 child = duNodes[parent].firstChild; child != none; child = duNodes[child].nextSibling) {
+            if (std::strcmp(duNames + duNodes[child].name, name) == 0) {
+                return child;
+            }
+        }
+
+        return none;
+    }
+
+    static void GetPath(u32 node, char *path, u32 size) {
+        u32 chain[64], depth = 0, length = 0;
+
+        for (u32 current = node; (current != 0) && (depth < 64); current = duNodes[current].parent) {
+            chain[depth++] = current;
+        }
+
+        path[0] = '\0';
+
+        while (depth > 0) {
+            length += std::snprintf(path + length, length < size? size - length : 0, "/%s", duNames + duNodes[chain[--depth]].name);
+        }
+
+        if (length == 0) {
+            std::snprintf(path, size, "/");
+        }
+    }
+
+    static u32 Hash(u32 hash, const void *data, u32 size) {
+        const u8 *bytes = static_cast<const u8 *>(data);
+
+        for (u32 i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x01000193;
+        }
+
+        return hash;
+    }
+
+    // Totals are rebuilt in one pass over the pool: every directory adds its own bytes to each of its ancestors.
+    static void UpdateTotals(void) {
+        for (u32 i = 0; i < duNodeCount; i++) {
+            duNodes[i].totalBytes = duNodes[i].ownBytes;
+        }
+
+        for (u32 i = 1; i < duNodeCount; i++) {
+            if (duNodes[i].generation == none) {
+                continue;
+            }
+
+            for (u32 parent = duNodes[i].parent; parent != none; parent = duNodes[parent].parent) {
+                duNodes[parent].totalBytes += duNodes[i].ownBytes;
+            }
+        }
+    }
+
+    static void FinishDirectory(void) {
+        DiskUsageNode &node = duNodes[duCurrent];
+        u32 *link = std::addressof(node.firstChild);
+
+        FSDIR_Close(duHandle);
+
+        if (node.signature != duSignature) {
+            duStats.changed++;
+        }
+
+        node.ownBytes = duOwnBytes;
+        node.files = duFiles;
+        node.signature = duSignature;
+
+        // Children the listing no longer has are dropped, the rest are queued.
+        while (*link != none) {
+            u32 child = *link;
+
+            if (duNodes[child].generation != duGeneration) {
+                *link = duNodes[child].nextSibling;
+                DiskUsage::FreeSubtree(child);
+                continue;
+            }
+
+            duStack[duStackSize++] = child;
+            link = std::addressof(duNodes[child].nextSibling);
+        }
+
+        duStats.listed++;
+        duCurrent = none;
+    }
+
+    static void AddEntries(u32 count) {
+        for (u32 i = 0; i < count; i++) {
+            const FS_DirectoryEntry &entry = duEntries[i];
+            char name[256];
+
+            Utils::UTF16ToUTF8(reinterpret_cast<u8 *>(name), entry.name, sizeof(name) - 1);
+            duSignature = DiskUsage::Hash(duSignature, name, std::strlen(name));
+            duSignature = DiskUsage::Hash(duSignature, std::addressof(entry.fileSize), sizeof(entry.fileSize));
+            duSignature = DiskUsage::Hash(duSignature, std::addressof(entry.attributes), sizeof(entry.attributes));
+
+            if (!(entry.attributes & FS_ATTRIBUTE_DIRECTORY)) {
+                duOwnBytes += entry.fileSize;
+                duFiles++;
+                continue;
+            }
+
+            u32 child = DiskUsage::FindChild(duCurrent, name);
+
+            if (child == none) {
+                child = DiskUsage::AllocateNode(duCurrent, name);
+            }
+
+            if (child == none) {
+                duStats.truncated++;
+                continue;
+            }
+
+            duNodes[child].generation = duGeneration;
+        }
+    }
+
+    static bool OpenArchive(DiskUsageArchive archive) {
+        Result ret = 0;
+
+        if (duArchiveOpen) {
+            return true;
+        }
+
+        if (R_FAILED(ret = FS::OpenArchive(std::addressof(duArchive), duArchiveIds[archive]))) {
+            Log::Error("%s(FS::OpenArchive) failed: 0x%x\n", __func__, ret);
+            return false;
+        }
+
+        duArchiveOpen = true;
+        return true;
+    }
+
+    // Switching archives starts a new tree, walking the cached one again revalidates it.
+    bool Start(DiskUsageArchive archive) {
+        if (archive != duArchiveId) {
+            DiskUsage::Stop();
+            duNodeCount = duNameUsed = duNameFreed = 0;
+            duFreeList = none;
+            duArchiveId = archive;
+            std::memset(std::addressof(duStats), 0, sizeof(duStats));
+            DiskUsage::AllocateNode(none, "");
+        }
+
+        return DiskUsage::Refresh(0);
+    }
+
+    bool Refresh(u32 node) {
+        if ((duArchiveId == DISK_USAGE_MAX) || (node >= duNodeCount) || (duNodes[node].generation == none)) {
+            return false;
+        }
+
+        DiskUsage::Stop();
+
+        if (!DiskUsage::OpenArchive(duArchiveId)) {
+            return false;
+        }
+
+        duGeneration++;
+        duNodes[node].generation = duGeneration;
+        duStats.listed = duStats.changed = duStats.truncated = duStats.errors = 0;
+        duStack[duStackSize++] = node;
+        return true;
+    }
+
+    // Walks until budget ticks have passed. Returns false once the walk is complete.
+    bool Step(u64 budget) {
+        u64 deadline = svcGetSystemTick() + budget;
+
+        if (!duArchiveOpen) {
+            return false;
+        }
+
+        while (svcGetSystemTick() < deadline) {
+            if (duCurrent == none) {
+                if (duStackSize == 0) {
+                    DiskUsage::UpdateTotals();
+                    DiskUsage::Stop();
+                    return false;
+                }
+
+                char path[256];
+                u32 node = duStack[--duStackSize];
+                DiskUsage::GetPath(node, path, sizeof(path));
+
+                if (R_FAILED(FSUSER_OpenDirectory(std::addressof(duHandle), duArchive, fsMakePath(PATH_ASCII, path)))) {
+                    duStats.errors++;
+                    continue;
+                }
+
+                duCurrent = node;
+                duSignature = 0x811C9DC5;
+                duOwnBytes = 0;
+                duFiles = 0;
+            }
+
+            u32 count = 0;
+
+            if (R_FAILED(FSDIR_Read(duHandle, std::addressof(count), duBatch, duEntries)) || (count == 0)) {
+                DiskUsage::FinishDirectory();
+                continue;
+            }
+
+            DiskUsage::AddEntries(std::min(count, duBatch));
+        }
+
+        duStats.pending = duStackSize;
+        return true;
+    }
+
+    // Abandons the walk, directories already listed keep their results.
+    void Stop(void) {
+        if (duCurrent != none) {
+            FSDIR_Close(duHandle);
+            duCurrent = none;
+        }
+
+        if (duArchiveOpen) {
+            FS::CloseArchive(duArchive);
+            duArchiveOpen = false;
+        }
+
+        duStackSize = 0;
+        duStats.pending = 0;
+    }
+
+    bool IsBusy(void) {
+        return duArchiveOpen;
+    }
+
+    DiskUsageArchive GetArchive(void) {
+        return duArchiveId;
+    }
+
+    void GetStats(DiskUsageStats &stats) {
+        stats = duStats;
+    }
+
+    const DiskUsageNode *GetNode(u32 node) {
+        return node < duNodeCount? std::addressof(duNodes[node]) : nullptr;
+    }
+
+    const char *GetName(u32 node) {
+        return node < duNodeCount? duNames + duNodes[node].name : "";
+    }
+
+    // The largest max subdirectories of node, largest first. Returns how many were written. Children are kept in a
+    // heap with the smallest on top while the list is walked, so a directory with more than max of them still
+    // yields its largest ones.
+    u32 GetChildren(u32 node, u32 *children, u32 max) {
+        auto larger = [](u32 a, u32 b) {
+            return duNodes[a].totalBytes > duNodes[b].totalBytes;
+        };
+
+        u32 count = 0;
+
+        if ((node >= duNodeCount) || (max == 0)) {
+            return 0;
+        }
+
+        for (u32 child = duNodes[node].firstChild; child != none; child = duNodes[child].nextSibling) {
+            if (count < max) {
+                children[count++] = child;
+                std::push_heap(children, children + count, larger);
+            }
+            else if (larger(child, children[0])) {
+                std::pop_heap(children, children + count, larger);
+                children[count - 1] = child;
+                std::push_heap(children, children + count, larger);
+            }
+        }
+
+        std::sort_heap(children, children + count, larger);
+        return count;
+    }
+
+    const char *GetArchiveName(DiskUsageArchive archive) {
+        return archive < DISK_USAGE_MAX? duArchiveNames[archive] : "";
+    }
+}
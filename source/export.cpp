@@ -0,0 +1,222 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstring>
+
+#include "export.h"
+#include "schema.h"
+
+// Binary reports are a header { u32 magic "3DSR", u16 version, u16 flags } followed by the same
+// { u16 tag, u16 length, u8 data[length] } records as the snapshot cache, ended by a record with tag 0xFFFF.
+// Integers are little endian, strings and char arrays are stored without NUL terminators.
+
+namespace Export {
+    static const char *exportExtensions[EXPORT_FORMAT_MAX] = { "json", "csv", "bin" };
+    static const u32 exportMagic = 0x52534433; // "3DSR"
+    static const u16 exportVersion = 1;
+    static const u16 exportEndTag = 0xFFFF;
+
+    // Text of a string or char array field, nullptr for every other type.
+    static const char *GetText(const FieldInfo &field, const u8 *member, u32 &length) {
+        if (field.type == FIELD_STRING) {
+            const char *string = Schema::GetString(member);
+            string = string? string : "";
+            length = std::strlen(string);
+            return string;
+        }
+
+        if (field.type == FIELD_CHARS) {
+            const char *chars = reinterpret_cast<const char *>(member);
+            length = strnlen(chars, field.size);
+            return chars;
+        }
+
+        return nullptr;
+    }
+
+    // Quoted and escaped, also used by the HTTP server for values outside the schema.
+    void WriteJsonString(FileWriter &writer, const char *text, u32 length) {
+        u32 start = 0;
+        Writer::Write(writer, "\"", 1);
+
+        for (u32 i = 0; i < length; i++) {
+            u8 c = text[i];
+
+            if ((c != '"') && (c != '\\') && (c >= 0x20)) {
+                continue;
+            }
+
+            Writer::Write(writer, text + start, i - start);
+
+            if ((c == '"') || (c == '\\')) {
+                Writer::Printf(writer, "\\%c", c);
+            }
+            else {
+                Writer::Printf(writer, "\\u%04x", c);
+            }
+
+            start = i + 1;
+        }
+
+        Writer::Write(writer, text + start, length - start);
+        Writer::Write(writer, "\"", 1);
+    }
+
+    static void WriteCsvString(FileWriter &writer, const char *text, u32 length) {
+        if (!std::memchr(text, ',', length) && !std::memchr(text, '"', length) && !std::memchr(text, '\n', length) &&
+            !std::memchr(text, '\r', length)) {
+            Writer::Write(writer, text, length);
+            return;
+        }
+
+        u32 start = 0;
+        Writer::Write(writer, "\"", 1);
+
+        for (u32 i = 0; i < length; i++) {
+            if (text[i] == '"') {
+                Writer::Write(writer, text + start, i + 1 - start);
+                Writer::Write(writer, "\"", 1);
+                start = i + 1;
+            }
+        }
+
+        Writer::Write(writer, text + start, length - start);
+        Writer::Write(writer, "\"", 1);
+    }
+
+    static void WriteNumber(FileWriter &writer, const FieldInfo &field, const u8 *member, bool quoteWide) {
+        if (field.type == FIELD_BOOL) {
+            Writer::Printf(writer, "%s", *member? "true" : "false");
+        }
+        else if (field.type == FIELD_SIGNED) {
+            Writer::Printf(writer, "%lld", static_cast<long long>(Schema::GetSigned(member, field.size)));
+        }
+        // JSON readers commonly parse numbers as doubles, which can't hold every 64-bit ID.
+        else if ((quoteWide) && (field.size == 8)) {
+            Writer::Printf(writer, "\"%llu\"", static_cast<unsigned long long>(Schema::GetUnsigned(member, field.size)));
+        }
+        else {
+            Writer::Printf(writer, "%llu", static_cast<unsigned long long>(Schema::GetUnsigned(member, field.size)));
+        }
+    }
+
+    static void WriteRecord(FileWriter &writer, u16 tag, const void *data, u32 length) {
+        length = length > 0xFFFF? 0xFFFF : length;
+        u8 header[4] = { static_cast<u8>(tag & 0xFF), static_cast<u8>(tag >> 8), static_cast<u8>(length & 0xFF), static_cast<u8>(length >> 8) };
+        Writer::Write(writer, header, sizeof(header));
+        Writer::Write(writer, data, length);
+    }
+
+    Result Write(FileWriter &writer, ExportFormat format, const ProbeResults &results, u32 mask, bool displayInfo) {
+        u32 count = 0;
+        const GroupInfo *groups = Schema::GetGroups(count);
+        bool firstGroup = true;
+
+        if (format == EXPORT_FORMAT_JSON) {
+            Writer::Printf(writer, "{\n  \"format\": %u", exportVersion);
+            firstGroup = false;
+        }
+        else if (format == EXPORT_FORMAT_CSV) {
+            Writer::Printf(writer, "group,field,value\n");
+        }
+        else {
+            u8 header[8] = { 0 };
+            std::memcpy(header, std::addressof(exportMagic), sizeof(exportMagic));
+            std::memcpy(header + 4, std::addressof(exportVersion), sizeof(exportVersion));
+            header[6] = displayInfo? 1 : 0;
+            Writer::Write(writer, header, sizeof(header));
+        }
+
+        for (u32 g = 0; g < count; g++) {
+            const GroupInfo &group = groups[g];
+            bool firstField = true;
+
+            if (!(mask & BIT(group.id))) {
+                continue;
+            }
+
+            if (format == EXPORT_FORMAT_JSON) {
+                Writer::Printf(writer, "%s\n  \"%s\": {", firstGroup? "" : ",", group.name);
+                firstGroup = false;
+            }
+
+            for (u32 i = 0; i < group.count; i++) {
+                const FieldInfo &field = group.fields[i];
+                const u8 *member = Schema::GetField(results, group, field);
+                u32 length = 0;
+                const char *text = Export::GetText(field, member, length);
+
+                if ((field.flags & FIELD_FLAG_PRIVATE) && (!displayInfo)) {
+                    continue;
+                }
+
+                switch (format) {
+                    case EXPORT_FORMAT_JSON:
+                        Writer::Printf(writer, "%s\n    \"%s\": ", firstField? "" : ",", field.name);
+
+                        if (text) {
+                            Export::WriteJsonString(writer, text, length);
+                        }
+                        else {
+                            Export::WriteNumber(writer, field, member, true);
+                        }
+                        break;
+
+                    case EXPORT_FORMAT_CSV:
+                        Writer::Printf(writer, "%s,%s,", group.name, field.name);
+
+                        if (text) {
+                            Export::WriteCsvString(writer, text, length);
+                        }
+                        else {
+                            Export::WriteNumber(writer, field, member, false);
+                        }
+
+                        Writer::Write(writer, "\n", 1);
+                        break;
+
+                    default:
+                        Export::WriteRecord(writer, (group.id << 8) | i, text? static_cast<const void *>(text) : member, text? length : field.size);
+                        break;
+                }
+
+                firstField = false;
+            }
+
+            if (format == EXPORT_FORMAT_JSON) {
+                Writer::Printf(writer, "%s}", firstField? "" : "\n  ");
+            }
+        }
+
+        if (format == EXPORT_FORMAT_JSON) {
+            Writer::Printf(writer, "\n}\n");
+        }
+        else if (format == EXPORT_FORMAT_BINARY) {
+            Export::WriteRecord(writer, exportEndTag, nullptr, 0);
+        }
+
+        return writer.result;
+    }
+
+    // Writes the report in every format, path is the file name without extension.
+    Result Save(WriterBackend backend, const char *path, const ProbeResults &results, u32 mask, bool displayInfo) {
+        static FileWriter writer;
+        Result ret = 0;
+
+        for (int i = 0; i < EXPORT_FORMAT_MAX; i++) {
+            char filename[256];
+            std::snprintf(filename, sizeof(filename), "%s.%s", path, exportExtensions[i]);
+
+            if (R_FAILED(ret = Writer::Open(writer, backend, filename))) {
+                return ret;
+            }
+
+            Export::Write(writer, static_cast<ExportFormat>(i), results, mask, displayInfo);
+
+            if (R_FAILED(ret = Writer::Close(writer))) {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+}
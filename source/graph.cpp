@@ -0,0 +1,50 @@
+#include "graph.h"
+
+namespace Graph {
+    static const u32 graphMaxColumns = sizeof(GraphSeries::columns) / sizeof(GraphColumn);
+
+    void Init(GraphSeries &series, u32 width, u32 samplesPerColumn, float rangeMin, float rangeMax) {
+        series.width = width == 0? 1 : (width > graphMaxColumns? graphMaxColumns : width);
+        series.samplesPerColumn = samplesPerColumn? samplesPerColumn : 1;
+        series.head = series.width - 1;
+        series.count = 0;
+        series.pending = 0;
+        series.rangeMin = rangeMin;
+        series.rangeMax = rangeMax;
+    }
+
+    // The first sample of a column scrolls the oldest one out, the rest only widen its range.
+    void Push(GraphSeries &series, float value) {
+        if (series.pending == 0) {
+            series.head = (series.head + 1) % series.width;
+            series.count = series.count < series.width? series.count + 1 : series.width;
+            series.columns[series.head] = { value, value, value };
+        }
+        else {
+            GraphColumn &column = series.columns[series.head];
+            column.min = value < column.min? value : column.min;
+            column.max = value > column.max? value : column.max;
+            column.last = value;
+        }
+
+        series.pending = (series.pending + 1) % series.samplesPerColumn;
+    }
+
+    // Replaces the contents with a whole history, coarsening the columns if needed so all of it fits the width.
+    void Load(GraphSeries &series, const float *values, u32 count) {
+        u32 needed = (count + series.width - 1) / series.width;
+        series.samplesPerColumn = needed > series.samplesPerColumn? needed : series.samplesPerColumn;
+        series.head = series.width - 1;
+        series.count = 0;
+        series.pending = 0;
+
+        for (u32 i = 0; i < count; i++) {
+            Graph::Push(series, values[i]);
+        }
+    }
+
+    // Index 0 is the oldest column still shown.
+    const GraphColumn &GetColumn(const GraphSeries &series, u32 index) {
+        return series.columns[(series.head + 1 + series.width - series.count + index) % series.width];
+    }
+}
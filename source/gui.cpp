@@ -1,15 +1,34 @@
 #include <3ds.h>
+#include <arpa/inet.h>
 #include <citro2d.h>
 #include <cstdarg>
 #include <cstdio>
+#include <cmath>
+#include <cstring>
 #include <malloc.h>
 
+#include "batterylog.h"
 #include "config.h"
+#include "configstore.h"
+#include "diskbench.h"
+#include "diskusage.h"
+#include "export.h"
+#include "graph.h"
 #include "gui.h"
 #include "hardware.h"
+#include "httpserver.h"
+#include "inputmonitor.h"
 #include "log.h"
+#include "nandbench.h"
+#include "netbench.h"
+#include "probe.h"
+#include "sampler.h"
 #include "service.h"
+#include "telemetry.h"
 #include "textures.h"
+#include "tickets.h"
+#include "titles.h"
+#include "trace.h"
 #include "utils.h"
 
 namespace GUI {
@@ -19,6 +38,26 @@ namespace GUI {
         TARGET_MAX
     };
 
+    enum TesterMode {
+        TESTER_BUTTONS = 0,
+        TESTER_TIMING,
+        TESTER_STICKS,
+        TESTER_TOUCH,
+        TESTER_MAX
+    };
+
+    enum ToolId {
+        TOOL_SD_BENCHMARK = 0,
+        TOOL_NAND_BENCHMARK,
+        TOOL_TITLES,
+        TOOL_TICKETS,
+        TOOL_DISK_USAGE,
+        TOOL_NETWORK,
+        TOOL_HTTP_SERVER,
+        TOOL_TELEMETRY,
+        TOOL_MAX
+    };
+
     enum PageState {
         KERNEL_INFO_PAGE = 0,
         SYSTEM_INFO_PAGE,
@@ -29,12 +68,41 @@ namespace GUI {
         WIFI_INFO_PAGE,
         STORAGE_INFO_PAGE,
         MISC_INFO_PAGE,
+        TOOLS_PAGE,
         EXIT_PAGE,
         MAX_ITEMS
     };
 
+    // Probe each page waits on before it can be drawn, PROBE_MAX if it has none.
+    static const ProbeId guiPageProbes[MAX_ITEMS] = {
+        PROBE_KERNEL_INFO,
+        PROBE_SYSTEM_INFO,
+        PROBE_SYSTEM_STATE_INFO,
+        PROBE_NNID_INFO,
+        PROBE_CONFIG_INFO,
+        PROBE_HARDWARE_INFO,
+        PROBE_WIFI_INFO,
+        PROBE_STORAGE_INFO,
+        PROBE_MISC_INFO,
+        PROBE_MAX,
+        PROBE_MAX
+    };
+
+    // Retained text, every text draw in a frame owns the next slot and is only re-parsed when its contents change.
+    typedef struct {
+        C2D_Text text;
+        float width;
+        float height;
+        u32 generation;
+        u32 length;
+        char string[256];
+    } TextSlot;
+
     static C3D_RenderTarget *c3dRenderTarget[TARGET_MAX];
-    static C2D_TextBuf guiStaticBuf, guiDynamicBuf, guiSizeBuf;
+    static C2D_TextBuf guiStaticBuf;
+    static TextSlot guiTextSlots[96];
+    static u32 guiTextSlotIndex = 0, guiTextGeneration = 1, guiTextCacheHits = 0, guiTextCacheMisses = 0;
+    static const u32 guiStaticBufSize = 4096;
 
     static const u32 guiBgcolour = C2D_Color32(62, 62, 62, 255);
     static const u32 guiStatusBarColour = C2D_Color32(44, 44, 44, 255);
@@ -43,10 +111,13 @@ namespace GUI {
     static const u32 guiTitleColour = C2D_Color32(252, 252, 252, 255);
     static const u32 guiDescrColour = C2D_Color32(182, 182, 182, 255);
     
-    static const u32 guiItemDistance = 20, guiItemHeight = 18, guiItemStartX = 15, guiItemStartY = 84;
+    static const u32 guiGraphColour = C2D_Color32(241, 122, 74, 255);
+
+    static const u32 guiItemDistance = 19, guiItemHeight = 18, guiItemStartX = 15, guiItemStartY = 84;
     static const float guiTexSize = 0.5f;
 
     void Init(void) {
+        TRACE_SCOPE("GUI::Init");
         romfsInit();
         gfxInitDefault();
         C3D_Init(C3D_DEFAULT_CMDBUF_SIZE);
@@ -56,13 +127,16 @@ namespace GUI {
         c3dRenderTarget[TARGET_TOP] = C2D_CreateScreenTarget(GFX_TOP, GFX_LEFT);
         c3dRenderTarget[TARGET_BOTTOM] = C2D_CreateScreenTarget(GFX_BOTTOM, GFX_LEFT);
 
-        guiStaticBuf  = C2D_TextBufNew(4096);
-        guiDynamicBuf  = C2D_TextBufNew(4096);
-        guiSizeBuf = C2D_TextBufNew(4096);
+        guiStaticBuf  = C2D_TextBufNew(guiStaticBufSize);
 
         Textures::Init();
 #if defined BUILD_DEBUG
-        Log::Open();
+        // Trace builds are analysed on the host anyway, so they log compact binary records for tools/logdecode.
+#if defined BUILD_TRACE
+        Log::Open(LOG_FORMAT_BINARY);
+#else
+        Log::Open(LOG_FORMAT_TEXT);
+#endif
 #endif
         // Real time services
 #if !defined BUILD_CITRA
@@ -70,6 +144,7 @@ namespace GUI {
 #endif
         ptmuInit();
         cfguInit();
+        ConfigStore::Init();
         dspInit();
         socInit(static_cast<u32 *>(memalign(0x1000, 0x10000)), 0x10000);
     }
@@ -77,17 +152,17 @@ namespace GUI {
     void Exit(void) {
         socExit();
         dspExit();
+        ConfigStore::Exit();
         cfguExit();
         ptmuExit();
 #if !defined BUILD_CITRA
         mcuHwcExit();
 #endif
+        Textures::Exit();
 #if defined BUILD_DEBUG
+        Log::Info("%s: text cache %lu hits, %lu misses\n", __func__, guiTextCacheHits, guiTextCacheMisses);
         Log::Close();
 #endif
-        Textures::Exit();
-        C2D_TextBufDelete(guiSizeBuf);
-        C2D_TextBufDelete(guiDynamicBuf);
         C2D_TextBufDelete(guiStaticBuf);
         C2D_Fini();
         C3D_Fini();
@@ -100,25 +175,68 @@ namespace GUI {
         C2D_TargetClear(c3dRenderTarget[TARGET_TOP], topScreenColour);
         C2D_TargetClear(c3dRenderTarget[TARGET_BOTTOM], bottomScreenColour);
         C2D_SceneBegin(c3dRenderTarget[TARGET_TOP]);
+        guiTextSlotIndex = 0;
     }
 
     static void End(void) {
-        C2D_TextBufClear(guiDynamicBuf);
-        C2D_TextBufClear(guiSizeBuf);
         C3D_FrameEnd(0);
     }
 
+    // Drops every parsed text, used when the page changes or the buffer runs out of glyphs.
+    static void ClearText(void) {
+        C2D_TextBufClear(guiStaticBuf);
+        guiTextGeneration++;
+    }
+
+    static const TextSlot &GetText(const char *text) {
+        TextSlot &slot = guiTextSlots[guiTextSlotIndex++ % (sizeof(guiTextSlots) / sizeof(guiTextSlots[0]))];
+        u32 length = std::strlen(text);
+
+        if ((slot.generation == guiTextGeneration) && (slot.length == length) && (std::memcmp(slot.string, text, length) == 0)) {
+            guiTextCacheHits++;
+            return slot;
+        }
+
+        guiTextCacheMisses++;
+
+        // Glyph count never exceeds the byte length, so this is a safe upper bound.
+        if (C2D_TextBufGetNumGlyphs(guiStaticBuf) + length > guiStaticBufSize) {
+            GUI::ClearText();
+        }
+
+        C2D_TextParse(std::addressof(slot.text), guiStaticBuf, text);
+        C2D_TextOptimize(std::addressof(slot.text));
+        C2D_TextGetDimensions(std::addressof(slot.text), 1.f, 1.f, std::addressof(slot.width), std::addressof(slot.height));
+
+        // Strings that don't fit are never matched, so they're re-parsed on every draw.
+        if (length < sizeof(slot.string)) {
+            std::memcpy(slot.string, text, length + 1);
+            slot.length = length;
+            slot.generation = guiTextGeneration;
+        }
+        else {
+            slot.generation = 0;
+        }
+
+        return slot;
+    }
+
     static void GetTextDimensions(float size, float *width, float *height, const char *text) {
-        C2D_Text c2dText;
-        C2D_TextParse(&c2dText, guiSizeBuf, text);
-        C2D_TextGetDimensions(&c2dText, size, size, width, height);
+        const TextSlot &slot = GUI::GetText(text);
+
+        if (width) {
+            *width = slot.width * size;
+        }
+
+        if (height) {
+            *height = slot.height * size;
+        }
     }
 
-    static void DrawText(float x, float y, float size, u32 colour, const char *text) {
-        C2D_Text c2dText;
-        C2D_TextParse(&c2dText, guiDynamicBuf, text);
-        C2D_TextOptimize(&c2dText);
-        C2D_DrawText(&c2dText, C2D_WithColor, x, y, guiTexSize, size, size, colour);
+    static float DrawText(float x, float y, float size, u32 colour, const char *text) {
+        const TextSlot &slot = GUI::GetText(text);
+        C2D_DrawText(std::addressof(slot.text), C2D_WithColor, x, y, guiTexSize, size, size, colour);
+        return slot.width * size;
     }
 
     static void DrawTextf(float x, float y, float size, u32 colour, const char* text, ...) {
@@ -131,25 +249,19 @@ namespace GUI {
     }
 
     static void DrawItem(float x, float y, const char *title, const char *text) {
-        float titleWidth = 0.f;
-        GUI::GetTextDimensions(guiTexSize, &titleWidth, nullptr, title);
-        GUI::DrawText(x, y, guiTexSize, guiTitleColour, title);
+        float titleWidth = GUI::DrawText(x, y, guiTexSize, guiTitleColour, title);
         GUI::DrawText(x + titleWidth + 5, y, guiTexSize, guiDescrColour, text);
     }
 
     static void DrawItem(int index, const char *title, const char *text) {
-        float titleWidth = 0.f;
         float y = guiItemStartY + ((guiItemDistance - guiItemHeight) / 2) + guiItemHeight * index;
-        GUI::GetTextDimensions(guiTexSize, &titleWidth, nullptr, title);
-        GUI::DrawText(guiItemStartX, y, guiTexSize, guiTitleColour, title);
+        float titleWidth = GUI::DrawText(guiItemStartX, y, guiTexSize, guiTitleColour, title);
         GUI::DrawText(guiItemStartX + titleWidth + 5, y, guiTexSize, guiDescrColour, text);
     }
 
     static void DrawItemf(int index, const char *title, const char *text, ...) {
-        float titleWidth = 0.f;
         float y = guiItemStartY + ((guiItemDistance - guiItemHeight) / 2) + guiItemHeight * index;
-        GUI::GetTextDimensions(guiTexSize, &titleWidth, nullptr, title);
-        GUI::DrawText(guiItemStartX, y, guiTexSize, guiTitleColour, title);
+        float titleWidth = GUI::DrawText(guiItemStartX, y, guiTexSize, guiTitleColour, title);
         
         char buffer[256];
         va_list args;
@@ -169,6 +281,34 @@ namespace GUI {
         return C2D_DrawImageAt(image, x, y, guiTexSize, std::addressof(tint), 1.f, 1.f);
     }
 
+    // One 1px wide rect per column, citro2d batches them into a single draw call. Each column is stretched to the
+    // previous column's last value so the series reads as a continuous line.
+    static void DrawGraph(const GraphSeries &series, float x, float y, float height) {
+        C2D_DrawRectSolid(x - 1, y - 1, guiTexSize, series.width + 2, height + 2, guiTitleColour);
+        C2D_DrawRectSolid(x, y, guiTexSize, series.width, height, guiMenuBarColour);
+
+        float scale = height / (series.rangeMax - series.rangeMin), previous = 0.f;
+        float left = x + (series.width - series.count);
+
+        for (u32 i = 0; i < series.count; i++) {
+            const GraphColumn &column = Graph::GetColumn(series, i);
+            float low = column.min, high = column.max;
+
+            if (i > 0) {
+                low = previous < low? previous : low;
+                high = previous > high? previous : high;
+            }
+
+            previous = column.last;
+            low = low < series.rangeMin? series.rangeMin : (low > series.rangeMax? series.rangeMax : low);
+            high = high < series.rangeMin? series.rangeMin : (high > series.rangeMax? series.rangeMax : high);
+
+            float top = y + height - ((high - series.rangeMin) * scale);
+            float bottom = y + height - ((low - series.rangeMin) * scale);
+            C2D_DrawRectSolid(left + i, top, guiTexSize, 1, bottom - top > 1.f? bottom - top : 1.f, guiGraphColour);
+        }
+    }
+
     static void KernelInfoPage(const KernelInfo &info, bool &displayInfo) {
         GUI::DrawItemf(1, "Kernel version:", info.kernelVersion);
         GUI::DrawItem(2, "FIRM version:", info.firmVersion);
@@ -189,33 +329,31 @@ namespace GUI {
         GUI::DrawItemf(7, "ECS Device ID:", "%llu", displayInfo? info.soapId : 0);
     }
 
-    static void BatteryInfoPage(const SystemStateInfo &info) {
-        Result ret = 0;
-        u8 percentage = 0, status = 0, voltage = 0, fwVerHigh = 0, fwVerLow = 0, temp = 0;
-        bool connected = false;
+    static void BatteryInfoPage(const SystemStateInfo &info, const LiveInfo &live, const GraphSeries &voltageGraph) {
+        bool percentageValid = live.valid & BIT(SAMPLER_FIELD_BATTERY_PERCENTAGE);
+        bool chargingValid = live.valid & BIT(SAMPLER_FIELD_BATTERY_CHARGING);
+        GUI::DrawItemf(1, "Battery percentage:", "%3d%% (%s)", percentageValid? live.batteryPercentage : 0,
+            chargingValid? (live.batteryCharging? "charging" : "not charging") : "unknown");
 
-        ret = MCUHWC_GetBatteryLevel(std::addressof(percentage));
-        Result chargeResult = PTMU_GetBatteryChargeState(std::addressof(status));
-        GUI::DrawItemf(1, "Battery percentage:", "%3d%% (%s)", R_FAILED(ret)? 0 : (percentage),
-            R_FAILED(chargeResult)? "unknown" : (status? "charging" : "not charging"));
+        GUI::DrawItemf(2, "Battery voltage:", "%d (%.1f V)", live.batteryVoltage, 5.f * (static_cast<float>(live.batteryVoltage) / 256.f));
 
-        ret = MCUHWC_GetBatteryVoltage(std::addressof(voltage));
-        GUI::DrawItemf(2, "Battery voltage:", "%d (%.1f V)", voltage, 5.f * (static_cast<float>(voltage) / 256.f));
-
-        ret = MCUHWC::GetBatteryTemperature(std::addressof(temp));
+        bool temperatureValid = live.valid & BIT(SAMPLER_FIELD_BATTERY_TEMPERATURE);
         GUI::DrawItemf(3, "Battery temperature:", "%d °C (%d °F)", 
-            R_FAILED(ret)? 0 : (temp), R_FAILED(ret)? 0 : static_cast<u8>((temp * 9) / 5 + 32));
+            temperatureValid? live.batteryTemperature : 0, temperatureValid? static_cast<u8>((live.batteryTemperature * 9) / 5 + 32) : 0);
 
-        ret = PTMU_GetAdapterState(std::addressof(connected));
-        GUI::DrawItemf(4, "Adapter state:", R_FAILED(ret)? "unknown" : (connected? "connected" : "disconnected"));
+        GUI::DrawItemf(4, "Adapter state:", (live.valid & BIT(SAMPLER_FIELD_ADAPTER_STATE))?
+            (live.adapterConnected? "connected" : "disconnected") : "unknown");
 
-        MCUHWC_GetFwVerHigh(std::addressof(fwVerHigh));
-        MCUHWC_GetFwVerLow(std::addressof(fwVerLow));
-        GUI::DrawItemf(5, "MCU firmware:", "%u.%u", (fwVerHigh - 0x10), fwVerLow);
+        GUI::DrawItemf(5, "MCU firmware:", "%u.%u", (live.mcuFwVerHigh - 0x10), live.mcuFwVerLow);
 
         GUI::DrawItemf(6, "PMIC vendor code:", "%x", info.pmicVendorCode);
 
         GUI::DrawItemf(7, "Battery vendor code:", "%x", info.batteryVendorCode);
+
+        GUI::DrawItemf(8, "Recorder (X):", "%lu samples, every %lu s", BatteryLog::GetCount(), BatteryLog::GetInterval());
+
+        GUI::DrawTextf(270, 176, guiTexSize, guiDescrColour, "Voltage, last %lu min", (voltageGraph.width * voltageGraph.samplesPerColumn) / 60);
+        GUI::DrawGraph(voltageGraph, 270, 194, 36);
     }
 
     static void NNIDInfoPage(const NNIDInfo &info, bool &displayInfo) {
@@ -238,20 +376,20 @@ namespace GUI {
         GUI::DrawItem(7, "Power-saving mode:", Config::GetPowersaveStatus());
     }
 
-    static void HardwareInfoPage(const HardwareInfo &info, bool &isNew3DS) {
+    static void HardwareInfoPage(const HardwareInfo &info, const LiveInfo &live, bool &isNew3DS) {
         GUI::DrawItem(1, "Upper screen type:", info.screenUpper);
         GUI::DrawItem(2, "Lower screen type:", info.screenLower);
-        GUI::DrawItem(3, "Headphone status:", Hardware::GetAudioJackStatus()? "inserted" : "not inserted");
-        GUI::DrawItem(4, "Card slot status:", Hardware::GetCardSlotStatus()? "inserted" : "not inserted");
-        GUI::DrawItem(5, "SD status:", Hardware::IsSdInserted()? "inserted" : "not inserted");
+        GUI::DrawItem(3, "Headphone status:", live.audioJackInserted? "inserted" : "not inserted");
+        GUI::DrawItem(4, "Card slot status:", live.cardSlotInserted? "inserted" : "not inserted");
+        GUI::DrawItem(5, "SD status:", live.sdInserted? "inserted" : "not inserted");
         GUI::DrawItem(6, "Sound output:", info.soundOutputMode);
         
         if (isNew3DS) {
-            GUI::DrawItemf(7, "Brightness level:", "%lu (auto-brightness mode: %s)", Hardware::GetBrightness(GSPLCD_SCREEN_TOP), 
+            GUI::DrawItemf(7, "Brightness level:", "%lu (auto-brightness mode: %s)", live.brightness, 
                 Hardware::GetAutoBrightnessStatus());
         }
         else {
-            GUI::DrawItemf(7, "Brightness level:", "%lu", Hardware::GetBrightness(GSPLCD_SCREEN_TOP));
+            GUI::DrawItemf(7, "Brightness level:", "%lu", live.brightness);
         }
     }
 
@@ -315,17 +453,182 @@ namespace GUI {
         GUI::DrawImage(driveIcon, 220, 135);
     }
 
-    static void MiscInfoPage(const MiscInfo &info, bool &displayInfo) {
+    static void MiscInfoPage(const MiscInfo &info, const LiveInfo &live, const GraphSeries &wifiGraph, bool &displayInfo) {
         GUI::DrawItem(1, "Manufacturing date:", info.manufacturingDate);
         GUI::DrawItemf(2, "Installed titles:", "SD: %lu (NAND: %lu)", info.sdTitleCount, info.nandTitleCount);
         GUI::DrawItemf(3, "Installed tickets:", "%lu", info.ticketCount);
+        GUI::DrawItemf(4, "WiFi signal strength:", "%d (%.0lf%%)", live.wifiStrength, static_cast<float>(live.wifiStrength * 33.33));
+        GUI::DrawItem(5, "IP:", displayInfo? live.hostname : "");
+        GUI::DrawGraph(wifiGraph, 15, 200, 32);
+    }
 
-        u8 wifiStrength = osGetWifiStrength();
-        GUI::DrawItemf(4, "WiFi signal strength:", "%d (%.0lf%%)", wifiStrength, static_cast<float>(wifiStrength * 33.33));
-        
-        char hostname[128];
-        gethostname(hostname, sizeof(hostname));
-        GUI::DrawItem(5, "IP:", displayInfo? hostname : "");
+    static void DrawHistogram(const u32 *buckets, u32 count, float x, float y, float width, float height, u32 colour) {
+        u32 max = 1;
+        for (u32 i = 0; i < count; i++) {
+            max = buckets[i] > max? buckets[i] : max;
+        }
+
+        float barWidth = width / count;
+        C2D_DrawRectSolid(x, y + height, guiTexSize, width, 1, guiTitleColour);
+
+        for (u32 i = 0; i < count; i++) {
+            float barHeight = (static_cast<float>(buckets[i]) / static_cast<float>(max)) * height;
+            C2D_DrawRectSolid(x + (i * barWidth), y + height - barHeight, guiTexSize, barWidth > 1.f? barWidth - 1.f : barWidth, barHeight, colour);
+        }
+    }
+
+    static void InputTimingView(const InputTiming &timing, const char *exportStatus) {
+        const u32 colour = C2D_Color32(77, 76, 74, 255);
+        double seconds = timing.updates > 1? static_cast<double>(timing.lastTick - timing.firstTick) / SYSCLOCK_ARM11 : 0.0;
+        double variance = timing.updates > 2? timing.intervalM2 / static_cast<double>(timing.updates - 2) : 0.0;
+
+        GUI::DrawText(90, 40, 0.45f, guiTitleColour, "3DSident Input Timing");
+        GUI::DrawTextf(90, 56, 0.45f, colour, "HID updates: %lu (%lu missed)", timing.updates, timing.missed);
+        GUI::DrawTextf(90, 70, 0.45f, colour, "Rate: %.1f Hz, %.2f ms (jitter %.2f ms)", seconds > 0.0? (timing.updates - 1) / seconds : 0.0,
+            timing.intervalMean / CPU_TICKS_PER_MSEC, std::sqrt(variance) / CPU_TICKS_PER_MSEC);
+        GUI::DrawTextf(90, 84, 0.45f, colour, "Seen after: %.2f ms", timing.updates? (timing.delayTotal / timing.updates) / CPU_TICKS_PER_MSEC : 0.0);
+        GUI::DrawTextf(90, 98, 0.45f, colour, "Press to present: %.1f ms (max %.1f)",
+            timing.latencies? (timing.latencyTotal / timing.latencies) / CPU_TICKS_PER_MSEC : 0.0, timing.latencyMax / CPU_TICKS_PER_MSEC);
+        GUI::DrawTextf(90, 112, 0.45f, colour, "Presses measured: %lu", timing.latencies);
+        GUI::DrawTextf(90, 138, 0.45f, colour, "Press Y to save, X to reset. %s", exportStatus);
+    }
+
+    static void StickItem(float y, const char *name, const StickInfo &info, bool available) {
+        const u32 colour = C2D_Color32(77, 76, 74, 255);
+
+        if (!available) {
+            GUI::DrawTextf(90, y, 0.45f, colour, "%s: not available", name);
+            return;
+        }
+
+        GUI::DrawTextf(90, y, 0.45f, colour, "%s: mean %+.1f, %+.1f sd %.1f, %.1f", name, info.meanX, info.meanY,
+            StickStats::GetStdDevX(info), StickStats::GetStdDevY(info));
+        GUI::DrawTextf(90, y + 14, 0.45f, colour, "Drift: %.1f%% out, %lu times, max r %lu", info.count? (info.outside * 100.0) / info.count : 0.0,
+            info.excursions, info.maxRadius);
+    }
+
+    // Occupancy cells shaded on a log scale, with the live position on top. Only visited cells are drawn.
+    static void DrawCoverage(const StickInfo &info, const circlePosition &position, float x, float y, u32 colour) {
+        const float cell = 4.f, size = cell * 32;
+        u32 max = 1;
+
+        C2D_DrawRectSolid(x - 1, y - 1, guiTexSize, size + 2, size + 2, guiTitleColour);
+        C2D_DrawRectSolid(x, y, guiTexSize, size, size, guiMenuBarColour);
+
+        for (u32 row = 0; row < 32; row++) {
+            for (u32 column = 0; column < 32; column++) {
+                max = info.occupancy[row][column] > max? info.occupancy[row][column] : max;
+            }
+        }
+
+        float scale = 191.f / std::log(static_cast<float>(max) + 1.f);
+
+        for (u32 row = 0; row < 32; row++) {
+            for (u32 column = 0; column < 32; column++) {
+                if (info.occupancy[row][column]) {
+                    u8 alpha = 64 + static_cast<u8>(std::log(static_cast<float>(info.occupancy[row][column]) + 1.f) * scale);
+                    C2D_DrawRectSolid(x + (column * cell), y + size - ((row + 1) * cell), guiTexSize, cell, cell, (colour & 0x00FFFFFF) | (alpha << 24));
+                }
+            }
+        }
+
+        C2D_DrawRectSolid(x + (size / 2), y, guiTexSize, 1, size, guiDescrColour);
+        C2D_DrawRectSolid(x, y + (size / 2), guiTexSize, size, 1, guiDescrColour);
+
+        float dotX = x + ((position.dx + StickStats::range) * size) / (2 * StickStats::range);
+        float dotY = y + size - (((position.dy + StickStats::range) * size) / (2 * StickStats::range));
+        C2D_DrawRectSolid(dotX - 2, dotY - 2, guiTexSize, 4, 4, guiTitleColour);
+    }
+
+    // Strokes accumulate in a texture, each frame only draws the segments captured since the previous one, at most
+    // guiTouchBatch of them so a backlog is spread over several frames. Samples are counted even when there is no
+    // texture to draw them into.
+    static C3D_Tex guiTouchTex;
+    static C3D_RenderTarget *guiTouchTarget = nullptr;
+    static const Tex3DS_SubTexture guiTouchSubTex = { 320, 240, 0.f, 1.f, 320.f / 512.f, 1.f - (240.f / 256.f) };
+    static const u32 guiTouchBatch = 1024;
+
+    static void DrawTouchStrokes(TouchInfo &info, u32 &drawn, TouchSample &previous, u32 colour, bool draw) {
+        static TouchSample samples[guiTouchBatch];
+        u32 count = InputMonitor::ReadTouch(drawn, samples, guiTouchBatch);
+
+        for (u32 i = 0; i < count; i++) {
+            const TouchSample &sample = samples[i];
+            TouchTest::Add(info, sample);
+
+            if (!draw) {
+                previous = sample;
+                continue;
+            }
+
+            if ((sample.x != touchPenUp) && (previous.x != touchPenUp)) {
+                C2D_DrawLine(previous.x, previous.y, colour, sample.x, sample.y, colour, 2.f, guiTexSize);
+            }
+            else if (sample.x != touchPenUp) {
+                C2D_DrawRectSolid(sample.x - 1, sample.y - 1, guiTexSize, 2, 2, colour);
+            }
+
+            previous = sample;
+        }
+
+        drawn += count;
+    }
+
+    static void TouchView(const TouchInfo &info, const char *exportStatus, u32 colour) {
+        GUI::DrawText(90, 40, 0.45f, guiTitleColour, "3DSident Touch Test");
+        GUI::DrawTextf(90, 56, 0.45f, colour, "Samples: %lu", info.samples);
+        GUI::DrawTextf(90, 70, 0.45f, colour, "Cells touched: %lu / 1200", info.coveredCells);
+
+        if (info.gridRunning) {
+            GUI::DrawTextf(90, 84, 0.45f, colour, "Tap target %lu of %lu", info.target + 1, TouchTest::gridColumns * TouchTest::gridRows);
+        }
+        else if (info.target) {
+            float total = 0.f, max = 0.f;
+
+            for (u32 i = 0; i < info.target; i++) {
+                float error = TouchTest::GetError(info, i);
+                total += error;
+                max = error > max? error : max;
+            }
+
+            GUI::DrawTextf(90, 84, 0.45f, colour, "Grid error: %.1f px mean, %.1f px max", total / info.target, max);
+        }
+
+        GUI::DrawText(90, 112, 0.45f, colour, "Press A to run the grid test.");
+        GUI::DrawTextf(90, 138, 0.45f, colour, "Press Y to save, X to reset. %s", exportStatus);
+    }
+
+    // Grid targets with the measured error of each, and once most of the panel has been painted the cells still
+    // untouched, which are likely dead.
+    static void DrawTouchResults(const TouchInfo &info) {
+        const u32 targetColour = C2D_Color32(252, 252, 252, 255), goodColour = C2D_Color32(90, 200, 90, 255), badColour = C2D_Color32(230, 60, 60, 255);
+
+        if (info.coveredCells >= 1080) {
+            for (u32 row = 0; row < 30; row++) {
+                for (u32 column = 0; column < 40; column++) {
+                    if (!info.coverage[row][column]) {
+                        C2D_DrawRectSolid(column * 8, row * 8, guiTexSize, 8, 8, badColour);
+                    }
+                }
+            }
+        }
+
+        for (u32 i = 0; i < info.target; i++) {
+            u16 x = 0, y = 0;
+            TouchTest::GetTarget(i, x, y);
+            float hitX = x + info.errorX[i / TouchTest::gridColumns][i % TouchTest::gridColumns];
+            float hitY = y + info.errorY[i / TouchTest::gridColumns][i % TouchTest::gridColumns];
+            u32 colour = TouchTest::GetError(info, i) > 8.f? badColour : goodColour;
+            C2D_DrawLine(x, y, colour, hitX, hitY, colour, 1.f, guiTexSize);
+            C2D_DrawRectSolid(hitX - 2, hitY - 2, guiTexSize, 4, 4, colour);
+        }
+
+        if (info.gridRunning) {
+            u16 x = 0, y = 0;
+            TouchTest::GetTarget(info.target, x, y);
+            C2D_DrawRectSolid(x - 8, y, guiTexSize, 17, 1, targetColour);
+            C2D_DrawRectSolid(x, y - 8, guiTexSize, 1, 17, targetColour);
+        }
     }
 
     static void DrawControllerImage(int keys, C2D_Image button, int defaultX, int defaultY, int keyLeft, int keyRight, int keyUp, int keyDown) {
@@ -361,6 +664,25 @@ namespace GUI {
         const u32 guiButtonTesterText = C2D_Color32(77, 76, 74, 255);
         const u32 guiButtonTesterSliderBorder = C2D_Color32(219, 219, 219, 255);
         const u32 guiButtonTesterSlider = C2D_Color32(241, 122, 74, 255);
+
+        // The input monitor timestamps HID updates for the whole session, select + start switches to its results.
+        int mode = TESTER_BUTTONS;
+        const char *exportStatus = "";
+        InputTiming timing;
+        static StickInfo padInfo, stickInfo;
+        static TouchInfo touchInfo;
+        u32 touchDrawn = 0;
+        TouchSample touchPrevious = { touchPenUp, touchPenUp };
+        bool touchClear = true;
+
+        if (enabled) {
+            InputMonitor::Start();
+            TouchTest::Init(touchInfo);
+
+            if (!guiTouchTarget && C3D_TexInitVRAM(std::addressof(guiTouchTex), 512, 256, GPU_RGBA8)) {
+                guiTouchTarget = C3D_RenderTargetCreateFromTex(std::addressof(guiTouchTex), GPU_TEXFACE_2D, 0, -1);
+            }
+        }
         
         while (enabled) {
             hidScanInput();
@@ -370,6 +692,9 @@ namespace GUI {
             
             u32 kDown = hidKeysDown();
             u32 kHeld = hidKeysHeld();
+
+            u64 pressTick = 0;
+            bool pressPending = kDown && InputMonitor::TakePress(kDown, pressTick);
             
             HIDUSER_GetSoundVolume(std::addressof(volume));
             
@@ -377,6 +702,36 @@ namespace GUI {
                 aptSetHomeAllowed(true);
                 enabled = false;
             }
+
+            if ((kHeld & KEY_SELECT) && (kDown & KEY_START)) {
+                mode = (mode + 1) % TESTER_MAX;
+                GUI::ClearText();
+            }
+
+            if (mode != TESTER_BUTTONS) {
+                if (kDown & KEY_X) {
+                    InputMonitor::Reset();
+                    TouchTest::Init(touchInfo);
+                    touchDrawn = 0;
+                    touchPrevious = { touchPenUp, touchPenUp };
+                    touchClear = true;
+                    exportStatus = "";
+                }
+
+                if ((kDown & KEY_Y) && (mode == TESTER_TIMING)) {
+                    exportStatus = R_SUCCEEDED(InputMonitor::Export("/3ds/3dsident_input.csv"))? "Saved." : "Failed.";
+                }
+                else if ((kDown & KEY_Y) && (mode == TESTER_STICKS)) {
+                    exportStatus = R_SUCCEEDED(InputMonitor::ExportSticks("/3ds/3dsident_sticks.csv"))? "Saved." : "Failed.";
+                }
+                else if (kDown & KEY_Y) {
+                    exportStatus = R_SUCCEEDED(TouchTest::Export(touchInfo, "/3ds/3dsident_touch.csv"))? "Saved." : "Failed.";
+                }
+
+                if ((kDown & KEY_A) && (mode == TESTER_TOUCH)) {
+                    TouchTest::StartGrid(touchInfo);
+                }
+            }
             
             if (kHeld & KEY_TOUCH)  {
                 hidTouchRead(&touch);
@@ -385,28 +740,61 @@ namespace GUI {
             }
 
             GUI::Begin(C2D_Color32(60, 61, 63, 255), C2D_Color32(94, 39, 80, 255));
+
+            if ((mode == TESTER_TOUCH) && guiTouchTarget) {
+                C2D_SceneBegin(guiTouchTarget);
+
+                if (touchClear) {
+                    C2D_TargetClear(guiTouchTarget, C2D_Color32(0, 0, 0, 0));
+                    touchClear = false;
+                }
+
+                GUI::DrawTouchStrokes(touchInfo, touchDrawn, touchPrevious, guiButtonTesterSlider, true);
+                C2D_SceneBegin(c3dRenderTarget[TARGET_TOP]);
+            }
+            else if (mode == TESTER_TOUCH) {
+                GUI::DrawTouchStrokes(touchInfo, touchDrawn, touchPrevious, guiButtonTesterSlider, false);
+            }
             
             C2D_DrawRectSolid(75, 30, guiTexSize, 250, 210, C2D_Color32(97, 101, 104, 255));
             C2D_DrawRectSolid(85, 40, guiTexSize, 230, 175, C2D_Color32(242, 241, 239, 255));
             C2D_DrawRectSolid(85, 40, guiTexSize, 230, 15, C2D_Color32(66, 65, 61, 255));
             
-            GUI::DrawText(90, 40, 0.45f, guiTitleColour, "3DSident Button Test");
-            
-            GUI::DrawTextf(90, 56, 0.45f, guiButtonTesterText, "Circle pad: %04d, %04d", circlePad.dx, circlePad.dy);
-            GUI::DrawTextf(90, 70, 0.45f, guiButtonTesterText, "C stick: %04d, %04d", cStick.dx, cStick.dy);
-            GUI::DrawTextf(90, 84, 0.45f, guiButtonTesterText, "Touch position: %03d, %03d", touch.px, touch.py);
-            
-            GUI::DrawImage(volumeIcon, 90, 98);
-            double volPercent = (volume * 1.5873015873);
-            C2D_DrawRectSolid(115, 104, guiTexSize, 190, 5, guiButtonTesterSliderBorder);
-            C2D_DrawRectSolid(115, 104, guiTexSize, ((volPercent / 100) * 190), 5, guiButtonTesterSlider);
-            
-            GUI::DrawText(90, 118, 0.45f, guiButtonTesterText, "3D");
-            double _3dSliderPercent = (osGet3DSliderState() * 100.0);
-            C2D_DrawRectSolid(115, 122, guiTexSize, 190, 5, guiButtonTesterSliderBorder);
-            C2D_DrawRectSolid(115, 122, guiTexSize, ((_3dSliderPercent / 100) * 190), 5, guiButtonTesterSlider);
+            if (mode == TESTER_TIMING) {
+                InputMonitor::GetTiming(timing);
+                GUI::InputTimingView(timing, exportStatus);
+            }
+            else if (mode == TESTER_STICKS) {
+                InputMonitor::GetSticks(padInfo, stickInfo);
+                GUI::DrawText(90, 40, 0.45f, guiTitleColour, "3DSident Stick Test");
+                GUI::StickItem(56, "Circle pad", padInfo, true);
+                GUI::StickItem(84, "C stick", stickInfo, InputMonitor::HasCstick());
+                GUI::DrawTextf(90, 112, 0.45f, guiButtonTesterText, "Samples: %lu", padInfo.count);
+                GUI::DrawTextf(90, 138, 0.45f, guiButtonTesterText, "Press Y to save trace, X to reset. %s", exportStatus);
+            }
+            else if (mode == TESTER_TOUCH) {
+                GUI::TouchView(touchInfo, exportStatus, guiButtonTesterText);
+            }
+            else {
+                GUI::DrawText(90, 40, 0.45f, guiTitleColour, "3DSident Button Test");
+                
+                GUI::DrawTextf(90, 56, 0.45f, guiButtonTesterText, "Circle pad: %04d, %04d", circlePad.dx, circlePad.dy);
+                GUI::DrawTextf(90, 70, 0.45f, guiButtonTesterText, "C stick: %04d, %04d", cStick.dx, cStick.dy);
+                GUI::DrawTextf(90, 84, 0.45f, guiButtonTesterText, "Touch position: %03d, %03d", touch.px, touch.py);
+                
+                GUI::DrawImage(volumeIcon, 90, 98);
+                double volPercent = (volume * 1.5873015873);
+                C2D_DrawRectSolid(115, 104, guiTexSize, 190, 5, guiButtonTesterSliderBorder);
+                C2D_DrawRectSolid(115, 104, guiTexSize, ((volPercent / 100) * 190), 5, guiButtonTesterSlider);
+                
+                GUI::DrawText(90, 118, 0.45f, guiButtonTesterText, "3D");
+                double _3dSliderPercent = (osGet3DSliderState() * 100.0);
+                C2D_DrawRectSolid(115, 122, guiTexSize, 190, 5, guiButtonTesterSliderBorder);
+                C2D_DrawRectSolid(115, 122, guiTexSize, ((_3dSliderPercent / 100) * 190), 5, guiButtonTesterSlider);
+            }
             
-            GUI::DrawText(90, 138, 0.45f, guiButtonTesterText, "Press L + R to return.");
+            GUI::DrawText(90, 152, 0.45f, guiButtonTesterText, "Press L + R to return.");
+            GUI::DrawText(90, 166, 0.45f, guiButtonTesterText, "Select + Start: next test.");
 
             SystemStateInfo info = Service::GetSystemStateInfo();
             ((info.rawButtonState >> 1) & 1) == 0? GUI::DrawImageBlend(btnHome, 180, 215, guiSelectorColour): GUI::DrawImage(btnHome, 180, 215);
@@ -427,14 +815,666 @@ namespace GUI {
             GUI::DrawControllerImage(kHeld, btnCstick, 330, 35, KEY_CSTICK_LEFT, KEY_CSTICK_RIGHT, KEY_CSTICK_UP, KEY_CSTICK_DOWN);
             
             C2D_SceneBegin(c3dRenderTarget[TARGET_BOTTOM]);
-            GUI::DrawImage(cursor, touchX, touchY);
+
+            if (mode == TESTER_TIMING) {
+                GUI::DrawText(10, 10, 0.45f, guiTitleColour, "HID update interval, 0 - 16 ms");
+                GUI::DrawHistogram(timing.intervalHistogram, 64, 10, 26, 300, 80, guiButtonTesterSlider);
+                GUI::DrawText(10, 120, 0.45f, guiTitleColour, "Press to present, 0 - 64 ms");
+                GUI::DrawHistogram(timing.latencyHistogram, 64, 10, 136, 300, 80, guiButtonTesterSlider);
+            }
+            else if (mode == TESTER_STICKS) {
+                GUI::DrawText(20, 30, 0.45f, guiTitleColour, "Circle pad");
+                GUI::DrawCoverage(padInfo, circlePad, 20, 50, guiButtonTesterSlider);
+                GUI::DrawText(172, 30, 0.45f, guiTitleColour, "C stick");
+                GUI::DrawCoverage(stickInfo, cStick, 172, 50, guiButtonTesterSlider);
+                GUI::DrawTextf(20, 190, 0.45f, guiTitleColour, "Cells visited: %lu (circle pad), %lu (C stick)", padInfo.coveredCells, stickInfo.coveredCells);
+            }
+            else if (mode == TESTER_TOUCH) {
+                if (guiTouchTarget) {
+                    C2D_Image strokes = { std::addressof(guiTouchTex), std::addressof(guiTouchSubTex) };
+                    GUI::DrawImage(strokes, 0, 0);
+                }
+
+                GUI::DrawTouchResults(touchInfo);
+            }
+            else {
+                GUI::DrawImage(cursor, touchX, touchY);
+            }
+
+            GUI::End();
+
+            // The frame reacting to the press has been handed to the GPU.
+            if (pressPending) {
+                InputMonitor::RecordLatency(svcGetSystemTick() - pressTick);
+            }
+        }
+
+        InputMonitor::Stop();
+
+        if (guiTouchTarget) {
+            C3D_RenderTargetDelete(guiTouchTarget);
+            C3D_TexDelete(std::addressof(guiTouchTex));
+            guiTouchTarget = nullptr;
+        }
+    }
+
+    static void DiskBenchView(const DiskBenchConfig &config, bool started) {
+        static DiskBenchResult results[DISK_TEST_MAX];
+        bool running = DiskBench::IsRunning();
+
+        GUI::DrawItemf(1, "Block size:", "%lu KiB, random %lu KiB (left/right)", config.blockSize / 1024, config.randomBlockSize / 1024);
+        GUI::DrawItemf(2, "Queue depth:", "%lu (L/R)", config.queueDepth);
+
+        if (running) {
+            GUI::DrawItemf(3, "Status:", "running, %.0f%%", DiskBench::GetProgress() * 100.f);
+            return;
+        }
+
+        if (!started) {
+            GUI::DrawItemf(3, "Status:", "press A to test with a %lu MiB file in /3ds/", config.fileSize / (1024 * 1024));
+            return;
+        }
+
+        DiskBench::GetResults(results);
+        GUI::DrawItem(3, "Status:", R_FAILED(results[DISK_TEST_MAX - 1].result) || (results[DISK_TEST_MAX - 1].ops == 0)? "failed" : "done, press A to run again");
+
+        for (int i = 0; i < DISK_TEST_MAX; i++) {
+            const DiskBenchResult &result = results[i];
+
+            if (result.ops) {
+                GUI::DrawItemf(4 + i, DiskBench::GetTestName(static_cast<DiskTest>(i)), "%.2f MB/s, %.0f IOPS, p50/p99 %lu/%lu us", result.mbPerSecond,
+                    result.iops, result.latency50, result.latency99);
+            }
+        }
+    }
+
+    static void NandBenchView(u32 chunkSize, bool started) {
+        static NandBenchResult results[NAND_BENCH_MAX];
+
+        GUI::DrawItemf(1, "Chunk size:", "%lu KiB (left/right)", chunkSize / 1024);
+
+        if (NandBench::IsRunning()) {
+            GUI::DrawItemf(2, "Status:", "reading, %.0f%%", NandBench::GetProgress() * 100.f);
+            return;
+        }
+
+        if (!started) {
+            GUI::DrawItem(2, "Status:", "press A to read system files, nothing is written");
+            return;
+        }
+
+        NandBench::GetResults(results);
+        GUI::DrawItem(2, "Status:", "done, press A to run again");
+
+        for (int i = 0; i < NAND_BENCH_MAX; i++) {
+            const NandBenchResult &result = results[i];
+            const char *name = NandBench::GetArchiveName(static_cast<NandBenchArchive>(i));
+
+            if (R_FAILED(result.result)) {
+                GUI::DrawItemf(3 + (i * 3), name, "can't open archive: 0x%lx", result.result);
+                continue;
+            }
+
+            GUI::DrawItemf(3 + (i * 3), name, "%.2f MB/s, %lu files, %lu reads, %lu errors", result.mbPerSecond, result.files, result.reads, result.errors);
+            GUI::DrawItemf(4 + (i * 3), "Latency:", "p50 %lu, p90 %lu, p99 %lu, max %lu us", result.latency50, result.latency90, result.latency99, result.latencyMax);
+        }
+    }
+
+    static void TitlesView(TitleSortKey sortKey, bool started) {
+        char size[16];
+
+        if (Titles::IsRunning()) {
+            GUI::DrawItemf(1, "Status:", "reading titles, %.0f%%", Titles::GetProgress() * 100.f);
+            return;
+        }
+
+        if (!started) {
+            GUI::DrawItem(1, "Status:", "press A to list installed titles");
+            return;
+        }
+
+        const TitleTable &table = Titles::GetTable();
+
+        if (R_FAILED(table.result)) {
+            GUI::DrawItemf(1, "Status:", "failed: 0x%lx, press A to retry", table.result);
+            return;
+        }
+
+        GUI::DrawItemf(1, "Status:", "%lu titles, %lu unreadable, press A to refresh", table.count, table.errors);
+
+        for (int i = 0; i < 3; i++) {
+            if (R_FAILED(table.mediaResults[i])) {
+                GUI::DrawItemf(2 + i, Titles::GetMediaName(static_cast<FS_MediaType>(i)), "failed: 0x%lx", table.mediaResults[i]);
+                continue;
+            }
+
+            Utils::GetSizeString(size, table.mediaSizes[i]);
+            GUI::DrawItemf(2 + i, Titles::GetMediaName(static_cast<FS_MediaType>(i)), "%lu titles, %s", table.mediaCounts[i], size);
+        }
+
+        GUI::DrawItemf(6, "Sorted by:", "%s (left/right), up/down to scroll", Titles::GetSortName(sortKey));
+    }
+
+    static void TicketsView(bool started, const char *exportStatus) {
+        TicketJoinCounts counts;
+
+        if (Tickets::IsRunning()) {
+            GUI::DrawItem(1, "Status:", "reading tickets and titles...");
+            return;
+        }
+
+        if (!started) {
+            GUI::DrawItem(1, "Status:", "press A to match tickets against installed titles");
+            return;
+        }
+
+        if (R_FAILED(Tickets::GetResult())) {
+            GUI::DrawItemf(1, "Status:", "failed: 0x%lx", Tickets::GetResult());
+            return;
+        }
+
+        Tickets::GetCounts(counts);
+        GUI::DrawItem(1, "Status:", "done, press A to refresh");
+        GUI::DrawItemf(2, "Tickets:", "%lu", counts.tickets);
+        GUI::DrawItemf(3, "Installed titles:", "%lu (%lu with a ticket)", counts.titles, counts.matched);
+        GUI::DrawItemf(4, "Orphan tickets:", "%lu", counts.orphanTickets);
+        GUI::DrawItemf(5, "Titles without a ticket:", "%lu", counts.missingTickets);
+        GUI::DrawItem(6, "Press Y to save the lists to /3ds/.", exportStatus);
+    }
+
+    static void DiskUsageView(DiskUsageArchive archive, u32 directory, bool started, bool paused) {
+        const DiskUsageNode *node = DiskUsage::GetNode(directory);
+        DiskUsageStats stats;
+        char size[16];
+
+        DiskUsage::GetStats(stats);
+        GUI::DrawItemf(1, "Archive:", "%s (left/right)", DiskUsage::GetArchiveName(archive));
+
+        if (!started) {
+            GUI::DrawItem(2, "Status:", "press A to measure, NAND is only listed");
+            return;
+        }
+
+        if (DiskUsage::IsBusy()) {
+            GUI::DrawItemf(2, "Status:", "%s, %lu listed, %lu queued", paused? "paused" : "walking", stats.listed, stats.pending);
+        }
+        else {
+            GUI::DrawItemf(2, "Status:", "%lu directories listed, %lu changed", stats.listed, stats.changed);
+        }
+
+        if (node) {
+            Utils::GetSizeString(size, node->totalBytes);
+            GUI::DrawItemf(3, "Directory:", "/%s, %s, %lu files", DiskUsage::GetName(directory), size, node->files);
+        }
+
+        GUI::DrawItemf(4, "Tree:", "%lu directories, %lu left out, %lu errors", stats.nodes, stats.truncated, stats.errors);
+        GUI::DrawItem(5, "A: open, X: parent, Y: refresh this directory", "");
+        GUI::DrawItem(6, "R: pause or resume", "");
+    }
+
+    static void NetBenchView(const NetBenchConfig &config, bool started) {
+        static NetBenchResult results[NET_TEST_MAX];
+
+        GUI::DrawItemf(1, "Server:", "%s port %u (X to change)", config.host[0]? config.host : "not set", config.port);
+        GUI::DrawItemf(2, "Buffer size:", "%lu KiB, %lu MiB each way (left/right)", config.bufferSize / 1024, config.bytes / (1024 * 1024));
+
+        if (NetBench::IsRunning()) {
+            GUI::DrawItemf(3, "Status:", "running, %.0f%%", NetBench::GetProgress() * 100.f);
+            return;
+        }
+
+        if (!started) {
+            GUI::DrawItem(3, "Status:", "start tools/netserver on the host, then press A");
+            return;
+        }
+
+        NetBench::GetResults(results);
+        GUI::DrawItem(3, "Status:", "done, press A to run again");
+
+        for (int i = 0; i < NET_TEST_MAX; i++) {
+            const NetBenchResult &result = results[i];
+            const char *name = NetBench::GetTestName(static_cast<NetTest>(i));
+
+            if (R_FAILED(result.result)) {
+                GUI::DrawItemf(4 + i, name, "failed: %s", std::strerror(-result.result));
+                break;
+            }
+            else if (i == NET_TEST_UDP_PING) {
+                GUI::DrawItemf(4 + i, name, "%lu of %lu replies, %.1f%% lost", result.received, result.sent, result.loss);
+                GUI::DrawItemf(5 + i, "Round trip:", "p50 %lu, p90 %lu, p99 %lu, max %lu us", result.rtt50, result.rtt90, result.rtt99, result.rttMax);
+            }
+            else {
+                GUI::DrawItemf(4 + i, name, "%.2f Mbit/s", result.mbitPerSecond);
+            }
+        }
+    }
+
+    static void HttpServerView(bool failed) {
+        HttpServerStats stats;
+        struct in_addr address;
+
+        if (!HttpServer::IsRunning()) {
+            GUI::DrawItem(1, "Status:", failed? "can't listen, is Wi-Fi connected?" : "stopped, press A to start");
+            GUI::DrawItem(2, "Serves:", "/report.json and /live as JSON");
+            return;
+        }
+
+        HttpServer::GetStats(stats);
+        address.s_addr = gethostid();
+        GUI::DrawItemf(1, "Status:", "http://%s:%u/, press A to stop", inet_ntoa(address), HttpServer::defaultPort);
+        GUI::DrawItemf(2, "Connections:", "%lu open, %lu accepted", stats.connections, stats.accepted);
+        GUI::DrawItemf(3, "Requests:", "%lu, %lu answered with an error", stats.requests, stats.errors);
+        GUI::DrawItemf(4, "Sent:", "%llu KiB", static_cast<unsigned long long>(stats.bytes / 1024));
+        GUI::DrawItemf(5, "Snapshots:", "report %lu, live %lu", stats.reportVersion, stats.liveVersion);
+        GUI::DrawItem(6, "Keeps serving after the Tools page is closed.", "");
+    }
+
+    static void TelemetryView(const TelemetryConfig &config, bool failed) {
+        TelemetryStats stats;
+
+        GUI::DrawItemf(1, "Collector:", "%s port %u (X to change)", config.host[0]? config.host : "not set", config.port);
+        GUI::DrawItemf(2, "Period:", "a sample every %lu ms, %lu per datagram (left/right)", config.period, config.batch);
+        Telemetry::GetStats(stats);
+
+        if (!Telemetry::IsRunning()) {
+            if (failed) {
+                GUI::DrawItemf(3, "Status:", "can't start: %s", R_FAILED(stats.result)? std::strerror(-stats.result) : "no thread");
+            }
+            else {
+                GUI::DrawItem(3, "Status:", "start tools/collector on the host, then press A");
+            }
+
+            GUI::DrawItem(4, "Sends:", "battery, temperature, Wi-Fi, free space, frame times");
+            return;
+        }
+
+        GUI::DrawItemf(3, "Status:", "session %08lX, press A to stop", stats.session);
+        GUI::DrawItemf(4, "Sent:", "%lu samples in %lu datagrams, %llu KiB", stats.samples, stats.datagrams,
+            static_cast<unsigned long long>(stats.bytes / 1024));
+        GUI::DrawItemf(5, "Send errors:", "%lu%s%s", stats.errors, R_FAILED(stats.result)? ", last: " : "", R_FAILED(stats.result)? std::strerror(-stats.result) : "");
+        GUI::DrawItem(6, "Keeps sending after the Tools page is closed.", "");
+    }
+
+    // The software keyboard runs its own applet loop, call it between frames.
+    static void EditHost(char *host, size_t size, const char *hint) {
+        SwkbdState swkbd;
+        char text[64];
+
+        swkbdInit(std::addressof(swkbd), SWKBD_TYPE_NORMAL, 2, sizeof(text) - 1);
+        swkbdSetHintText(std::addressof(swkbd), hint);
+        swkbdSetInitialText(std::addressof(swkbd), host);
+        swkbdSetValidation(std::addressof(swkbd), SWKBD_NOTEMPTY_NOTBLANK, 0, 0);
+
+        if (swkbdInputText(std::addressof(swkbd), text, sizeof(text)) == SWKBD_BUTTON_CONFIRM) {
+            std::snprintf(host, size, "%s", text);
+        }
+    }
+
+    // Subdirectories largest first, the bar is each one's share of the directory shown.
+    static void DrawDiskUsageList(u32 directory, u32 first, u32 selected) {
+        static u32 children[256];
+        const DiskUsageNode *parent = DiskUsage::GetNode(directory);
+        u32 count = DiskUsage::GetChildren(directory, children, 256);
+        char size[16];
+
+        for (u32 i = 0; (i < 14) && (first + i < count); i++) {
+            const DiskUsageNode *node = DiskUsage::GetNode(children[first + i]);
+            float y = 24 + (i * 14);
+            float share = (parent && parent->totalBytes)? static_cast<float>(node->totalBytes) / static_cast<float>(parent->totalBytes) : 0.f;
+
+            if (first + i == selected) {
+                C2D_DrawRectSolid(20, y, guiTexSize, 280, 14, guiSelectorColour);
+            }
+
+            C2D_DrawRectSolid(24, y + 11, guiTexSize, 272 * share, 2, guiGraphColour);
+            Utils::GetSizeString(size, node->totalBytes);
+            GUI::DrawTextf(24, y, 0.45f, guiTitleColour, "%.28s", DiskUsage::GetName(children[first + i]));
+            GUI::DrawText(220, y, 0.45f, guiDescrColour, size);
+        }
+    }
+
+    // One row per title of the sorted view, starting at row first.
+    static void DrawTitleList(u32 first, float y, u32 rows) {
+        const TitleTable &table = Titles::GetTable();
+        char size[16];
+
+        for (u32 i = 0; (i < rows) && (first + i < table.count); i++) {
+            u32 index = table.order[first + i];
+            Utils::GetSizeString(size, table.sizes[index]);
+            GUI::DrawTextf(24, y + (i * 14), 0.45f, guiTitleColour, "%016llX", static_cast<unsigned long long>(table.ids[index]));
+            GUI::DrawTextf(150, y + (i * 14), 0.45f, guiDescrColour, "v%u", table.versions[index]);
+            GUI::DrawTextf(196, y + (i * 14), 0.45f, guiDescrColour, "%s", size);
+        }
+    }
+
+    // Tools run on demand and may take a while, they get their own loop so the pages don't poll while they run.
+    void ToolsMenu(bool &enabled, const ProbeResults &results, u32 probeMask, bool displayInfo) {
+        const char *tools[TOOL_MAX] = {
+            "SD card benchmark",
+            "NAND read benchmark",
+            "Title inventory",
+            "Ticket check",
+            "Disk usage",
+            "Network test",
+            "HTTP server",
+            "Telemetry push"
+        };
+
+        const u32 blockSizes[] = { 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+        const u32 chunkSizes[] = { 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024 };
+        const u32 nandBudget = 8 * 1024 * 1024;
+        const u32 netBufferSizes[] = { 8 * 1024, 16 * 1024, 32 * 1024, 64 * 1024 };
+        const u32 telemetryPeriods[] = { 100, 250, 1000, 5000 };
+        static char netHost[64], telemetryHost[64];
+        int selection = 0, active = -1;
+        u32 nandChunk = 1;
+        u32 titleScroll = 0;
+        TitleSortKey titleSort = TITLE_SORT_ID;
+        const char *ticketExportStatus = "";
+        DiskUsageArchive duArchive = DISK_USAGE_SDMC;
+        u32 duDirectory = 0, duSelected = 0;
+        bool duStarted = false, duPaused = false;
+        bool benchStarted = false, nandStarted = false, titlesStarted = false, ticketsStarted = false, netStarted = false, httpFailed = false;
+        bool telemetryFailed = false;
+        DiskBenchConfig benchConfig;
+        DiskBench::GetDefaultConfig(benchConfig);
+        NetBenchConfig netConfig;
+        NetBench::GetDefaultConfig(netConfig);
+        netConfig.host = netHost;
+        TelemetryConfig telemetryConfig;
+        Telemetry::GetDefaultConfig(telemetryConfig);
+        telemetryConfig.host = telemetryHost;
+        u64 httpNextLive = 0, frameTick = svcGetSystemTick();
+
+        while (enabled && aptMainLoop()) {
+            u64 tick = svcGetSystemTick();
+            Telemetry::RecordFrame(tick - frameTick);
+            frameTick = tick;
+            GUI::Begin(guiBgcolour, guiBgcolour);
+
+            C2D_DrawRectSolid(0, 0, guiTexSize, 400, 20, guiStatusBarColour);
+            GUI::DrawText(5, 2, guiTexSize, guiTitleColour, active < 0? "Tools" : tools[active]);
+
+            if (active == TOOL_SD_BENCHMARK) {
+                GUI::DiskBenchView(benchConfig, benchStarted);
+            }
+            else if (active == TOOL_NAND_BENCHMARK) {
+                GUI::NandBenchView(chunkSizes[nandChunk], nandStarted);
+            }
+            else if (active == TOOL_TITLES) {
+                GUI::TitlesView(titleSort, titlesStarted);
+            }
+            else if (active == TOOL_TICKETS) {
+                GUI::TicketsView(ticketsStarted, ticketExportStatus);
+            }
+            else if (active == TOOL_DISK_USAGE) {
+                GUI::DiskUsageView(duArchive, duDirectory, duStarted, duPaused);
+            }
+            else if (active == TOOL_NETWORK) {
+                GUI::NetBenchView(netConfig, netStarted);
+            }
+            else if (active == TOOL_HTTP_SERVER) {
+                GUI::HttpServerView(httpFailed);
+            }
+            else if (active == TOOL_TELEMETRY) {
+                GUI::TelemetryView(telemetryConfig, telemetryFailed);
+            }
+            else {
+                GUI::DrawItem(1, "Press A to start a tool, B to return.", "");
+            }
+
+            C2D_SceneBegin(c3dRenderTarget[TARGET_BOTTOM]);
+
+            C2D_DrawRectSolid(15, 15, guiTexSize, 290, 210, guiTitleColour);
+            C2D_DrawRectSolid(16, 16, guiTexSize, 288, 208, guiMenuBarColour);
+            // The tool list while choosing, the running tool's own view after that.
+            if (active < 0) {
+                C2D_DrawRectSolid(16, 16 + (guiItemDistance * selection), guiTexSize, 288, 18, guiSelectorColour);
+
+                for (int i = 0; i < TOOL_MAX; i++) {
+                    GUI::DrawText(24, 17 + ((guiItemDistance - guiItemHeight) / 2) + (guiItemDistance * i), guiTexSize, guiTitleColour, tools[i]);
+                }
+            }
+            else if ((active == TOOL_DISK_USAGE) && duStarted) {
+                GUI::DrawDiskUsageList(duDirectory, duSelected >= 14? duSelected - 13 : 0, duSelected);
+            }
+            else if ((active == TOOL_TITLES) && titlesStarted && !Titles::IsRunning()) {
+                GUI::DrawTitleList(titleScroll, 24, 14);
+            }
+            else if ((active == TOOL_NAND_BENCHMARK) && nandStarted && !NandBench::IsRunning()) {
+                // Read latency distributions, 1 us to 65 ms on a log scale.
+                static NandBenchResult nandResults[NAND_BENCH_MAX];
+                NandBench::GetResults(nandResults);
+
+                for (int i = 0; i < NAND_BENCH_MAX; i++) {
+                    GUI::DrawText(24, 24 + (i * 100), guiTexSize, guiTitleColour, NandBench::GetArchiveName(static_cast<NandBenchArchive>(i)));
+                    GUI::DrawHistogram(nandResults[i].histogram, 64, 24, 42 + (i * 100), 272, 70, guiGraphColour);
+                }
+            }
+
             GUI::End();
+
+            // The main loop publishes the live values once a second, while the tools are open this one does.
+            if (HttpServer::IsRunning() && (osGetTime() >= httpNextLive)) {
+                static LiveInfo httpLive;
+                httpNextLive = osGetTime() + 1000;
+                Sampler::Read(httpLive);
+                HttpServer::PublishLive(httpLive);
+            }
+
+            hidScanInput();
+            u32 kDown = hidKeysDown();
+            bool busy = DiskBench::IsRunning();
+
+            if (kDown & KEY_B) {
+                if (active < 0) {
+                    enabled = false;
+                }
+
+                // Leaving a running benchmark cancels it, its scratch file is removed.
+                DiskBench::Stop();
+                NandBench::Stop();
+                Titles::Stop();
+                Tickets::Stop();
+                DiskUsage::Stop();
+                NetBench::Stop();
+                active = -1;
+                GUI::ClearText();
+                continue;
+            }
+
+            if (active < 0) {
+                if (kDown & KEY_DOWN) {
+                    selection = (selection + 1) % TOOL_MAX;
+                }
+                else if (kDown & KEY_UP) {
+                    selection = (selection + TOOL_MAX - 1) % TOOL_MAX;
+                }
+
+                if (kDown & KEY_A) {
+                    active = selection;
+                    GUI::ClearText();
+                }
+
+                continue;
+            }
+
+            if ((active == TOOL_SD_BENCHMARK) && !busy) {
+                u32 block = 0;
+
+                while ((block < 3) && (blockSizes[block] != benchConfig.blockSize)) {
+                    block++;
+                }
+
+                if (kDown & KEY_RIGHT) {
+                    benchConfig.blockSize = blockSizes[(block + 1) % 4];
+                }
+                else if (kDown & KEY_LEFT) {
+                    benchConfig.blockSize = blockSizes[(block + 3) % 4];
+                }
+
+                if (kDown & KEY_R) {
+                    benchConfig.queueDepth = benchConfig.queueDepth < DiskBench::maxQueueDepth? benchConfig.queueDepth + 1 : 1;
+                }
+                else if (kDown & KEY_L) {
+                    benchConfig.queueDepth = benchConfig.queueDepth > 1? benchConfig.queueDepth - 1 : DiskBench::maxQueueDepth;
+                }
+
+                if ((kDown & KEY_A) && DiskBench::Start(benchConfig)) {
+                    benchStarted = true;
+                }
+            }
+            else if ((active == TOOL_NAND_BENCHMARK) && !NandBench::IsRunning()) {
+                if (kDown & KEY_RIGHT) {
+                    nandChunk = (nandChunk + 1) % 4;
+                }
+                else if (kDown & KEY_LEFT) {
+                    nandChunk = (nandChunk + 3) % 4;
+                }
+
+                if ((kDown & KEY_A) && NandBench::Start(chunkSizes[nandChunk], nandBudget)) {
+                    nandStarted = true;
+                }
+            }
+            else if ((active == TOOL_TITLES) && !Titles::IsRunning()) {
+                u32 count = Titles::GetTable().count;
+
+                if ((kDown & KEY_A) && Titles::Start()) {
+                    titlesStarted = true;
+                    titleSort = TITLE_SORT_ID;
+                    titleScroll = 0;
+                }
+                else if (titlesStarted && (kDown & (KEY_LEFT | KEY_RIGHT))) {
+                    titleSort = static_cast<TitleSortKey>((titleSort + ((kDown & KEY_RIGHT)? 1 : TITLE_SORT_MAX - 1)) % TITLE_SORT_MAX);
+                    Titles::Sort(titleSort);
+                    titleScroll = 0;
+                }
+
+                if ((kDown & KEY_DOWN) && (titleScroll + 14 < count)) {
+                    titleScroll++;
+                }
+                else if ((kDown & KEY_UP) && (titleScroll > 0)) {
+                    titleScroll--;
+                }
+            }
+            else if (active == TOOL_DISK_USAGE) {
+                static u32 children[256];
+                u32 count = DiskUsage::GetChildren(duDirectory, children, 256);
+
+                if ((kDown & (KEY_LEFT | KEY_RIGHT)) && !DiskUsage::IsBusy()) {
+                    duArchive = static_cast<DiskUsageArchive>((duArchive + ((kDown & KEY_RIGHT)? 1 : DISK_USAGE_MAX - 1)) % DISK_USAGE_MAX);
+                    duStarted = false;
+                }
+
+                if ((kDown & KEY_A) && !duStarted) {
+                    duStarted = DiskUsage::Start(duArchive);
+                    duDirectory = duSelected = 0;
+                    duPaused = false;
+                }
+                else if ((kDown & KEY_A) && (duSelected < count)) {
+                    duDirectory = children[duSelected];
+                    duSelected = 0;
+                }
+                else if ((kDown & KEY_X) && (duDirectory != 0)) {
+                    duDirectory = DiskUsage::GetNode(duDirectory)->parent;
+                    duSelected = 0;
+                }
+                else if ((kDown & KEY_Y) && duStarted) {
+                    DiskUsage::Refresh(duDirectory);
+                    duPaused = false;
+                }
+                else if (kDown & KEY_R) {
+                    duPaused = !duPaused;
+                }
+
+                if ((kDown & KEY_DOWN) && (duSelected + 1 < count)) {
+                    duSelected++;
+                }
+                else if ((kDown & KEY_UP) && (duSelected > 0)) {
+                    duSelected--;
+                }
+
+                // A slice of the walk per frame, a quarter of the 60 Hz frame time.
+                if (DiskUsage::IsBusy() && !duPaused) {
+                    DiskUsage::Step(static_cast<u64>(4 * CPU_TICKS_PER_MSEC));
+                }
+            }
+            else if ((active == TOOL_TICKETS) && !Tickets::IsRunning()) {
+                if ((kDown & KEY_A) && Tickets::Start()) {
+                    ticketsStarted = true;
+                    ticketExportStatus = "";
+                }
+                else if ((kDown & KEY_Y) && ticketsStarted && R_SUCCEEDED(Tickets::GetResult())) {
+                    ticketExportStatus = R_SUCCEEDED(Tickets::Export("/3ds/3dsident_tickets.csv"))? "saved" : "failed";
+                }
+            }
+            else if ((active == TOOL_NETWORK) && !NetBench::IsRunning()) {
+                u32 buffer = 0;
+
+                while ((buffer < 3) && (netBufferSizes[buffer] != netConfig.bufferSize)) {
+                    buffer++;
+                }
+
+                if (kDown & KEY_RIGHT) {
+                    netConfig.bufferSize = netBufferSizes[(buffer + 1) % 4];
+                }
+                else if (kDown & KEY_LEFT) {
+                    netConfig.bufferSize = netBufferSizes[(buffer + 3) % 4];
+                }
+
+                if (kDown & KEY_X) {
+                    GUI::EditHost(netHost, sizeof(netHost), "Address of the machine running netserver");
+                }
+                else if ((kDown & KEY_A) && netHost[0] && NetBench::Start(netConfig)) {
+                    netStarted = true;
+                }
+            }
+            else if ((active == TOOL_HTTP_SERVER) && (kDown & KEY_A)) {
+                if (HttpServer::IsRunning()) {
+                    HttpServer::Stop();
+                }
+                else if (!(httpFailed = !HttpServer::Start(HttpServer::defaultPort))) {
+                    HttpServer::Publish(results, probeMask, displayInfo);
+                }
+            }
+            else if ((active == TOOL_TELEMETRY) && Telemetry::IsRunning() && (kDown & KEY_A)) {
+                Telemetry::Stop();
+            }
+            else if ((active == TOOL_TELEMETRY) && !Telemetry::IsRunning()) {
+                u32 period = 0;
+
+                while ((period < 3) && (telemetryPeriods[period] != telemetryConfig.period)) {
+                    period++;
+                }
+
+                if (kDown & KEY_RIGHT) {
+                    telemetryConfig.period = telemetryPeriods[(period + 1) % 4];
+                }
+                else if (kDown & KEY_LEFT) {
+                    telemetryConfig.period = telemetryPeriods[(period + 3) % 4];
+                }
+
+                if (kDown & KEY_X) {
+                    GUI::EditHost(telemetryHost, sizeof(telemetryHost), "Address of the machine running collector");
+                }
+                else if ((kDown & KEY_A) && telemetryHost[0]) {
+                    telemetryFailed = !Telemetry::Start(telemetryConfig);
+                }
+            }
         }
+
+        DiskBench::Stop();
+        NandBench::Stop();
+        Titles::Stop();
+        Tickets::Stop();
+        DiskUsage::Stop();
+        NetBench::Stop();
     }
 
     void MainMenu(void) {
         int selection = 0;
-        bool isNew3DS = Utils::IsNew3DS(), displayInfo = true, buttonTestEnabled = false;
+        bool isNew3DS = Utils::IsNew3DS(), displayInfo = true, buttonTestEnabled = false, toolsEnabled = false;
+        const char *exportStatus = "";
 
         const char *items[] = {
             "Kernel",
@@ -446,75 +1486,129 @@ namespace GUI {
             "Wi-Fi",
             "Storage",
             "Miscellaneous",
+            "Tools",
             "Exit"
         };
 
         float titleHeight = 0.f;
         GUI::GetTextDimensions(guiTexSize, nullptr, &titleHeight, "3DSident v0.0.0");
 
-        Service::Init();
-        KernelInfo kernelInfo = Service::GetKernelInfo();
-        SystemInfo systemInfo = Service::GetSystemInfo();
-        NNIDInfo nnidInfo = Service::GetNNIDInfo();
-        ConfigInfo configInfo = Service::GetConfigInfo();
-        HardwareInfo hardwareInfo = Service::GetHardwareInfo();
-        WifiInfo wifiInfo = Service::GetWifiInfo();
-        StorageInfo storageInfo = Service::GetStorageInfo();
-        MiscInfo miscInfo = Service::GetMiscInfo();
-        SystemStateInfo systemStateInfo = Service::GetSystemStateInfo();
-        Service::Exit();
+        // Probes run in the background, each page is filled in as soon as its data is published.
+        Probe::Start();
+        static ProbeResults results;
+        u32 probeMask = 0;
+
+        // Live values are polled by the sampler thread, the render loop only copies its latest snapshot. The sampler also
+        // feeds the battery recorder.
+        BatteryLog::Start(10);
+        Sampler::Start();
+        LiveInfo liveInfo = { 0 };
+
+        // Fed once per second from the sampler snapshot, the sampler polls both values at least that often.
+        static GraphSeries voltageGraph, wifiGraph;
+        Graph::Init(voltageGraph, 120, 5, 3.2f, 4.4f);
+        Graph::Init(wifiGraph, 370, 1, 0.f, 3.f);
+        u64 graphNextSample = 0;
+        u32 httpMask = 0;
+        bool httpDisplayInfo = displayInfo;
+        u64 frameTick = svcGetSystemTick();
 
         while (aptMainLoop()) {
-            GUI::Begin(guiBgcolour, guiBgcolour);
-
-            C2D_DrawRectSolid(0, 0, guiTexSize, 400, 20, guiStatusBarColour);
-            GUI::DrawTextf(5, (20 - titleHeight) / 2, guiTexSize, guiTitleColour, "3DSident v%d.%d.%d", VERSION_MAJOR, VERSION_MINOR, VERSION_MICRO);
-            GUI::DrawImage(banner, (400 - banner.subtex->width) / 2, ((82 - banner.subtex->height) / 2) + 20);
-
-            switch (selection) {
-                case KERNEL_INFO_PAGE:
-                    GUI::KernelInfoPage(kernelInfo, displayInfo);
-                    break;
-
-                case SYSTEM_INFO_PAGE:
-                    GUI::SystemInfoPage(systemInfo, displayInfo);
-                    break;
-
-                case BATTERY_INFO_PAGE:
-                    GUI::BatteryInfoPage(systemStateInfo);
-                    break;
-
-                case NNID_INFO_PAGE:
-                    GUI::NNIDInfoPage(nnidInfo, displayInfo);
-                    break;
-
-                case CONFIG_INFO_PAGE:
-                    GUI::ConfigInfoPage(configInfo, displayInfo);
-                    break;
+            TRACE_SCOPE("GUI::MainMenu frame");
+            u64 tick = svcGetSystemTick();
+            Telemetry::RecordFrame(tick - frameTick);
+            frameTick = tick;
+            Sampler::Read(liveInfo);
+            probeMask = Probe::Read(results);
+
+            // The HTTP server serializes on its own thread, publishing only copies the results.
+            if (HttpServer::IsRunning() && ((probeMask != httpMask) || (displayInfo != httpDisplayInfo))) {
+                HttpServer::Publish(results, probeMask, displayInfo);
+                httpMask = probeMask;
+                httpDisplayInfo = displayInfo;
+            }
 
-                case HARDWARE_INFO_PAGE:
-                    GUI::HardwareInfoPage(hardwareInfo, isNew3DS);
-                    break;
+            if (osGetTime() >= graphNextSample) {
+                graphNextSample = osGetTime() + 1000;
 
-                case WIFI_INFO_PAGE:
-                    GUI::WifiInfoPage(wifiInfo, displayInfo);
-                    break;
+                if (liveInfo.valid & BIT(SAMPLER_FIELD_BATTERY_VOLTAGE)) {
+                    Graph::Push(voltageGraph, 5.f * (static_cast<float>(liveInfo.batteryVoltage) / 256.f));
+                }
 
-                case STORAGE_INFO_PAGE:
-                    GUI::StorageInfoPage(storageInfo);
-                    break;
+                if (liveInfo.valid & BIT(SAMPLER_FIELD_WIFI_STRENGTH)) {
+                    Graph::Push(wifiGraph, liveInfo.wifiStrength);
+                }
 
-                case MISC_INFO_PAGE:
-                    GUI::MiscInfoPage(miscInfo, displayInfo);
-                    break;
+                if (HttpServer::IsRunning()) {
+                    HttpServer::PublishLive(liveInfo);
+                }
+            }
+            GUI::Begin(guiBgcolour, guiBgcolour);
 
-                case EXIT_PAGE:
-                    GUI::DrawItem(1, "Press select to hide user-specific info.", "");
-                    GUI::DrawItem(2, "Press L + R to use button tester.", "");
-                    break;
+            C2D_DrawRectSolid(0, 0, guiTexSize, 400, 20, guiStatusBarColour);
+            GUI::DrawTextf(5, (20 - titleHeight) / 2, guiTexSize, guiTitleColour, "3DSident v%d.%d.%d", VERSION_MAJOR, VERSION_MINOR, VERSION_MICRO);
+            GUI::DrawImage(banner, (400 - banner.subtex->width) / 2, ((82 - banner.subtex->height) / 2) + 20);
 
-                default:
-                    break;
+            if ((guiPageProbes[selection] != PROBE_MAX) && (!(probeMask & BIT(guiPageProbes[selection])))) {
+                GUI::DrawItem(1, "Loading...", "");
+            }
+            else {
+                switch (selection) {
+                    case KERNEL_INFO_PAGE:
+                        GUI::KernelInfoPage(results.kernelInfo, displayInfo);
+                        break;
+
+                    case SYSTEM_INFO_PAGE:
+                        GUI::SystemInfoPage(results.systemInfo, displayInfo);
+                        break;
+
+                    case BATTERY_INFO_PAGE:
+                        GUI::BatteryInfoPage(results.systemStateInfo, liveInfo, voltageGraph);
+                        break;
+
+                    case NNID_INFO_PAGE:
+                        GUI::NNIDInfoPage(results.nnidInfo, displayInfo);
+                        break;
+
+                    case CONFIG_INFO_PAGE:
+                        GUI::ConfigInfoPage(results.configInfo, displayInfo);
+                        break;
+
+                    case HARDWARE_INFO_PAGE:
+                        GUI::HardwareInfoPage(results.hardwareInfo, liveInfo, isNew3DS);
+                        break;
+
+                    case WIFI_INFO_PAGE:
+                        GUI::WifiInfoPage(results.wifiInfo, displayInfo);
+                        break;
+
+                    case STORAGE_INFO_PAGE:
+                        GUI::StorageInfoPage((liveInfo.valid & BIT(SAMPLER_FIELD_STORAGE))? liveInfo.storage : results.storageInfo);
+                        break;
+
+                    case MISC_INFO_PAGE:
+                        GUI::MiscInfoPage(results.miscInfo, liveInfo, wifiGraph, displayInfo);
+                        break;
+
+                    case TOOLS_PAGE:
+                        GUI::DrawItem(1, "Press A to open the tools.", "");
+                        GUI::DrawItem(2, "Benchmarks:", "SD read/write, read-only CTR and TWL NAND");
+                        GUI::DrawItem(3, "Title inventory:", "sizes and versions of installed titles");
+                        GUI::DrawItem(4, "Ticket check:", "orphan tickets, titles without one");
+                        GUI::DrawItem(5, "Disk usage:", "space used per directory on SD and NAND");
+                        GUI::DrawItem(6, "Network test:", "Wi-Fi throughput, round trip and loss");
+                        GUI::DrawItem(7, "Fleet collection:", "HTTP server, UDP telemetry push");
+                        break;
+
+                    case EXIT_PAGE:
+                        GUI::DrawItem(1, "Press select to hide user-specific info.", "");
+                        GUI::DrawItem(2, "Press L + R to use button tester.", "");
+                        GUI::DrawItem(3, "Press Y to export a report to /3ds/.", exportStatus);
+                        break;
+
+                    default:
+                        break;
+                }
             }
 
             C2D_SceneBegin(c3dRenderTarget[TARGET_BOTTOM]);
@@ -530,6 +1624,7 @@ namespace GUI {
             
             GUI::End();
             GUI::ButtonTester(buttonTestEnabled);
+            GUI::ToolsMenu(toolsEnabled, results, probeMask, displayInfo);
 
             hidScanInput();
             u32 kDown = hidKeysDown();
@@ -537,9 +1632,11 @@ namespace GUI {
 
             if (kDown & KEY_DOWN) {
                 selection++;
+                GUI::ClearText();
             }
             else if (kDown & KEY_UP) {
                 selection--;
+                GUI::ClearText();
             }
 
             if (selection > EXIT_PAGE) {
@@ -553,14 +1650,52 @@ namespace GUI {
                 displayInfo = !displayInfo;
             }
 
+            if ((kDown & KEY_X) && (selection == BATTERY_INFO_PAGE)) {
+                const u32 intervals[] = { 1, 10, 60, 300 };
+                u32 next = intervals[0];
+
+                for (u32 i = 0; i < 3; i++) {
+                    if (BatteryLog::GetInterval() == intervals[i]) {
+                        next = intervals[i + 1];
+                    }
+                }
+
+                BatteryLog::SetInterval(next);
+            }
+
+            if ((kDown & KEY_A) && (selection == TOOLS_PAGE)) {
+                toolsEnabled = true;
+                GUI::ClearText();
+            }
+
+            if ((kDown & KEY_Y) && (selection == EXIT_PAGE)) {
+                static ProbeResults report;
+                u32 reportMask = probeMask;
+                report = results;
+
+                if (liveInfo.valid & BIT(SAMPLER_FIELD_STORAGE)) {
+                    report.storageInfo = liveInfo.storage;
+                    reportMask |= BIT(PROBE_STORAGE_INFO);
+                }
+
+                exportStatus = R_SUCCEEDED(Export::Save(WRITER_BACKEND_FS, "/3ds/3dsident_report", report, reportMask, displayInfo))? "saved" : "failed";
+            }
+
             if (((kHeld & KEY_L) && (kDown & KEY_R)) || ((kHeld & KEY_R) && (kDown & KEY_L))) {
                 aptSetHomeAllowed(false);
                 buttonTestEnabled = true;
+                GUI::ClearText();
             }
 
             if ((kDown & KEY_START) || ((kDown & KEY_A) && (selection == EXIT_PAGE))) {
                 break;
             }
         }
+
+        HttpServer::Stop();
+        Telemetry::Stop();
+        Sampler::Stop();
+        BatteryLog::Stop();
+        Probe::Stop();
     }
 }
@@ -1,3 +1,4 @@
+#include "configstore.h"
 #include "hardware.h"
 #include "log.h"
 #include "utils.h"
@@ -6,12 +7,6 @@
 #define REG_LCD_BOTTOM_SCREEN (u32)0x202A00
 
 namespace Hardware {
-    struct AutoBrightnessBlock {
-        u32 unk1;
-        bool autoBrightnessEnabled;
-        u8 unk2[3];
-    };
-
     Result GetScreenType(gspLcdScreenType& top, gspLcdScreenType& bottom) {
         Result ret = 0;
         u8 vendors = 0;
@@ -108,20 +103,18 @@ namespace Hardware {
     }
 
     const char *GetSoundOutputMode(void) {
-        Result ret = 0;
-        u8 data;
+        SoundOutputModeBlock soundOutputModeBlock;
         const char *mode[] =  {
             "Mono",
             "Stereo",
             "Surround"
         };
         
-        if (R_FAILED(ret = CFGU_GetConfigInfoBlk2(sizeof(data), 0x00070001, std::addressof(data)))) {
-            Log::Error("%s failed: 0x%x\n", __func__, ret);
+        if ((!ConfigStore::Get(soundOutputModeBlock)) || (soundOutputModeBlock.mode > 2)) {
             return "unknown";
         }
 
-        return mode[data];
+        return mode[soundOutputModeBlock.mode];
     }
 
     u32 GetBrightness(u32 screen) {
@@ -145,7 +138,7 @@ namespace Hardware {
     const char *GetAutoBrightnessStatus(void) {
         AutoBrightnessBlock autoBrightnessBlock;
         
-        if (R_FAILED(CFG_GetConfigInfoBlk8(sizeof(AutoBrightnessBlock), 0x00050009, std::addressof(autoBrightnessBlock)))) {
+        if (!ConfigStore::Get(autoBrightnessBlock)) {
             return "unknown";
         }
         
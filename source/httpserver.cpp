@@ -0,0 +1,611 @@
+#include <3ds.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "export.h"
+#include "httpserver.h"
+#include "log.h"
+#include "net.h"
+
+// A small HTTP/1.1 server for fleet collection, one poll() loop over non-blocking sockets. The UI publishes copies of
+// its probe results and sampled values. Each document is serialized once per publish, into whichever of its two
+// slots no connection is sending from, and every request is answered straight from the current slot. Requests never
+// probe anything, and nothing a client does reaches the UI thread beyond the lock around those copies.
+
+namespace HttpServer {
+    typedef enum {
+        DOCUMENT_REPORT = 0,
+        DOCUMENT_LIVE,
+        DOCUMENT_MAX
+    } DocumentId;
+
+    typedef enum {
+        RESPONSE_BAD_REQUEST = 0,
+        RESPONSE_NOT_FOUND,
+        RESPONSE_METHOD_NOT_ALLOWED,
+        RESPONSE_TOO_LARGE,
+        RESPONSE_UNAVAILABLE,
+        RESPONSE_MAX
+    } ResponseId;
+
+    // A complete response, status line and headers included, at data + start.
+    typedef struct {
+        u8 *data;
+        u32 start;
+        u32 length;
+        u32 readers;        // Connections still sending from it
+    } Slot;
+
+    typedef struct {
+        const char *path;
+        u32 capacity;
+        Slot slots[2];
+        int current;        // Slot new requests are answered from, -1 until the first publish is serialized
+        u32 version;        // Publish the current slot holds
+    } Document;
+
+    typedef struct {
+        int fd;
+        bool sending;
+        bool keepAlive;
+        const u8 *response;
+        u32 responseLength;
+        u32 sent;
+        Slot *slot;
+        u64 lastActive;
+        u32 requestLength;
+        char request[1024];
+    } Connection;
+
+    // soc has room for few sockets, connections past this many wait in the listen backlog. While every connection is
+    // taken, keep-alive connections idle for httpBusyIdleTicks are closed to let the waiting ones in.
+    static const u32 httpMaxConnections = 12;
+    static const u32 httpHeaderSpace = 160;
+    static const u64 httpIdleTicks = 10ULL * SYSCLOCK_ARM11;
+    static const u64 httpBusyIdleTicks = SYSCLOCK_ARM11;
+    static const char *httpStatusLines[RESPONSE_MAX] = {
+        "400 Bad Request",
+        "404 Not Found",
+        "405 Method Not Allowed",
+        "431 Request Header Fields Too Large",
+        "503 Service Unavailable"
+    };
+
+    static Document httpDocuments[DOCUMENT_MAX] = {
+        { "/report.json", 32 * 1024, {}, -1, 0 },
+        { "/live", 2 * 1024, {}, -1, 0 }
+    };
+
+    static char httpResponses[RESPONSE_MAX][192];
+    static u32 httpResponseLengths[RESPONSE_MAX];
+    static Connection httpConnections[httpMaxConnections];
+    static u32 httpConnectionCount = 0;
+    static int httpListener = -1;
+    static HttpServerStats httpStats;
+    static FileWriter httpWriter;
+    static Thread httpThread = nullptr;
+    static std::atomic<bool> httpCancel;
+
+    // Shared with the publishing thread, under httpLock. Kept across Close() so a restarted server serves the last
+    // publish straight away.
+    static LightLock httpLock;
+    static bool httpLockReady = false;
+    static ProbeResults httpResults;
+    static u32 httpMask = 0;
+    static bool httpDisplayInfo = false;
+    static LiveInfo httpLive;
+    static u32 httpPublished[DOCUMENT_MAX];
+    static HttpServerStats httpSharedStats;
+
+    // Serializer inputs, copied out of the shared ones so the lock isn't held while writing.
+    static ProbeResults httpResultsCopy;
+    static LiveInfo httpLiveCopy;
+
+    static void InitLock(void) {
+        if (!httpLockReady) {
+            LightLock_Init(std::addressof(httpLock));
+            httpLockReady = true;
+        }
+    }
+
+    void Publish(const ProbeResults &results, u32 mask, bool displayInfo) {
+        HttpServer::InitLock();
+        LightLock_Lock(std::addressof(httpLock));
+        httpResults = results;
+        httpMask = mask;
+        httpDisplayInfo = displayInfo;
+        httpPublished[DOCUMENT_REPORT]++;
+        LightLock_Unlock(std::addressof(httpLock));
+    }
+
+    void PublishLive(const LiveInfo &info) {
+        HttpServer::InitLock();
+        LightLock_Lock(std::addressof(httpLock));
+        httpLive = info;
+        httpPublished[DOCUMENT_LIVE]++;
+        LightLock_Unlock(std::addressof(httpLock));
+    }
+
+    static void WriteLive(FileWriter &writer, const LiveInfo &info, u32 sequence) {
+        Writer::Printf(writer, "{\n  \"sequence\": %lu", sequence);
+
+        if (info.valid & BIT(SAMPLER_FIELD_BATTERY_PERCENTAGE)) {
+            Writer::Printf(writer, ",\n  \"batteryPercentage\": %u", info.batteryPercentage);
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_BATTERY_CHARGING)) {
+            Writer::Printf(writer, ",\n  \"batteryCharging\": %s", info.batteryCharging? "true" : "false");
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_BATTERY_VOLTAGE)) {
+            Writer::Printf(writer, ",\n  \"batteryVoltage\": %.3f", 5.f * (static_cast<float>(info.batteryVoltage) / 256.f));
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_BATTERY_TEMPERATURE)) {
+            Writer::Printf(writer, ",\n  \"batteryTemperature\": %u", info.batteryTemperature);
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_ADAPTER_STATE)) {
+            Writer::Printf(writer, ",\n  \"adapterConnected\": %s", info.adapterConnected? "true" : "false");
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_MCU_FIRMWARE)) {
+            Writer::Printf(writer, ",\n  \"mcuFirmware\": \"%u.%u\"", info.mcuFwVerHigh, info.mcuFwVerLow);
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_AUDIO_JACK)) {
+            Writer::Printf(writer, ",\n  \"audioJackInserted\": %s", info.audioJackInserted? "true" : "false");
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_CARD_SLOT)) {
+            Writer::Printf(writer, ",\n  \"cardSlotInserted\": %s", info.cardSlotInserted? "true" : "false");
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_SD_INSERTED)) {
+            Writer::Printf(writer, ",\n  \"sdInserted\": %s", info.sdInserted? "true" : "false");
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_BRIGHTNESS)) {
+            Writer::Printf(writer, ",\n  \"brightness\": %lu", info.brightness);
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_WIFI_STRENGTH)) {
+            Writer::Printf(writer, ",\n  \"wifiStrength\": %u", info.wifiStrength);
+        }
+
+        if (info.valid & BIT(SAMPLER_FIELD_HOSTNAME)) {
+            Writer::Printf(writer, ",\n  \"hostname\": ");
+            Export::WriteJsonString(writer, info.hostname, strnlen(info.hostname, sizeof(info.hostname)));
+        }
+
+        Writer::Printf(writer, "\n}\n");
+    }
+
+    // Serializes documents published since the last call. The body is written after httpHeaderSpace bytes and the
+    // headers right in front of it, so the response is one contiguous run for send().
+    static void Refresh(void) {
+        for (int i = 0; i < DOCUMENT_MAX; i++) {
+            Document &document = httpDocuments[i];
+            int index = document.current == 0? 1 : 0;
+            Slot &slot = document.slots[index];
+            u32 version = 0;
+
+            // Both slots are only busy while an older response is still draining, the next call catches up.
+            if (slot.readers) {
+                continue;
+            }
+
+            LightLock_Lock(std::addressof(httpLock));
+            version = httpPublished[i];
+
+            if (version != document.version) {
+                if (i == DOCUMENT_REPORT) {
+                    httpResultsCopy = httpResults;
+                }
+                else {
+                    httpLiveCopy = httpLive;
+                }
+            }
+
+            u32 mask = httpMask;
+            bool displayInfo = httpDisplayInfo;
+            LightLock_Unlock(std::addressof(httpLock));
+
+            if (version == document.version) {
+                continue;
+            }
+
+            Writer::OpenMemory(httpWriter, slot.data + httpHeaderSpace, document.capacity - httpHeaderSpace);
+
+            if (i == DOCUMENT_REPORT) {
+                Export::Write(httpWriter, EXPORT_FORMAT_JSON, httpResultsCopy, mask, displayInfo);
+            }
+            else {
+                HttpServer::WriteLive(httpWriter, httpLiveCopy, version);
+            }
+
+            document.version = version;
+
+            if (R_FAILED(Writer::Close(httpWriter))) {
+                continue;
+            }
+
+            char header[httpHeaderSpace];
+            u32 length = std::snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %lu\r\n"
+                "Cache-Control: no-store\r\n\r\n", static_cast<u32>(httpWriter.offset));
+
+            slot.start = httpHeaderSpace - length;
+            slot.length = length + static_cast<u32>(httpWriter.offset);
+            std::memcpy(slot.data + slot.start, header, length);
+            document.current = index;
+
+            if (i == DOCUMENT_REPORT) {
+                httpStats.reportVersion = version;
+            }
+            else {
+                httpStats.liveVersion = version;
+            }
+        }
+    }
+
+    static void Reply(Connection &connection, const u8 *response, u32 length, Slot *slot) {
+        connection.sending = true;
+        connection.response = response;
+        connection.responseLength = length;
+        connection.sent = 0;
+        connection.slot = slot;
+
+        if (slot) {
+            slot->readers++;
+        }
+    }
+
+    static void ReplyError(Connection &connection, ResponseId response) {
+        httpStats.errors++;
+        HttpServer::Reply(connection, reinterpret_cast<const u8 *>(httpResponses[response]), httpResponseLengths[response], nullptr);
+    }
+
+    // Answers the request in the first length bytes of the connection's buffer. Only GET of a published document
+    // succeeds. HTTP/1.1 connections stay open unless the client asks otherwise, HTTP/1.0 ones are closed.
+    static void Respond(Connection &connection, u32 length) {
+        char *request = connection.request;
+        char *line = static_cast<char *>(std::memchr(request, '\n', length));
+        char *path = request + 4, *end = path;
+
+        httpStats.requests++;
+
+        if (std::strncmp(request, "GET ", 4) != 0) {
+            connection.keepAlive = false;
+            HttpServer::ReplyError(connection, std::memchr(request, ' ', line - request)? RESPONSE_METHOD_NOT_ALLOWED : RESPONSE_BAD_REQUEST);
+            return;
+        }
+
+        while ((end < line) && (*end != ' ') && (*end != '?')) {
+            end++;
+        }
+
+        char *version = static_cast<char *>(std::memchr(end, ' ', line - end));
+        connection.keepAlive = version && (std::strncmp(version + 1, "HTTP/1.1", 8) == 0);
+
+        for (char *header = line + 1; header < request + length; header = static_cast<char *>(std::memchr(header, '\n', request + length - header)) + 1) {
+            if (strncasecmp(header, "Connection:", 11) != 0) {
+                continue;
+            }
+
+            char *value = header + 11;
+
+            while (*value == ' ') {
+                value++;
+            }
+
+            if (strncasecmp(value, "close", 5) == 0) {
+                connection.keepAlive = false;
+            }
+            else if (strncasecmp(value, "keep-alive", 10) == 0) {
+                connection.keepAlive = true;
+            }
+        }
+
+        for (int i = 0; i < DOCUMENT_MAX; i++) {
+            Document &document = httpDocuments[i];
+
+            if ((std::strlen(document.path) != static_cast<size_t>(end - path)) || (std::strncmp(document.path, path, end - path) != 0)) {
+                continue;
+            }
+
+            if (document.current < 0) {
+                HttpServer::ReplyError(connection, RESPONSE_UNAVAILABLE);
+                return;
+            }
+
+            Slot &slot = document.slots[document.current];
+            HttpServer::Reply(connection, slot.data + slot.start, slot.length, std::addressof(slot));
+            return;
+        }
+
+        HttpServer::ReplyError(connection, RESPONSE_NOT_FOUND);
+    }
+
+    // Offset just past the blank line ending the first request in the buffer, 0 if it isn't complete yet.
+    static u32 FindRequestEnd(const char *request, u32 length) {
+        for (u32 i = 3; i < length; i++) {
+            if ((request[i] == '\n') && (request[i - 1] == '\r') && (request[i - 2] == '\n') && (request[i - 3] == '\r')) {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    // Makes as much progress as the socket allows without blocking. Returns false once the connection should close.
+    static bool Service(Connection &connection, u64 now) {
+        while (true) {
+            if (connection.sending) {
+                ssize_t bytes = send(connection.fd, connection.response + connection.sent, connection.responseLength - connection.sent, Net::sendFlags);
+
+                if (bytes < 0) {
+                    return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+                }
+
+                connection.sent += bytes;
+                httpStats.bytes += bytes;
+                connection.lastActive = now;
+
+                if (connection.sent < connection.responseLength) {
+                    continue;
+                }
+
+                if (connection.slot) {
+                    connection.slot->readers--;
+                    connection.slot = nullptr;
+                }
+
+                connection.sending = false;
+
+                if (!connection.keepAlive) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            // Pipelined requests are answered in order from what is already buffered.
+            u32 end = HttpServer::FindRequestEnd(connection.request, connection.requestLength);
+
+            if (end) {
+                HttpServer::Respond(connection, end);
+                std::memmove(connection.request, connection.request + end, connection.requestLength - end);
+                connection.requestLength -= end;
+                continue;
+            }
+
+            if (connection.requestLength == sizeof(connection.request)) {
+                connection.keepAlive = false;
+                connection.requestLength = 0;
+                HttpServer::ReplyError(connection, RESPONSE_TOO_LARGE);
+                continue;
+            }
+
+            ssize_t bytes = recv(connection.fd, connection.request + connection.requestLength, sizeof(connection.request) - connection.requestLength, 0);
+
+            if (bytes > 0) {
+                connection.requestLength += bytes;
+                connection.lastActive = now;
+                continue;
+            }
+
+            return (bytes < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR));
+        }
+    }
+
+    static void CloseConnection(u32 index) {
+        Connection &connection = httpConnections[index];
+
+        if (connection.slot) {
+            connection.slot->readers--;
+        }
+
+        close(connection.fd);
+        httpConnections[index] = httpConnections[--httpConnectionCount];
+    }
+
+    static void Accept(u64 now) {
+        while (httpConnectionCount < httpMaxConnections) {
+            int fd = accept(httpListener, nullptr, nullptr);
+
+            if (fd < 0) {
+                break;
+            }
+
+            Connection &connection = httpConnections[httpConnectionCount++];
+            std::memset(std::addressof(connection), 0, offsetof(Connection, request));
+            connection.fd = fd;
+            connection.lastActive = now;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            httpStats.accepted++;
+        }
+    }
+
+    Result Open(u16 port) {
+        struct sockaddr_in address;
+        int reuse = 1;
+
+        HttpServer::InitLock();
+        std::memset(std::addressof(address), 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+        if ((httpListener = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+            Log::Error("%s(socket) failed: %d\n", __func__, errno);
+            return -errno;
+        }
+
+        setsockopt(httpListener, SOL_SOCKET, SO_REUSEADDR, std::addressof(reuse), sizeof(reuse));
+
+        if ((bind(httpListener, reinterpret_cast<struct sockaddr *>(std::addressof(address)), sizeof(address)) != 0) || (listen(httpListener, 8) != 0)) {
+            Result ret = -errno;
+            Log::Error("%s(bind) failed: %d\n", __func__, -ret);
+            close(httpListener);
+            httpListener = -1;
+            return ret;
+        }
+
+        fcntl(httpListener, F_SETFL, fcntl(httpListener, F_GETFL, 0) | O_NONBLOCK);
+
+        for (int i = 0; i < DOCUMENT_MAX; i++) {
+            Document &document = httpDocuments[i];
+            document.current = -1;
+            document.version = 0;
+
+            for (int j = 0; j < 2; j++) {
+                std::memset(std::addressof(document.slots[j]), 0, sizeof(Slot));
+                document.slots[j].data = new u8[document.capacity];
+            }
+        }
+
+        for (int i = 0; i < RESPONSE_MAX; i++) {
+            httpResponseLengths[i] = std::snprintf(httpResponses[i], sizeof(httpResponses[i]), "HTTP/1.1 %s\r\nContent-Type: text/plain\r\n"
+                "Content-Length: %u\r\n\r\n%s\n", httpStatusLines[i], static_cast<unsigned>(std::strlen(httpStatusLines[i]) + 1), httpStatusLines[i]);
+        }
+
+        std::memset(std::addressof(httpStats), 0, sizeof(httpStats));
+        httpConnectionCount = 0;
+        return 0;
+    }
+
+    // One round of the loop: serializes new publishes, waits up to timeout milliseconds for socket activity and
+    // services what is ready. Idle connections are closed.
+    void Poll(int timeout) {
+        struct pollfd fds[1 + httpMaxConnections];
+
+        HttpServer::Refresh();
+
+        fds[0].fd = httpListener;
+        fds[0].events = httpConnectionCount < httpMaxConnections? POLLIN : 0;
+        fds[0].revents = 0;
+
+        for (u32 i = 0; i < httpConnectionCount; i++) {
+            fds[1 + i].fd = httpConnections[i].fd;
+            fds[1 + i].events = httpConnections[i].sending? POLLOUT : POLLIN;
+            fds[1 + i].revents = 0;
+        }
+
+        if ((poll(fds, 1 + httpConnectionCount, timeout) < 0) && (errno != EINTR)) {
+            Log::Error("%s(poll) failed: %d\n", __func__, errno);
+            return;
+        }
+
+        u64 now = svcGetSystemTick();
+        u64 idle = httpConnectionCount < httpMaxConnections? httpIdleTicks : httpBusyIdleTicks;
+
+        // Back to front, a closed connection is replaced by the last one, which has already been seen.
+        for (u32 i = httpConnectionCount; i-- > 0;) {
+            Connection &connection = httpConnections[i];
+            bool open = fds[1 + i].revents? HttpServer::Service(connection, now) : (now - connection.lastActive < idle);
+
+            if (!open) {
+                HttpServer::CloseConnection(i);
+            }
+        }
+
+        if (fds[0].revents) {
+            HttpServer::Accept(now);
+        }
+
+        httpStats.connections = httpConnectionCount;
+        LightLock_Lock(std::addressof(httpLock));
+        httpSharedStats = httpStats;
+        LightLock_Unlock(std::addressof(httpLock));
+    }
+
+    void Close(void) {
+        while (httpConnectionCount > 0) {
+            HttpServer::CloseConnection(httpConnectionCount - 1);
+        }
+
+        if (httpListener >= 0) {
+            close(httpListener);
+            httpListener = -1;
+        }
+
+        for (int i = 0; i < DOCUMENT_MAX; i++) {
+            for (int j = 0; j < 2; j++) {
+                delete[] httpDocuments[i].slots[j].data;
+                httpDocuments[i].slots[j].data = nullptr;
+            }
+
+            httpDocuments[i].current = -1;
+        }
+
+        LightLock_Lock(std::addressof(httpLock));
+        httpSharedStats.connections = 0;
+        LightLock_Unlock(std::addressof(httpLock));
+    }
+
+    static void Worker(void *arg) {
+        while (!httpCancel.load(std::memory_order_relaxed)) {
+            HttpServer::Poll(100);
+        }
+    }
+
+    // Binds on the calling thread so a port in use is reported here, then serves on a thread below its priority.
+    bool Start(u16 port) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        HttpServer::Stop();
+
+        if (R_FAILED(HttpServer::Open(port))) {
+            return false;
+        }
+
+        httpCancel.store(false, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(httpThread = threadCreate(HttpServer::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            HttpServer::Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Returns within one poll timeout, open connections are closed.
+    void Stop(void) {
+        if (!httpThread) {
+            return;
+        }
+
+        httpCancel.store(true, std::memory_order_relaxed);
+        threadJoin(httpThread, U64_MAX);
+        threadFree(httpThread);
+        httpThread = nullptr;
+        HttpServer::Close();
+    }
+
+    bool IsRunning(void) {
+        return httpThread != nullptr;
+    }
+
+    void GetStats(HttpServerStats &stats) {
+        HttpServer::InitLock();
+        LightLock_Lock(std::addressof(httpLock));
+        stats = httpSharedStats;
+        LightLock_Unlock(std::addressof(httpLock));
+    }
+}
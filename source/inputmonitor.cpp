@@ -0,0 +1,350 @@
+#include <3ds.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "inputmonitor.h"
+#include "log.h"
+#include "writer.h"
+
+// HID shared memory, pad section (u32 words): [0..1] tick of the latest update, [2..3] tick of the one before,
+// [4] index of the latest entry, then 8 entries of 4 words from word 10: held, pressed, released, circle pad.
+// IRRST (C-stick, New 3DS and Circle Pad Pro) uses the same header with its entries from word 6. The touch section
+// starts at word 42 with the same header, its 8 entries of 2 words from word 50 are the position and a valid bit.
+
+namespace InputMonitor {
+    static const u64 monitorPollInterval = 1000000ULL; // 1 ms, HID updates roughly every 4 ms
+    static const u32 monitorDeadZone = 15;
+    static const u32 monitorTraceCapacity = 4096;
+    static const u32 monitorTouchCapacity = 32768;
+
+    static InputTiming timing;
+    static LightLock timingLock;
+    static std::atomic<bool> stopRequested;
+    static std::atomic<u64> pressTick;
+    static std::atomic<u32> pressKeys;
+    static Thread thread;
+
+    static StickInfo padStats, stickStats;
+    static circlePosition stickLatest;
+    static StickTraceSample stickTrace[monitorTraceCapacity];
+    static u32 stickTraceCount = 0;
+    static TouchSample touchSamples[monitorTouchCapacity];
+    static u32 touchCount = 0;
+    static LightLock sampleLock;
+
+    // Reads the latest entry of a section, retrying if HID rewrites it in the middle of the read.
+    static bool ReadSection(vu32 *section, u32 first, u32 words, u64 &tick, u64 &previous, u32 &index, u32 &value) {
+        for (int i = 0; i < 4; i++) {
+            u32 low = section[0], high = section[1];
+            previous = (static_cast<u64>(section[3]) << 32) | section[2];
+            index = section[4] & 7;
+            value = section[first + (index * words)];
+
+            if ((section[0] == low) && (section[1] == high)) {
+                tick = (static_cast<u64>(high) << 32) | low;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Appends the touch entries written since the last poll, a lifted pen is stored once as a marker.
+    static void RecordTouch(u32 index, u32 count, bool &penDown) {
+        LightLock_Lock(std::addressof(sampleLock));
+
+        for (u32 i = count; (i > 0) && (touchCount < monitorTouchCapacity); i--) {
+            u32 entry = (index + 8 - (i - 1)) & 7;
+            u32 position = hidSharedMem[42 + 8 + (entry * 2)];
+            bool valid = hidSharedMem[42 + 8 + (entry * 2) + 1] & 1;
+
+            if (valid) {
+                touchSamples[touchCount++] = { static_cast<u16>(position & 0xFFFF), static_cast<u16>(position >> 16) };
+            }
+            else if (penDown) {
+                touchSamples[touchCount++] = { touchPenUp, touchPenUp };
+            }
+
+            penDown = valid;
+        }
+
+        LightLock_Unlock(std::addressof(sampleLock));
+    }
+
+    static circlePosition ReadCircle(vu32 *section, u32 first, u32 index) {
+        u32 value = section[first + (index * 4) + 3];
+        return { static_cast<s16>(value & 0xFFFF), static_cast<s16>(value >> 16) };
+    }
+
+    // The C-stick entries IRRST wrote since the last poll. It updates on its own schedule, so its statistics count
+    // its own entries rather than the pad's.
+    static void RecordCstick(u32 index, u32 count) {
+        LightLock_Lock(std::addressof(sampleLock));
+
+        for (u32 i = count; i > 0; i--) {
+            stickLatest = InputMonitor::ReadCircle(irrstSharedMem, 6, (index + 8 - (i - 1)) & 7);
+            StickStats::Add(stickStats, stickLatest.dx, stickLatest.dy);
+        }
+
+        LightLock_Unlock(std::addressof(sampleLock));
+    }
+
+    // Every pad entry HID wrote since the last poll, with the latest C-stick position. Entries older than the latest
+    // are stamped one update interval (the two header ticks apart) earlier each.
+    static void RecordSticks(u64 tick, u64 previous, u32 index, u32 count) {
+        u64 interval = tick > previous? tick - previous : 0;
+        LightLock_Lock(std::addressof(sampleLock));
+
+        for (u32 i = count; i > 0; i--) {
+            circlePosition pad = InputMonitor::ReadCircle(hidSharedMem, 10, (index + 8 - (i - 1)) & 7);
+            StickStats::Add(padStats, pad.dx, pad.dy);
+            stickTrace[stickTraceCount % monitorTraceCapacity] = { tick - ((i - 1) * interval), pad.dx, pad.dy, stickLatest.dx, stickLatest.dy };
+            stickTraceCount++;
+        }
+
+        LightLock_Unlock(std::addressof(sampleLock));
+    }
+
+    static void Record(u64 tick, u64 now, u32 skipped) {
+        LightLock_Lock(std::addressof(timingLock));
+
+        if (timing.updates == 0) {
+            timing.firstTick = tick;
+        }
+        else {
+            // Welford's running mean and variance of the update interval.
+            double interval = static_cast<double>(tick - timing.lastTick);
+            double delta = interval - timing.intervalMean;
+            timing.intervalMean += delta / static_cast<double>(timing.updates);
+            timing.intervalM2 += delta * (interval - timing.intervalMean);
+
+            u32 bucket = static_cast<u32>(interval / (CPU_TICKS_PER_MSEC / 4.0));
+            timing.intervalHistogram[bucket < 63? bucket : 63]++;
+        }
+
+        timing.updates++;
+        timing.missed += skipped;
+        timing.lastTick = tick;
+        timing.delayTotal += now > tick? now - tick : 0;
+        LightLock_Unlock(std::addressof(timingLock));
+    }
+
+    static void Worker(void *arg) {
+        u64 lastTick = 0, lastTouchTick = 0, lastStickTick = 0;
+        u32 lastIndex = 0, lastHeld = 0, lastTouchIndex = 0, lastStickIndex = 0;
+        bool first = true, firstTouch = true, firstStick = true, penDown = false;
+
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            u64 tick = 0, previous = 0;
+            u32 index = 0, held = 0, stickIndex = 0, stick = 0;
+
+            if (irrstSharedMem && InputMonitor::ReadSection(irrstSharedMem, 6, 4, tick, previous, stickIndex, stick) && (tick != lastStickTick)) {
+                u32 advanced = (stickIndex + 8 - lastStickIndex) & 7;
+                InputMonitor::RecordCstick(stickIndex, firstStick? 1 : (advanced? advanced : 1));
+
+                firstStick = false;
+                lastStickTick = tick;
+                lastStickIndex = stickIndex;
+            }
+
+            if (InputMonitor::ReadSection(hidSharedMem, 10, 4, tick, previous, index, held) && (tick != lastTick)) {
+                u64 now = svcGetSystemTick();
+
+                if (!first) {
+                    u32 advanced = (index + 8 - lastIndex) & 7;
+                    InputMonitor::Record(tick, now, advanced > 1? advanced - 1 : 0);
+                    InputMonitor::RecordSticks(tick, previous, index, advanced? advanced : 1);
+
+                    // Newly pressed buttons, the render loop measures how long until a frame showing them is submitted.
+                    u32 pressed = held & ~lastHeld;
+                    if (pressed) {
+                        pressKeys.store(0, std::memory_order_relaxed);
+                        pressTick.store(tick, std::memory_order_relaxed);
+                        pressKeys.store(pressed, std::memory_order_release);
+                    }
+                }
+
+                first = false;
+                lastTick = tick;
+                lastIndex = index;
+                lastHeld = held;
+            }
+
+            u32 touchIndex = 0, position = 0;
+
+            if (InputMonitor::ReadSection(hidSharedMem + 42, 8, 2, tick, previous, touchIndex, position) && (tick != lastTouchTick)) {
+                u32 advanced = (touchIndex + 8 - lastTouchIndex) & 7;
+                InputMonitor::RecordTouch(touchIndex, firstTouch? 1 : (advanced? advanced : 1), penDown);
+
+                firstTouch = false;
+                lastTouchTick = tick;
+                lastTouchIndex = touchIndex;
+            }
+
+            svcSleepThread(monitorPollInterval);
+        }
+    }
+
+    // Runs above the render loop so updates are timestamped as soon as they land, it sleeps between polls.
+    void Start(void) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        if (thread) {
+            return;
+        }
+
+        LightLock_Init(std::addressof(timingLock));
+        LightLock_Init(std::addressof(sampleLock));
+        InputMonitor::Reset();
+        stopRequested.store(false, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        thread = threadCreate(InputMonitor::Worker, nullptr, 0x2000, priority > 0x18? priority - 1 : priority, -2, false);
+
+        if (!thread) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+        }
+    }
+
+    void Stop(void) {
+        if (!thread) {
+            return;
+        }
+
+        stopRequested.store(true, std::memory_order_relaxed);
+        threadJoin(thread, U64_MAX);
+        threadFree(thread);
+        thread = nullptr;
+    }
+
+    void Reset(void) {
+        LightLock_Lock(std::addressof(timingLock));
+        std::memset(std::addressof(timing), 0, sizeof(InputTiming));
+        LightLock_Unlock(std::addressof(timingLock));
+        pressKeys.store(0, std::memory_order_relaxed);
+
+        LightLock_Lock(std::addressof(sampleLock));
+        StickStats::Init(padStats, monitorDeadZone);
+        StickStats::Init(stickStats, monitorDeadZone);
+        stickLatest = { 0, 0 };
+        stickTraceCount = 0;
+        touchCount = 0;
+        LightLock_Unlock(std::addressof(sampleLock));
+    }
+
+    void GetTiming(InputTiming &out) {
+        LightLock_Lock(std::addressof(timingLock));
+        out = timing;
+        LightLock_Unlock(std::addressof(timingLock));
+    }
+
+    // Hands the HID timestamp of the latest press to the render loop, once, if keys contains it.
+    bool TakePress(u32 keys, u64 &tick) {
+        u32 pressed = pressKeys.load(std::memory_order_acquire);
+
+        if (!(pressed & keys) || !pressKeys.compare_exchange_strong(pressed, 0, std::memory_order_relaxed)) {
+            return false;
+        }
+
+        tick = pressTick.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    void RecordLatency(u64 ticks) {
+        LightLock_Lock(std::addressof(timingLock));
+        u32 bucket = static_cast<u32>(static_cast<double>(ticks) / CPU_TICKS_PER_MSEC);
+        timing.latencyHistogram[bucket < 63? bucket : 63]++;
+        timing.latencies++;
+        timing.latencyTotal += ticks;
+        timing.latencyMax = ticks > timing.latencyMax? ticks : timing.latencyMax;
+        LightLock_Unlock(std::addressof(timingLock));
+    }
+
+    Result Export(const char *path) {
+        static FileWriter writer;
+        InputTiming copy;
+        Result ret = 0;
+
+        InputMonitor::GetTiming(copy);
+
+        if (R_FAILED(ret = Writer::Open(writer, WRITER_BACKEND_FS, path))) {
+            return ret;
+        }
+
+        double seconds = copy.updates > 1? static_cast<double>(copy.lastTick - copy.firstTick) / SYSCLOCK_ARM11 : 0.0;
+        double variance = copy.updates > 2? copy.intervalM2 / static_cast<double>(copy.updates - 2) : 0.0;
+
+        Writer::Printf(writer, "# updates %lu, missed %lu, rate %.2f Hz, interval %.3f ms, jitter %.3f ms, delay %.3f ms\n",
+            copy.updates, copy.missed, seconds > 0.0? (copy.updates - 1) / seconds : 0.0, copy.intervalMean / CPU_TICKS_PER_MSEC,
+            std::sqrt(variance) / CPU_TICKS_PER_MSEC, copy.updates? (copy.delayTotal / copy.updates) / CPU_TICKS_PER_MSEC : 0.0);
+        Writer::Printf(writer, "# latencies %lu, mean %.3f ms, max %.3f ms\n", copy.latencies,
+            copy.latencies? (copy.latencyTotal / copy.latencies) / CPU_TICKS_PER_MSEC : 0.0, copy.latencyMax / CPU_TICKS_PER_MSEC);
+        Writer::Printf(writer, "histogram,bucket_ms,count\n");
+
+        for (u32 i = 0; i < 64; i++) {
+            Writer::Printf(writer, "interval,%.2f,%lu\n", i * 0.25, copy.intervalHistogram[i]);
+        }
+
+        for (u32 i = 0; i < 64; i++) {
+            Writer::Printf(writer, "latency,%lu,%lu\n", i, copy.latencyHistogram[i]);
+        }
+
+        return Writer::Close(writer);
+    }
+
+    void GetSticks(StickInfo &pad, StickInfo &stick) {
+        LightLock_Lock(std::addressof(sampleLock));
+        pad = padStats;
+        stick = stickStats;
+        LightLock_Unlock(std::addressof(sampleLock));
+    }
+
+    bool HasCstick(void) {
+        return irrstSharedMem != nullptr;
+    }
+
+    // Writes the trace ring, oldest sample first.
+    Result ExportSticks(const char *path) {
+        static FileWriter writer;
+        static StickTraceSample copy[monitorTraceCapacity];
+        Result ret = 0;
+
+        LightLock_Lock(std::addressof(sampleLock));
+        u32 count = stickTraceCount < monitorTraceCapacity? stickTraceCount : monitorTraceCapacity;
+        u32 first = stickTraceCount - count;
+
+        for (u32 i = 0; i < count; i++) {
+            copy[i] = stickTrace[(first + i) % monitorTraceCapacity];
+        }
+
+        LightLock_Unlock(std::addressof(sampleLock));
+
+        if (R_FAILED(ret = Writer::Open(writer, WRITER_BACKEND_FS, path))) {
+            return ret;
+        }
+
+        Writer::Printf(writer, "tick,pad_x,pad_y,cstick_x,cstick_y\n");
+
+        for (u32 i = 0; i < count; i++) {
+            Writer::Printf(writer, "%llu,%d,%d,%d,%d\n", static_cast<unsigned long long>(copy[i].tick), copy[i].padX, copy[i].padY, copy[i].stickX, copy[i].stickY);
+        }
+
+        return Writer::Close(writer);
+    }
+
+    // Copies captured touch samples starting at from, returns how many were copied. Capture stops once the buffer is
+    // full, until the next Reset.
+    u32 ReadTouch(u32 from, TouchSample *samples, u32 max) {
+        LightLock_Lock(std::addressof(sampleLock));
+        u32 count = from < touchCount? touchCount - from : 0;
+        count = count < max? count : max;
+        std::memcpy(samples, touchSamples + from, count * sizeof(TouchSample));
+        LightLock_Unlock(std::addressof(sampleLock));
+        return count;
+    }
+}
@@ -0,0 +1,219 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstring>
+
+#include "ipcstats.h"
+
+#if defined BUILD_TRACE
+// Every IPC request, including the ones libctru sends, goes through svcSendSyncRequest. Profiling builds link with
+// -Wl,--wrap=svcSendSyncRequest so each call is counted and timed by session and command ID.
+extern "C" Result __real_svcSendSyncRequest(Handle session);
+
+namespace IPCStats {
+    typedef struct {
+        const char *name;
+        Handle *session;
+    } Source;
+
+    typedef struct {
+        u16 command;
+        u8 source;
+        bool used;
+        u32 count;
+        u64 totalTicks;
+        u64 maxTicks;
+        u32 buckets[32]; // buckets[i] counts calls that took [2^i, 2^(i+1)) ticks
+    } Entry;
+
+    static const u8 ipcOtherSource = 0xFF;
+    static Source ipcSources[16];
+    static u32 ipcSourceCount = 0, ipcDropped = 0;
+    static Entry ipcEntries[128];
+    static LightLock ipcLock;
+    static Handle ipcCfgSession, ipcDspSession, ipcHidSession;
+    static Handle *ipcLearning = nullptr;
+
+    static u8 GetSource(Handle session) {
+        for (u32 i = 0; i < ipcSourceCount; i++) {
+            if (*ipcSources[i].session == session) {
+                return i;
+            }
+        }
+
+        return ipcOtherSource;
+    }
+
+    static void Record(Handle session, u16 command, u64 ticks) {
+        LightLock_Lock(std::addressof(ipcLock));
+
+        if (ipcLearning) {
+            *ipcLearning = session;
+        }
+
+        u8 source = IPCStats::GetSource(session);
+        u32 capacity = sizeof(ipcEntries) / sizeof(ipcEntries[0]);
+        u32 index = ((source * 31) + command) % capacity;
+        Entry *entry = nullptr;
+
+        // Open addressing, the table only ever holds a few dozen service/command pairs.
+        for (u32 i = 0; i < capacity; i++, index = (index + 1) % capacity) {
+            if (!ipcEntries[index].used || ((ipcEntries[index].source == source) && (ipcEntries[index].command == command))) {
+                entry = std::addressof(ipcEntries[index]);
+                break;
+            }
+        }
+
+        if (!entry) {
+            ipcDropped++;
+            LightLock_Unlock(std::addressof(ipcLock));
+            return;
+        }
+
+        entry->used = true;
+        entry->source = source;
+        entry->command = command;
+        entry->count++;
+        entry->totalTicks += ticks;
+
+        if (ticks > entry->maxTicks) {
+            entry->maxTicks = ticks;
+        }
+
+        u32 bucket = ticks? 63 - __builtin_clzll(ticks) : 0;
+        entry->buckets[bucket < 31? bucket : 31]++;
+        LightLock_Unlock(std::addressof(ipcLock));
+    }
+
+    void Register(const char *name, Handle *session) {
+        LightLock_Lock(std::addressof(ipcLock));
+
+        for (u32 i = 0; i < ipcSourceCount; i++) {
+            if (ipcSources[i].session == session) {
+                LightLock_Unlock(std::addressof(ipcLock));
+                return;
+            }
+        }
+
+        if (ipcSourceCount < (sizeof(ipcSources) / sizeof(ipcSources[0]))) {
+            ipcSources[ipcSourceCount].name = name;
+            ipcSources[ipcSourceCount].session = session;
+            ipcSourceCount++;
+        }
+
+        LightLock_Unlock(std::addressof(ipcLock));
+    }
+
+    // Some services don't expose their session handle, so issue one cheap request and note the session it went to.
+    template<typename F> static void Learn(const char *name, Handle *session, F &&request) {
+        ipcLearning = session;
+        request();
+        ipcLearning = nullptr;
+
+        if (*session) {
+            IPCStats::Register(name, session);
+        }
+    }
+
+    void Init(void) {
+        LightLock_Init(std::addressof(ipcLock));
+        IPCStats::Register("fs", fsGetSessionHandle());
+        IPCStats::Register("ac", acGetSessionHandle());
+        IPCStats::Register("am", amGetSessionHandle());
+        IPCStats::Register("ptm", ptmuGetSessionHandle());
+#if !defined BUILD_CITRA
+        IPCStats::Register("mcu::HWC", mcuHwcGetSessionHandle());
+#endif
+
+        IPCStats::Learn("cfg", std::addressof(ipcCfgSession), []() {
+            u8 model = 0;
+            CFGU_GetSystemModel(std::addressof(model));
+        });
+
+        IPCStats::Learn("dsp", std::addressof(ipcDspSession), []() {
+            bool status = false;
+            DSP_GetHeadphoneStatus(std::addressof(status));
+        });
+
+        IPCStats::Learn("hid", std::addressof(ipcHidSession), []() {
+            u8 volume = 0;
+            HIDUSER_GetSoundVolume(std::addressof(volume));
+        });
+    }
+
+    static double GetMicroseconds(u64 ticks) {
+        return static_cast<double>(ticks) / CPU_TICKS_PER_USEC;
+    }
+
+    // Upper bound of the bucket the given percentile falls in.
+    static double GetPercentile(const Entry &entry, u32 percentile) {
+        u64 target = ((static_cast<u64>(entry.count) * percentile) + 99) / 100, seen = 0;
+
+        for (int i = 0; i < 32; i++) {
+            seen += entry.buckets[i];
+
+            if (seen >= target) {
+                return IPCStats::GetMicroseconds(2ULL << i);
+            }
+        }
+
+        return IPCStats::GetMicroseconds(entry.maxTicks);
+    }
+
+    // Writing to the file sends FS requests of its own, which Record() counts under ipcLock. The table is copied
+    // out first and the lock is not held while formatting or writing.
+    bool Dump(const char *path) {
+        static Entry entries[sizeof(ipcEntries) / sizeof(ipcEntries[0])];
+        static Source sources[sizeof(ipcSources) / sizeof(ipcSources[0])];
+
+        LightLock_Lock(std::addressof(ipcLock));
+        std::memcpy(entries, ipcEntries, sizeof(entries));
+        std::memcpy(sources, ipcSources, sizeof(sources));
+        u32 dropped = ipcDropped;
+        LightLock_Unlock(std::addressof(ipcLock));
+
+        std::FILE *file = std::fopen(path, "w");
+        if (!file) {
+            return false;
+        }
+
+        std::fputs("service,command,count,total_us,mean_us,max_us,p50_us,p90_us,p99_us", file);
+
+        for (int i = 0; i < 32; i++) {
+            std::fprintf(file, ",lt_%.3f_us", IPCStats::GetMicroseconds(2ULL << i));
+        }
+
+        std::fputs("\n", file);
+
+        for (const Entry &entry : entries) {
+            if (!entry.used) {
+                continue;
+            }
+
+            std::fprintf(file, "%s,0x%04X,%lu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f", (entry.source == ipcOtherSource)? "other" : sources[entry.source].name,
+                entry.command, entry.count, IPCStats::GetMicroseconds(entry.totalTicks), IPCStats::GetMicroseconds(entry.totalTicks) / entry.count,
+                IPCStats::GetMicroseconds(entry.maxTicks), IPCStats::GetPercentile(entry, 50), IPCStats::GetPercentile(entry, 90),
+                IPCStats::GetPercentile(entry, 99));
+
+            for (int i = 0; i < 32; i++) {
+                std::fprintf(file, ",%lu", entry.buckets[i]);
+            }
+
+            std::fputs("\n", file);
+        }
+
+        if (dropped) {
+            std::fprintf(file, "dropped,,%lu\n", dropped);
+        }
+
+        return std::fclose(file) == 0;
+    }
+}
+
+extern "C" Result __wrap_svcSendSyncRequest(Handle session) {
+    u16 command = getThreadCommandBuffer()[0] >> 16;
+    u64 start = svcGetSystemTick();
+    Result ret = __real_svcSendSyncRequest(session);
+    IPCStats::Record(session, command, svcGetSystemTick() - start);
+    return ret;
+}
+#endif
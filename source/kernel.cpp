@@ -1,68 +1,34 @@
 #include <3ds.h>
 #include <cstring>
 
-#include "fs.h"
 #include "kernel.h"
 #include "log.h"
+#include "logscanner.h"
 #include "system.h"
-#include "utils.h"
+#include "trace.h"
 
 namespace Kernel {
     const char *GetInitalVersion(void) {
-        Result ret = 0;
-        
-        FS_Archive archive;
-        if (R_FAILED(ret = FS::OpenArchive(std::addressof(archive), ARCHIVE_NAND_TWL_FS))) {
-            Log::Error("%s(FS::OpenArchive) failed: 0x%x\n", __func__, ret);
-            return "unknown";
-        }
-        
-        Handle handle;
-        if (R_FAILED(ret = FSUSER_OpenFileDirectly(&handle, ARCHIVE_NAND_TWL_FS, fsMakePath(PATH_EMPTY, ""), fsMakePath(PATH_ASCII, "/sys/log/product.log"), FS_OPEN_READ, 0))) {
-            Log::Error("%s(FSUSER_OpenFileDirectly) failed: 0x%x\n", __func__, ret);
-            return "unknown";
-        }
-
-        u64 size = 0;
-        if (R_FAILED(ret = FSFILE_GetSize(handle, std::addressof(size)))) {
-            Log::Error("%s(FSFILE_GetSize) failed: 0x%x\n", __func__, ret);
-            return "unknown";
-        }
+        TRACE_SCOPE("Kernel::GetInitalVersion");
 
-        char *buf = new char[size + 1];
-        u32 bytesRead = 0;
-        
-        if (R_FAILED(ret = FSFILE_Read(handle, std::addressof(bytesRead), 0, reinterpret_cast<u32 *>(buf), static_cast<u32>(size)))) {
-            Log::Error("%s(FSFILE_Read) failed: 0x%x\n", __func__, ret);
-            delete[] buf;
-            return "unknown";
-        }
-        
-        buf[size] = '\0';
-        
         // New 3DS/2DS only
-        static char version[11];
-        std::strcpy(version, Utils::GetSubstring(buf, "cup:", " preInstall:").c_str());
-        
-        if (std::strlen(version) == 0) {
-            std::strcpy(version, Utils::GetSubstring(buf, "cup:", ",").c_str());
-        }
-        
-        std::strcat(version, "-");
-        std::strcat(version, Utils::GetSubstring(buf, "nup:", " cup:").c_str());
+        LogScanner::Field fields[] = {
+            { "cup:", { " preInstall:", "," } },
+            { "nup:", { " cup:", nullptr } }
+        };
 
-        if (R_FAILED(ret = FSFILE_Close(handle))) {
-            Log::Error("%s(FSFILE_Close) failed: 0x%x\n", __func__, ret);
-            delete[] buf;
+        if (R_FAILED(LogScanner::ScanFile(ARCHIVE_NAND_TWL_FS, "/sys/log/product.log", fields, 2))) {
             return "unknown";
         }
 
-        delete[] buf;
-        FS::CloseArchive(archive);
+        static char version[32];
+        const char *cup = LogScanner::GetValue(fields[0]), *nup = LogScanner::GetValue(fields[1]);
+        std::snprintf(version, sizeof(version), "%s-%s", cup? cup : "", nup? nup : "");
         return version;
     }
 
     const char *GetVersion(VersionInfo info) {
+        TRACE_SCOPE("Kernel::GetVersion");
         Result ret = 0;
         u32 osVersion = osGetKernelVersion();
         
@@ -101,6 +67,7 @@ namespace Kernel {
     }
 
     const char *GetSdmcCid(void) {
+        TRACE_SCOPE("Kernel::GetSdmcCid");
         Result ret = 0;
         u8 buf[16];
         
@@ -119,6 +86,7 @@ namespace Kernel {
     }
 
     const char *GetNandCid(void) {
+        TRACE_SCOPE("Kernel::GetNandCid");
         Result ret = 0;
         u8 buf[16];
         
@@ -137,6 +105,7 @@ namespace Kernel {
     }
 
     u32 GetDeviceId(void) {
+        TRACE_SCOPE("Kernel::GetDeviceId");
         Result ret = 0;
         u32 id = 0;
 
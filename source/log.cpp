@@ -1,71 +1,300 @@
-#include <cstdarg>
-#include <string>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 
 #include "fs.h"
 #include "log.h"
 
 namespace Log {
+    typedef struct {
+        u64 tick;
+        std::atomic<u32> sequence;
+        u8 level;
+        u8 reserved;
+        u16 length;
+        char text[112];
+    } Slot;
+
+    // Bounded MPSC queue: producers claim a slot by advancing logHead, each slot's sequence tells whether it is free
+    // for the producer at that position or holds a record for the consumer. Must be a power of two.
+    static const u32 logCapacity = 256;
+    static Slot logSlots[logCapacity];
+    static std::atomic<u32> logHead, logTail;
+    static std::atomic<u32> logDropped[LOG_LEVEL_MAX];
+    static u32 logReported[LOG_LEVEL_MAX];
+    static std::atomic<int> logLevel = LOG_LEVEL_INFO;
+    static std::atomic<bool> logOpen, logStop;
+
+    static const char *logLevelNames[LOG_LEVEL_MAX] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+    static const char *logPath = "/3ds/3dsident.log";
+    static const s64 logDrainInterval = 100000000LL;
+
     static FS_Archive sdmcArchive;
     static Handle handle = 0;
     static u64 offset = 0;
+    static LogFormat logFormat = LOG_FORMAT_TEXT;
+    static u64 logBaseTick = 0;
+    static Thread thread;
+    static LightEvent wakeEvent;
+
+    // Only touched by the drain thread, or by Close once it has been joined.
+    static u8 logBatch[0x2000];
+    static u32 logBatchLength = 0;
+
+    static void Flush(void) {
+        if (!logBatchLength) {
+            return;
+        }
+
+        u32 bytesWritten = 0;
+        if (R_SUCCEEDED(FSFILE_Write(handle, std::addressof(bytesWritten), offset, logBatch, logBatchLength, 0))) {
+            offset += bytesWritten;
+        }
+
+        logBatchLength = 0;
+    }
+
+    static void Append(const void *data, u32 size) {
+        if (logBatchLength + size > sizeof(logBatch)) {
+            Log::Flush();
+        }
+
+        std::memcpy(logBatch + logBatchLength, data, size);
+        logBatchLength += size;
+    }
+
+    static void Emit(u64 tick, u8 level, const char *text, u16 length) {
+        if (logFormat == LOG_FORMAT_BINARY) {
+            LogRecordHeader header = { tick, level, 0, length };
+            Log::Append(std::addressof(header), sizeof(header));
+            Log::Append(text, length);
+            return;
+        }
+
+        char line[160];
+        bool newline = (length == 0) || (text[length - 1] != '\n');
+        int size = std::snprintf(line, sizeof(line), "[%11.6f] [%-5s] %.*s%s", static_cast<double>(tick - logBaseTick) / SYSCLOCK_ARM11,
+            logLevelNames[level], static_cast<int>(length), text, newline? "\n" : "");
+
+        if (size > 0) {
+            size = size < static_cast<int>(sizeof(line))? size : static_cast<int>(sizeof(line)) - 1;
+            std::fwrite(line, 1, size, stdout);
+            Log::Append(line, size);
+        }
+    }
+
+    static void Drain(void) {
+        u32 tail = logTail.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot &slot = logSlots[tail & (logCapacity - 1)];
 
-    Result Open(void) {
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                break;
+            }
+
+            Log::Emit(slot.tick, slot.level, slot.text, slot.length);
+            slot.sequence.store(tail + logCapacity, std::memory_order_release);
+            logTail.store(++tail, std::memory_order_relaxed);
+        }
+
+        for (int level = 0; level < LOG_LEVEL_MAX; level++) {
+            u32 dropped = logDropped[level].load(std::memory_order_relaxed);
+
+            if (dropped != logReported[level]) {
+                char text[64];
+                int length = std::snprintf(text, sizeof(text), "%lu %s records dropped, log queue full\n",
+                    static_cast<unsigned long>(dropped - logReported[level]), logLevelNames[level]);
+                Log::Emit(svcGetSystemTick(), LOG_LEVEL_WARN, text, static_cast<u16>(length));
+                logReported[level] = dropped;
+            }
+        }
+
+        Log::Flush();
+    }
+
+    static void Worker(void *arg) {
+        while (!logStop.load(std::memory_order_acquire)) {
+            LightEvent_WaitTimeout(std::addressof(wakeEvent), logDrainInterval);
+            Log::Drain();
+        }
+    }
+
+    Result Open(LogFormat format) {
         Result ret = 0;
-        const char *path = "/3ds/3dsident.log";
-        
+
+        if (logOpen.load(std::memory_order_acquire)) {
+            return 0;
+        }
+
         FS::OpenArchive(std::addressof(sdmcArchive), ARCHIVE_SDMC);
 
         // Delete existing logs on start up.
-        if (FS::FileExists(sdmcArchive, path)) {
-            FSUSER_DeleteFile(sdmcArchive, fsMakePath(PATH_ASCII, path));
+        if (FS::FileExists(sdmcArchive, logPath)) {
+            FSUSER_DeleteFile(sdmcArchive, fsMakePath(PATH_ASCII, logPath));
         }
 
-        if (!FS::FileExists(sdmcArchive, path)) {
-            if (R_FAILED(ret = FSUSER_CreateFile(sdmcArchive, fsMakePath(PATH_ASCII, path), 0, 0))) {
+        if (!FS::FileExists(sdmcArchive, logPath)) {
+            if (R_FAILED(ret = FSUSER_CreateFile(sdmcArchive, fsMakePath(PATH_ASCII, logPath), 0, 0))) {
+                FS::CloseArchive(sdmcArchive);
                 return ret;
             }
         }
-        
-        if (R_FAILED(ret = FSUSER_OpenFile(&handle, sdmcArchive, fsMakePath(PATH_ASCII, path), FS_OPEN_WRITE, 0))) {
+
+        if (R_FAILED(ret = FSUSER_OpenFile(std::addressof(handle), sdmcArchive, fsMakePath(PATH_ASCII, logPath), FS_OPEN_WRITE, 0))) {
+            FS::CloseArchive(sdmcArchive);
             return ret;
         }
-            
+
+        logFormat = format;
+        logBaseTick = svcGetSystemTick();
+        offset = 0;
+        logBatchLength = 0;
+        logHead.store(0, std::memory_order_relaxed);
+        logTail.store(0, std::memory_order_relaxed);
+
+        for (u32 i = 0; i < logCapacity; i++) {
+            logSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        for (int level = 0; level < LOG_LEVEL_MAX; level++) {
+            logDropped[level].store(0, std::memory_order_relaxed);
+            logReported[level] = 0;
+        }
+
+        if (format == LOG_FORMAT_BINARY) {
+            LogFileHeader header = { { '3', 'D', 'S', 'L' }, 1, 0, SYSCLOCK_ARM11, 0, logBaseTick };
+            Log::Append(std::addressof(header), sizeof(header));
+        }
+
+        s32 priority = 0;
+        svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE);
+
+        LightEvent_Init(std::addressof(wakeEvent), RESET_ONESHOT);
+        logStop.store(false, std::memory_order_relaxed);
+        thread = threadCreate(Log::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false);
+
+        if (thread == nullptr) {
+            FSFILE_Close(handle);
+            handle = 0;
+            FS::CloseArchive(sdmcArchive);
+            return -1;
+        }
+
+        logOpen.store(true, std::memory_order_release);
         return 0;
     }
-    
+
     Result Close(void) {
         Result ret = 0;
-        
+
+        if (!logOpen.exchange(false, std::memory_order_acq_rel)) {
+            return 0;
+        }
+
+        logStop.store(true, std::memory_order_release);
+        LightEvent_Signal(std::addressof(wakeEvent));
+        threadJoin(thread, U64_MAX);
+        threadFree(thread);
+        thread = nullptr;
+
+        // Records queued after the worker's last pass.
+        Log::Drain();
+
         if (R_FAILED(ret = FSFILE_Close(handle))) {
             return ret;
         }
 
+        handle = 0;
         FS::CloseArchive(sdmcArchive);
         return 0;
     }
 
-    void Error(const char *data, ...) {
-        // File handle was not open for writing
-        if (!handle) {
+    void SetLevel(LogLevel level) {
+        logLevel.store(level, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled(LogLevel level) {
+        return logOpen.load(std::memory_order_relaxed) && (level >= logLevel.load(std::memory_order_relaxed));
+    }
+
+    void WriteV(LogLevel level, const char *format, va_list args) {
+        // Checked before formatting, so disabled levels cost one load.
+        if (!Log::IsEnabled(level)) {
             return;
         }
 
-        char buf[256];
+        u32 pos = logHead.load(std::memory_order_relaxed);
+        Slot *slot = nullptr;
+
+        while (true) {
+            slot = std::addressof(logSlots[pos & (logCapacity - 1)]);
+            s32 diff = static_cast<s32>(slot->sequence.load(std::memory_order_acquire) - pos);
+
+            if (diff == 0) {
+                if (logHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                // Full, never block the caller.
+                logDropped[level].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else {
+                pos = logHead.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->tick = svcGetSystemTick();
+        slot->level = level;
+
+        int length = std::vsnprintf(slot->text, sizeof(slot->text), format, args);
+        slot->length = length < 0? 0 : (length < static_cast<int>(sizeof(slot->text))? length : sizeof(slot->text) - 1);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // Wake the worker early once, when the queue crosses half full.
+        if (pos - logTail.load(std::memory_order_relaxed) == logCapacity / 2) {
+            LightEvent_Signal(std::addressof(wakeEvent));
+        }
+    }
+
+    void Write(LogLevel level, const char *format, ...) {
         va_list args;
-        va_start(args, data);
-        std::vsnprintf(buf, sizeof(buf), data, args);
+        va_start(args, format);
+        Log::WriteV(level, format, args);
         va_end(args);
-        
-        std::string error_string = "[ERROR] ";
-        error_string.append(buf);
-        
-        std::printf("%s", error_string.c_str());
-
-        u32 bytes_written = 0;
-        if (R_FAILED(FSFILE_Write(handle, &bytes_written, offset, error_string.data(), error_string.length(), FS_WRITE_FLUSH))) {
-            return;
-        }
-            
-        offset += bytes_written;
+    }
+
+    void Debug(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        Log::WriteV(LOG_LEVEL_DEBUG, format, args);
+        va_end(args);
+    }
+
+    void Info(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        Log::WriteV(LOG_LEVEL_INFO, format, args);
+        va_end(args);
+    }
+
+    void Warn(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        Log::WriteV(LOG_LEVEL_WARN, format, args);
+        va_end(args);
+    }
+
+    void Error(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        Log::WriteV(LOG_LEVEL_ERROR, format, args);
+        va_end(args);
+    }
+
+    u32 GetDropped(LogLevel level) {
+        return logDropped[level].load(std::memory_order_relaxed);
     }
 }
@@ -0,0 +1,155 @@
+#include <3ds.h>
+#include <cstring>
+#include <memory>
+
+#include "log.h"
+#include "logscanner.h"
+
+namespace LogScanner {
+    // Match state after feeding c to a pattern that already matched its first `matched` chars. On a mismatch the
+    // match falls back to the longest border of what was matched, so overlapping partial matches aren't missed.
+    static u32 Advance(const char *pattern, u32 matched, char c) {
+        while (true) {
+            if (pattern[matched] == c) {
+                return matched + 1;
+            }
+
+            if (matched == 0) {
+                return 0;
+            }
+
+            u32 border = matched - 1;
+            while ((border > 0) && (std::strncmp(pattern, pattern + matched - border, border) != 0)) {
+                border--;
+            }
+
+            matched = border;
+        }
+    }
+
+    void Reset(Field *fields, u32 count) {
+        for (u32 i = 0; i < count; i++) {
+            fields[i].value[0] = '\0';
+            fields[i].keyLength = std::strlen(fields[i].key);
+            fields[i].terminatorLength[0] = fields[i].terminators[0]? std::strlen(fields[i].terminators[0]) : 0;
+            fields[i].terminatorLength[1] = fields[i].terminators[1]? std::strlen(fields[i].terminators[1]) : 0;
+            fields[i].keyMatched = 0;
+            fields[i].consumed = 0;
+            fields[i].terminatorMatched[0] = fields[i].terminatorMatched[1] = 0;
+            fields[i].length[0] = fields[i].length[1] = -1;
+            fields[i].done = false;
+        }
+    }
+
+    static void FeedField(Field &field, char c) {
+        if (field.keyMatched < field.keyLength) {
+            field.keyMatched = LogScanner::Advance(field.key, field.keyMatched, c);
+            return;
+        }
+
+        // Terminator chars are captured as well, they are cut off once the terminator is known.
+        if (field.consumed < sizeof(field.value)) {
+            field.value[field.consumed] = c;
+        }
+
+        field.consumed++;
+        bool pending = false;
+
+        for (int i = 0; i < 2; i++) {
+            const char *terminator = field.terminators[i];
+
+            if ((!terminator) || (field.length[i] >= 0)) {
+                continue;
+            }
+
+            u32 terminatorLength = field.terminatorLength[i];
+            field.terminatorMatched[i] = LogScanner::Advance(terminator, field.terminatorMatched[i], c);
+
+            if (field.terminatorMatched[i] == terminatorLength) {
+                field.length[i] = field.consumed - terminatorLength;
+            }
+            else if (field.consumed < sizeof(field.value) + terminatorLength) {
+                pending = true;
+            }
+        }
+
+        // Values longer than the buffer can't be stored anyway, stop once no terminator can still fit.
+        field.done = (field.length[0] >= 0) || (!pending);
+    }
+
+    // Feeds the next chunk of a log, returns true once every field is resolved and the rest can be skipped.
+    bool Feed(Field *fields, u32 count, const char *data, u32 size) {
+        bool done = true;
+
+        for (u32 i = 0; i < count; i++) {
+            Field &field = fields[i];
+
+            for (u32 j = 0; (j < size) && (!field.done); j++) {
+                // Nothing matched yet, so skip straight to the next char that could start the key.
+                if (field.keyMatched == 0) {
+                    const char *next = static_cast<const char *>(std::memchr(data + j, field.key[0], size - j));
+
+                    if (!next) {
+                        break;
+                    }
+
+                    j = next - data;
+                }
+
+                LogScanner::FeedField(field, data[j]);
+            }
+
+            done &= field.done;
+        }
+
+        return done;
+    }
+
+    const char *GetValue(Field &field) {
+        for (int i = 0; i < 2; i++) {
+            if ((field.length[i] >= 0) && (field.length[i] < static_cast<s32>(sizeof(field.value)))) {
+                field.value[field.length[i]] = '\0';
+                return field.value;
+            }
+        }
+
+        return nullptr;
+    }
+
+    Result ScanFile(FS_ArchiveID archiveId, const char *path, Field *fields, u32 count) {
+        Result ret = 0;
+        Handle handle;
+
+        LogScanner::Reset(fields, count);
+
+        if (R_FAILED(ret = FSUSER_OpenFileDirectly(std::addressof(handle), archiveId, fsMakePath(PATH_EMPTY, ""), fsMakePath(PATH_ASCII, path), FS_OPEN_READ, 0))) {
+            Log::Error("%s(FSUSER_OpenFileDirectly) failed: 0x%x\n", __func__, ret);
+            return ret;
+        }
+
+        char buf[0x1000];
+        u64 offset = 0;
+        u32 bytesRead = 0;
+
+        // Fixed size chunks, the scan stops early once every field is resolved.
+        while (true) {
+            if (R_FAILED(ret = FSFILE_Read(handle, std::addressof(bytesRead), offset, buf, sizeof(buf)))) {
+                Log::Error("%s(FSFILE_Read) failed: 0x%x\n", __func__, ret);
+                break;
+            }
+
+            if ((bytesRead == 0) || (LogScanner::Feed(fields, count, buf, bytesRead)) || (bytesRead < sizeof(buf))) {
+                break;
+            }
+
+            offset += bytesRead;
+        }
+
+        Result closeRet = 0;
+        if (R_FAILED(closeRet = FSFILE_Close(handle))) {
+            Log::Error("%s(FSFILE_Close) failed: 0x%x\n", __func__, closeRet);
+        }
+
+        return ret;
+    }
+}
@@ -1,8 +1,20 @@
 #include "gui.h"
+#include "ipcstats.h"
+#include "trace.h"
 
 int main(int argc, char* argv[]) {
+#if defined BUILD_TRACE
+	Trace::Init();
+#endif
 	GUI::Init();
+#if defined BUILD_TRACE
+	IPCStats::Init();
+#endif
 	GUI::MainMenu();
 	GUI::Exit();
+#if defined BUILD_TRACE
+	Trace::Dump("sdmc:/3ds/3dsident_trace.json");
+	IPCStats::Dump("sdmc:/3ds/3dsident_ipc.csv");
+#endif
 	return 0;
 }
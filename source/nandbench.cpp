@@ -0,0 +1,217 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <malloc.h>
+
+#include "fs.h"
+#include "log.h"
+#include "nandbench.h"
+#include "utils.h"
+
+// Strictly read-only: archives are only walked with FSUSER_OpenDirectory and files opened with FS_OPEN_READ, nothing
+// is ever created, written or deleted on NAND. Files are streamed in the order the walk finds them (title contents,
+// databases, logs) until the per-archive budget is read.
+
+namespace NandBench {
+    static const FS_ArchiveID nandArchiveIds[NAND_BENCH_MAX] = { ARCHIVE_NAND_CTR_FS, ARCHIVE_NAND_TWL_FS };
+    static const char *nandArchiveNames[NAND_BENCH_MAX] = { "CTR NAND", "TWL NAND" };
+    static const u32 nandMaxDirectories = 64;
+    static const u32 nandMaxReads = 8192;
+
+    static Thread nandThread = nullptr;
+    static NandBenchResult nandResults[NAND_BENCH_MAX];
+    static std::atomic<bool> nandRunning, nandCancel;
+    static std::atomic<u64> nandRead;
+    static u32 nandChunkSize = 0, nandBudget = 0;
+    static u8 *nandBuffer = nullptr;
+    static u32 nandLatencies[nandMaxReads];
+    static char nandDirectories[nandMaxDirectories][256];
+
+    static void ReadFile(FS_Archive archive, const char *path, u64 size, u64 &remaining, u32 &count, NandBenchResult &result) {
+        Result ret = 0;
+        Handle handle;
+
+        if (R_FAILED(ret = FSUSER_OpenFile(std::addressof(handle), archive, fsMakePath(PATH_ASCII, path), FS_OPEN_READ, 0))) {
+            result.errors++;
+            return;
+        }
+
+        result.files++;
+
+        for (u64 offset = 0; (offset < size) && (remaining > 0) && !nandCancel.load(std::memory_order_relaxed);) {
+            u32 chunk = static_cast<u32>(std::min<u64>(std::min<u64>(nandChunkSize, size - offset), remaining));
+            u32 bytesRead = 0;
+
+            u64 start = svcGetSystemTick();
+            ret = FSFILE_Read(handle, std::addressof(bytesRead), offset, nandBuffer, chunk);
+            u64 ticks = svcGetSystemTick() - start;
+
+            if (R_FAILED(ret) || (bytesRead == 0)) {
+                result.errors++;
+                break;
+            }
+
+            u32 latency = static_cast<u32>(ticks / CPU_TICKS_PER_USEC);
+            u32 bucket = latency > 1? static_cast<u32>(4.f * std::log2(static_cast<float>(latency))) : 0;
+            result.histogram[bucket < 63? bucket : 63]++;
+
+            if (count < nandMaxReads) {
+                nandLatencies[count++] = latency;
+            }
+
+            result.reads++;
+            result.bytes += bytesRead;
+            result.ticks += ticks;
+            offset += bytesRead;
+            remaining -= bytesRead;
+            nandRead.fetch_add(bytesRead, std::memory_order_relaxed);
+        }
+
+        FSFILE_Close(handle);
+    }
+
+    // Breadth first, so the shallow system files are read before the walk descends into the title tree.
+    static void RunArchive(NandBenchArchive id, NandBenchResult &result) {
+        Result ret = 0;
+        FS_Archive archive;
+        u64 remaining = nandBudget;
+        u32 head = 0, tail = 0, count = 0;
+
+        if (R_FAILED(ret = FS::OpenArchive(std::addressof(archive), nandArchiveIds[id]))) {
+            Log::Error("%s(FS::OpenArchive) failed: 0x%x\n", __func__, ret);
+            result.result = ret;
+            return;
+        }
+
+        std::strcpy(nandDirectories[tail++], "/");
+
+        while ((head < tail) && (remaining > 0) && !nandCancel.load(std::memory_order_relaxed)) {
+            const char *directory = nandDirectories[head++ % nandMaxDirectories];
+            Handle handle;
+
+            if (R_FAILED(ret = FSUSER_OpenDirectory(std::addressof(handle), archive, fsMakePath(PATH_ASCII, directory)))) {
+                result.errors++;
+                continue;
+            }
+
+            // Copied, the queue slot may be reused by a subdirectory found below.
+            char parent[256];
+            std::snprintf(parent, sizeof(parent), "%s", directory);
+
+            FS_DirectoryEntry entry;
+            u32 entries = 0;
+
+            while (R_SUCCEEDED(FSDIR_Read(handle, std::addressof(entries), 1, std::addressof(entry))) && (entries == 1) && (remaining > 0)) {
+                char name[256], path[256];
+                Utils::UTF16ToUTF8(reinterpret_cast<u8 *>(name), entry.name, sizeof(name) - 1);
+
+                if (std::snprintf(path, sizeof(path), "%s%s%s", parent, parent[1]? "/" : "", name) >= static_cast<int>(sizeof(path))) {
+                    continue;
+                }
+
+                if (entry.attributes & FS_ATTRIBUTE_DIRECTORY) {
+                    if (tail - head < nandMaxDirectories) {
+                        std::strcpy(nandDirectories[tail++ % nandMaxDirectories], path);
+                    }
+                }
+                else if (entry.fileSize) {
+                    NandBench::ReadFile(archive, path, entry.fileSize, remaining, count, result);
+                }
+
+                if (nandCancel.load(std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            FSDIR_Close(handle);
+        }
+
+        FS::CloseArchive(archive);
+
+        if ((result.reads == 0) || (result.ticks == 0)) {
+            return;
+        }
+
+        result.mbPerSecond = static_cast<float>((result.bytes / (static_cast<double>(result.ticks) / SYSCLOCK_ARM11)) / (1024.0 * 1024.0));
+
+        std::sort(nandLatencies, nandLatencies + count);
+        result.latency50 = nandLatencies[(count * 50) / 100];
+        result.latency90 = nandLatencies[(count * 90) / 100];
+        result.latency99 = nandLatencies[(count * 99) / 100];
+        result.latencyMax = nandLatencies[count - 1];
+    }
+
+    static void Worker(void *arg) {
+        for (int i = 0; (i < NAND_BENCH_MAX) && !nandCancel.load(std::memory_order_relaxed); i++) {
+            NandBench::RunArchive(static_cast<NandBenchArchive>(i), nandResults[i]);
+        }
+
+        nandRunning.store(false, std::memory_order_release);
+    }
+
+    // Reads up to budget bytes from each archive in chunkSize reads, on a thread below the caller's priority.
+    bool Start(u32 chunkSize, u32 budget) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        NandBench::Stop();
+
+        if (!(nandBuffer = static_cast<u8 *>(memalign(0x1000, chunkSize)))) {
+            Log::Error("%s(memalign) failed\n", __func__);
+            return false;
+        }
+
+        std::memset(nandResults, 0, sizeof(nandResults));
+        nandChunkSize = chunkSize;
+        nandBudget = budget;
+        nandRead.store(0, std::memory_order_relaxed);
+        nandCancel.store(false, std::memory_order_relaxed);
+        nandRunning.store(true, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(nandThread = threadCreate(NandBench::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            nandRunning.store(false, std::memory_order_relaxed);
+            free(nandBuffer);
+            nandBuffer = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    void Stop(void) {
+        if (nandThread) {
+            nandCancel.store(true, std::memory_order_relaxed);
+            threadJoin(nandThread, U64_MAX);
+            threadFree(nandThread);
+            nandThread = nullptr;
+        }
+
+        free(nandBuffer);
+        nandBuffer = nullptr;
+    }
+
+    bool IsRunning(void) {
+        return nandRunning.load(std::memory_order_acquire);
+    }
+
+    float GetProgress(void) {
+        return nandBudget? static_cast<float>(nandRead.load(std::memory_order_relaxed)) / static_cast<float>(nandBudget * NAND_BENCH_MAX) : 0.f;
+    }
+
+    // Only valid once IsRunning() returns false.
+    void GetResults(NandBenchResult *results) {
+        std::memcpy(results, nandResults, sizeof(nandResults));
+    }
+
+    const char *GetArchiveName(NandBenchArchive archive) {
+        return archive < NAND_BENCH_MAX? nandArchiveNames[archive] : "";
+    }
+}
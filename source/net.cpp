@@ -0,0 +1,35 @@
+#include <3ds.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+
+#include "log.h"
+#include "net.h"
+
+namespace Net {
+    // Dotted IPv4 or a host name, 0 or minus an errno.
+    Result Resolve(const char *host, u16 port, struct sockaddr_in &address) {
+        std::memset(std::addressof(address), 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+
+        if ((!host) || (host[0] == '\0')) {
+            return -EDESTADDRREQ;
+        }
+
+        if (inet_pton(AF_INET, host, std::addressof(address.sin_addr)) == 1) {
+            return 0;
+        }
+
+        struct hostent *entry = gethostbyname(host);
+
+        if ((!entry) || (entry->h_addrtype != AF_INET) || (!entry->h_addr_list[0])) {
+            Log::Error("%s(gethostbyname) failed: %s\n", __func__, host);
+            return -EHOSTUNREACH;
+        }
+
+        std::memcpy(std::addressof(address.sin_addr), entry->h_addr_list[0], sizeof(address.sin_addr));
+        return 0;
+    }
+}
@@ -0,0 +1,404 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "net.h"
+#include "netbench.h"
+
+// Sockets are non-blocking and every wait is a poll() of at most netPollSlice, so a run that has lost its server
+// notices Stop() within a slice instead of sitting in a blocking call. One buffer is allocated per run and every
+// send() and recv() of the TCP tests goes straight through it.
+
+namespace NetBench {
+    static const int netPollSlice = 50;
+    static const char *netTestNames[NET_TEST_MAX] = { "TCP upload", "TCP download", "UDP ping" };
+
+    static Thread netThread = nullptr;
+    static NetBenchConfig netConfig;
+    static NetBenchResult netResults[NET_TEST_MAX];
+    static char netHost[64];
+    static std::atomic<bool> netRunning, netCancel;
+    static std::atomic<u32> netTest, netDone, netTotal;
+
+    static u64 Deadline(u32 milliseconds) {
+        return svcGetSystemTick() + static_cast<u64>(milliseconds * CPU_TICKS_PER_MSEC);
+    }
+
+    // Waits for events on fd until the deadline. Readiness includes errors, the send() or recv() that follows
+    // reports those.
+    static Result Wait(int fd, short events, u64 deadline) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = events;
+
+        while (!netCancel.load(std::memory_order_relaxed)) {
+            pfd.revents = 0;
+            int ret = poll(std::addressof(pfd), 1, netPollSlice);
+
+            if (ret > 0) {
+                return 0;
+            }
+            else if ((ret < 0) && (errno != EINTR)) {
+                return -errno;
+            }
+            else if (svcGetSystemTick() >= deadline) {
+                return -ETIMEDOUT;
+            }
+        }
+
+        return -ECANCELED;
+    }
+
+    static int OpenSocket(int type) {
+        int fd = socket(AF_INET, type, 0);
+
+        if (fd < 0) {
+            Log::Error("%s(socket) failed: %d\n", __func__, errno);
+            return -1;
+        }
+
+        if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+            Log::Error("%s(fcntl) failed: %d\n", __func__, errno);
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    static Result Connect(int fd, const struct sockaddr_in &address, u32 timeout) {
+        Result ret = 0;
+        int error = 0;
+        socklen_t length = sizeof(error);
+
+        if (connect(fd, reinterpret_cast<const struct sockaddr *>(std::addressof(address)), sizeof(address)) == 0) {
+            return 0;
+        }
+
+        if ((errno != EINPROGRESS) && (errno != EWOULDBLOCK)) {
+            return -errno;
+        }
+
+        if (R_FAILED(ret = NetBench::Wait(fd, POLLOUT, NetBench::Deadline(timeout)))) {
+            return ret;
+        }
+
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, std::addressof(error), std::addressof(length)) != 0) {
+            return -errno;
+        }
+
+        return -error;
+    }
+
+    // Moves size bytes through buffer, send() or recv() as large as bufferSize allows. Each call that made progress
+    // moves the deadline, only a stall of timeout milliseconds fails the transfer. Bulk transfers report progress.
+    static Result Transfer(int fd, bool send, u8 *buffer, u32 bufferSize, u64 size, u32 timeout, u64 &moved, bool bulk) {
+        u64 deadline = NetBench::Deadline(timeout);
+        Result ret = 0;
+
+        while (moved < size) {
+            u32 chunk = static_cast<u32>(std::min<u64>(bufferSize, size - moved));
+            ssize_t bytes = send? ::send(fd, buffer, chunk, Net::sendFlags) : recv(fd, buffer, chunk, 0);
+
+            if (bytes > 0) {
+                moved += bytes;
+
+                if (bulk) {
+                    netDone.store(static_cast<u32>(moved >> 10), std::memory_order_relaxed);
+                }
+
+                deadline = NetBench::Deadline(timeout);
+                continue;
+            }
+            else if (bytes == 0) {
+                return -ECONNRESET;
+            }
+            else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                return -errno;
+            }
+
+            if (R_FAILED(ret = NetBench::Wait(fd, send? POLLOUT : POLLIN, deadline))) {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // The clock runs from the request to the last byte: for an upload that is the server's count of what it
+    // received, so data still queued in the console's socket buffer isn't counted as sent.
+    static void RunTcp(const NetBenchConfig &config, const struct sockaddr_in &address, NetTest test, u8 *buffer, NetBenchResult &result) {
+        NetBenchRequest request;
+        Result ret = 0;
+        int fd = -1;
+        u64 moved = 0, acknowledged = 0;
+
+        request.magic = magic;
+        request.mode = test;
+        request.bytes = config.bytes;
+        netTotal.store(config.bytes >> 10, std::memory_order_relaxed);
+
+        if ((fd = NetBench::OpenSocket(SOCK_STREAM)) < 0) {
+            result.result = -EMFILE;
+            return;
+        }
+
+        if (R_FAILED(ret = NetBench::Connect(fd, address, config.timeout))) {
+            Log::Error("%s(NetBench::Connect) failed: %d\n", __func__, -ret);
+            close(fd);
+            result.result = ret;
+            return;
+        }
+
+        u64 start = svcGetSystemTick();
+
+        if (R_SUCCEEDED(ret = NetBench::Transfer(fd, true, reinterpret_cast<u8 *>(std::addressof(request)), sizeof(request), sizeof(request), config.timeout, moved, false))) {
+            ret = NetBench::Transfer(fd, test == NET_TEST_TCP_UPLOAD, buffer, config.bufferSize, config.bytes, config.timeout, result.bytes, true);
+        }
+
+        if (R_SUCCEEDED(ret) && (test == NET_TEST_TCP_UPLOAD)) {
+            moved = 0;
+
+            if (R_SUCCEEDED(ret = NetBench::Transfer(fd, false, reinterpret_cast<u8 *>(std::addressof(acknowledged)), sizeof(acknowledged),
+                sizeof(acknowledged), config.timeout, moved, false)) && (acknowledged != result.bytes)) {
+                ret = -EPROTO;
+            }
+        }
+
+        result.ticks = svcGetSystemTick() - start;
+        result.result = ret;
+        close(fd);
+
+        if (R_SUCCEEDED(ret) && result.ticks) {
+            double seconds = static_cast<double>(result.ticks) / SYSCLOCK_ARM11;
+            result.mbitPerSecond = static_cast<float>((result.bytes * 8.0) / seconds / 1000000.0);
+        }
+    }
+
+    // Ping-pong: one datagram in flight, the next leaves pingInterval after the previous one or as soon as its
+    // reply is in, whichever is later. Replies arriving after timeout are dropped as late, not matched.
+    static void RunUdp(const NetBenchConfig &config, const struct sockaddr_in &address, u8 *buffer, u32 *rtts, NetBenchResult &result) {
+        u32 size = std::clamp<u32>(config.pingSize, sizeof(NetBenchPing), config.bufferSize);
+        int fd = -1;
+
+        netTotal.store(config.pings, std::memory_order_relaxed);
+
+        if ((fd = NetBench::OpenSocket(SOCK_DGRAM)) < 0) {
+            result.result = -EMFILE;
+            return;
+        }
+
+        if (connect(fd, reinterpret_cast<const struct sockaddr *>(std::addressof(address)), sizeof(address)) != 0) {
+            Log::Error("%s(connect) failed: %d\n", __func__, errno);
+            result.result = -errno;
+            close(fd);
+            return;
+        }
+
+        for (u32 i = 0; i < size; i++) {
+            buffer[i] = static_cast<u8>(i * 131);
+        }
+
+        u64 start = svcGetSystemTick();
+
+        for (u32 i = 0; (i < config.pings) && !netCancel.load(std::memory_order_relaxed); i++) {
+            NetBenchPing ping;
+            ping.magic = magic;
+            ping.sequence = i;
+            ping.tick = svcGetSystemTick();
+            std::memcpy(buffer, std::addressof(ping), sizeof(ping));
+
+            u64 next = ping.tick + static_cast<u64>(config.pingInterval * CPU_TICKS_PER_MSEC);
+            u64 deadline = std::max(NetBench::Deadline(config.timeout), next);
+            bool answered = false;
+
+            // A refused or dropped datagram is a lost ping, not a failed test.
+            if (send(fd, buffer, size, Net::sendFlags) == static_cast<ssize_t>(size)) {
+                result.sent++;
+                result.bytes += size;
+            }
+
+            while (!netCancel.load(std::memory_order_relaxed)) {
+                u64 now = svcGetSystemTick();
+
+                if ((now >= deadline) || (answered && (now >= next))) {
+                    break;
+                }
+
+                if (R_FAILED(NetBench::Wait(fd, POLLIN, answered? next : deadline))) {
+                    continue;
+                }
+
+                ssize_t bytes = recv(fd, buffer, config.bufferSize, 0);
+                u64 received = svcGetSystemTick();
+                NetBenchPing reply;
+
+                if (bytes < static_cast<ssize_t>(sizeof(reply))) {
+                    continue;
+                }
+
+                std::memcpy(std::addressof(reply), buffer, sizeof(reply));
+
+                if ((!answered) && (reply.magic == magic) && (reply.sequence == i)) {
+                    rtts[result.received++] = static_cast<u32>((received - reply.tick) / CPU_TICKS_PER_USEC);
+                    answered = true;
+                }
+            }
+
+            netDone.store(i + 1, std::memory_order_relaxed);
+        }
+
+        result.ticks = svcGetSystemTick() - start;
+        result.result = netCancel.load(std::memory_order_relaxed)? -ECANCELED : 0;
+        close(fd);
+
+        if (result.sent) {
+            result.loss = 100.f * static_cast<float>(result.sent - result.received) / static_cast<float>(result.sent);
+        }
+
+        if (result.received) {
+            std::sort(rtts, rtts + result.received);
+            result.rtt50 = rtts[(result.received * 50) / 100];
+            result.rtt90 = rtts[(result.received * 90) / 100];
+            result.rtt99 = rtts[(result.received * 99) / 100];
+            result.rttMax = rtts[result.received - 1];
+        }
+    }
+
+    void GetDefaultConfig(NetBenchConfig &config) {
+        config.host = "";
+        config.port = defaultPort;
+        config.bytes = 8 * 1024 * 1024;
+        config.bufferSize = 32 * 1024;
+        config.pings = 200;
+        config.pingSize = 64;
+        config.pingInterval = 20;
+        config.timeout = 1000;
+    }
+
+    // Runs the three tests in order against one server. Stops at the first test that fails.
+    Result Run(const NetBenchConfig &config, NetBenchResult *results) {
+        struct sockaddr_in address;
+        Result ret = 0;
+
+        std::memset(results, 0, sizeof(NetBenchResult) * NET_TEST_MAX);
+
+        if (config.bufferSize < sizeof(NetBenchPing)) {
+            return -EINVAL;
+        }
+
+        if (R_FAILED(ret = Net::Resolve(config.host, config.port, address))) {
+            results[0].result = ret;
+            return ret;
+        }
+
+        u8 *buffer = static_cast<u8 *>(memalign(0x1000, config.bufferSize));
+        u32 *rtts = new u32[config.pings? config.pings : 1];
+
+        if (!buffer) {
+            Log::Error("%s(memalign) failed\n", __func__);
+            delete[] rtts;
+            return -ENOMEM;
+        }
+
+        for (u32 i = 0; i < config.bufferSize; i++) {
+            buffer[i] = static_cast<u8>(i * 131);
+        }
+
+        for (int i = 0; i < NET_TEST_MAX; i++) {
+            netTest.store(i, std::memory_order_relaxed);
+            netDone.store(0, std::memory_order_relaxed);
+
+            if (i == NET_TEST_UDP_PING) {
+                NetBench::RunUdp(config, address, buffer, rtts, results[i]);
+            }
+            else {
+                NetBench::RunTcp(config, address, static_cast<NetTest>(i), buffer, results[i]);
+            }
+
+            if (R_FAILED(ret = results[i].result)) {
+                break;
+            }
+        }
+
+        free(buffer);
+        delete[] rtts;
+        return ret;
+    }
+
+    static void Controller(void *arg) {
+        NetBench::Run(netConfig, netResults);
+        netRunning.store(false, std::memory_order_release);
+    }
+
+    // Runs the tests on a thread below the caller's priority. The host name is copied, config.host needn't outlive
+    // the run.
+    bool Start(const NetBenchConfig &config) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        NetBench::Stop();
+        std::memset(netResults, 0, sizeof(netResults));
+        std::snprintf(netHost, sizeof(netHost), "%s", config.host? config.host : "");
+        netConfig = config;
+        netConfig.host = netHost;
+        netTest.store(0, std::memory_order_relaxed);
+        netDone.store(0, std::memory_order_relaxed);
+        netTotal.store(0, std::memory_order_relaxed);
+        netCancel.store(false, std::memory_order_relaxed);
+        netRunning.store(true, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(netThread = threadCreate(NetBench::Controller, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            netRunning.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Cancels a run still in progress, within one poll slice.
+    void Stop(void) {
+        if (!netThread) {
+            return;
+        }
+
+        netCancel.store(true, std::memory_order_relaxed);
+        threadJoin(netThread, U64_MAX);
+        threadFree(netThread);
+        netThread = nullptr;
+    }
+
+    bool IsRunning(void) {
+        return netRunning.load(std::memory_order_acquire);
+    }
+
+    float GetProgress(void) {
+        u32 total = netTotal.load(std::memory_order_relaxed);
+        float test = total? std::min(1.f, static_cast<float>(netDone.load(std::memory_order_relaxed)) / total) : 0.f;
+        return (netTest.load(std::memory_order_relaxed) + test) / static_cast<float>(NET_TEST_MAX);
+    }
+
+    // Only valid once IsRunning() returns false.
+    void GetResults(NetBenchResult *results) {
+        std::memcpy(results, netResults, sizeof(netResults));
+    }
+
+    const char *GetTestName(NetTest test) {
+        return test < NET_TEST_MAX? netTestNames[test] : "";
+    }
+}
@@ -0,0 +1,162 @@
+#include <3ds.h>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include "log.h"
+#include "probe.h"
+#include "snapshot.h"
+
+namespace Probe {
+    static const struct {
+        u32 offset;
+        u32 size;
+    } probeGroups[PROBE_MAX] = {
+        { offsetof(ProbeResults, kernelInfo), sizeof(KernelInfo) },
+        { offsetof(ProbeResults, systemInfo), sizeof(SystemInfo) },
+        { offsetof(ProbeResults, nnidInfo), sizeof(NNIDInfo) },
+        { offsetof(ProbeResults, configInfo), sizeof(ConfigInfo) },
+        { offsetof(ProbeResults, hardwareInfo), sizeof(HardwareInfo) },
+        { offsetof(ProbeResults, wifiInfo), sizeof(WifiInfo) },
+        { offsetof(ProbeResults, storageInfo), sizeof(StorageInfo) },
+        { offsetof(ProbeResults, miscInfo), sizeof(MiscInfo) },
+        { offsetof(ProbeResults, systemStateInfo), sizeof(SystemStateInfo) }
+    };
+
+    static const char *snapshotPath = "sdmc:/3ds/3dsident_cache.bin";
+
+    // results is what the UI sees, guarded by lock. fresh is only touched by the worker.
+    static ProbeResults results, fresh;
+    static u32 readyMask = 0, cachedMask = 0;
+    static LightLock lock;
+    static std::atomic<bool> stopRequested;
+    static Thread thread;
+
+    // Returns how many fields differ from the snapshot the group was restored from.
+    static u32 Run(ProbeId id) {
+        switch (id) {
+            case PROBE_KERNEL_INFO:
+                fresh.kernelInfo = Service::GetKernelInfo();
+                break;
+
+            case PROBE_SYSTEM_INFO:
+                fresh.systemInfo = Service::GetSystemInfo();
+                break;
+
+            case PROBE_NNID_INFO:
+                fresh.nnidInfo = Service::GetNNIDInfo();
+                break;
+
+            case PROBE_CONFIG_INFO:
+                fresh.configInfo = Service::GetConfigInfo();
+                break;
+
+            case PROBE_HARDWARE_INFO:
+                fresh.hardwareInfo = Service::GetHardwareInfo();
+                break;
+
+            case PROBE_WIFI_INFO:
+                fresh.wifiInfo = Service::GetWifiInfo();
+                break;
+
+            case PROBE_STORAGE_INFO:
+                fresh.storageInfo = Service::GetStorageInfo();
+                break;
+
+            case PROBE_MISC_INFO:
+                fresh.miscInfo = Service::GetMiscInfo();
+                break;
+
+            case PROBE_SYSTEM_STATE_INFO:
+                fresh.systemStateInfo = Service::GetSystemStateInfo();
+                break;
+
+            default:
+                return 0;
+        }
+
+        u32 changed = 0;
+        LightLock_Lock(std::addressof(lock));
+
+        // Groups restored from the snapshot are already on screen, only replace the fields that changed since.
+        if (cachedMask & BIT(id)) {
+            changed = Snapshot::Merge(id, results, fresh);
+        }
+        else {
+            std::memcpy(reinterpret_cast<u8 *>(std::addressof(results)) + probeGroups[id].offset,
+                reinterpret_cast<const u8 *>(std::addressof(fresh)) + probeGroups[id].offset, probeGroups[id].size);
+        }
+
+        readyMask |= BIT(id);
+        LightLock_Unlock(std::addressof(lock));
+        return changed;
+    }
+
+    static void Worker(void *arg) {
+        u32 changed = 0;
+        bool completed = true;
+
+        Service::Init();
+
+        for (int i = 0; i < PROBE_MAX; i++) {
+            if (stopRequested.load(std::memory_order_relaxed)) {
+                completed = false;
+                break;
+            }
+
+            changed += Probe::Run(static_cast<ProbeId>(i));
+        }
+
+        Service::Exit();
+
+        // Only the worker writes results, so it can be read here without the lock. The snapshot is only rewritten
+        // when it was missing or something in it went stale.
+        if ((completed) && ((changed) || (!cachedMask))) {
+            Snapshot::Save(snapshotPath, results, BIT(PROBE_MAX) - 1);
+        }
+    }
+
+    void Start(void) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        LightLock_Init(std::addressof(lock));
+        stopRequested.store(false, std::memory_order_relaxed);
+
+        // Pages restored from the last run's snapshot can be drawn right away, the worker revalidates them.
+        cachedMask = Snapshot::Load(snapshotPath, results);
+        readyMask = cachedMask;
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        // Run just below the UI thread, so probes only take the time the render loop spends waiting on the GPU.
+        thread = threadCreate(Probe::Worker, nullptr, 0x10000, priority < 0x3F? priority + 1 : priority, -2, false);
+
+        if (!thread) {
+            Log::Error("%s(threadCreate) failed, probing synchronously\n", __func__);
+            Probe::Worker(nullptr);
+        }
+    }
+
+    void Stop(void) {
+        if (!thread) {
+            return;
+        }
+
+        stopRequested.store(true, std::memory_order_relaxed);
+        threadJoin(thread, U64_MAX);
+        threadFree(thread);
+        thread = nullptr;
+    }
+
+    // Copies the published results, returns a ProbeId bit mask of the groups in the copy that are filled in.
+    u32 Read(ProbeResults &out) {
+        LightLock_Lock(std::addressof(lock));
+        std::memcpy(std::addressof(out), std::addressof(results), sizeof(ProbeResults));
+        u32 mask = readyMask;
+        LightLock_Unlock(std::addressof(lock));
+        return mask;
+    }
+}
@@ -0,0 +1,245 @@
+#include <3ds.h>
+#include <atomic>
+#include <cstring>
+#include <unistd.h>
+
+#include "batterylog.h"
+#include "hardware.h"
+#include "log.h"
+#include "sampler.h"
+#include "service.h"
+#include "storage.h"
+
+namespace Sampler {
+    // Sampling period of each field in milliseconds, 0 samples the field once at start up.
+    static const u32 samplerPeriods[SAMPLER_FIELD_MAX] = {
+        1000, // SAMPLER_FIELD_BATTERY_PERCENTAGE
+        500,  // SAMPLER_FIELD_BATTERY_CHARGING
+        1000, // SAMPLER_FIELD_BATTERY_VOLTAGE
+        1000, // SAMPLER_FIELD_BATTERY_TEMPERATURE
+        500,  // SAMPLER_FIELD_ADAPTER_STATE
+        0,    // SAMPLER_FIELD_MCU_FIRMWARE
+        100,  // SAMPLER_FIELD_AUDIO_JACK
+        500,  // SAMPLER_FIELD_CARD_SLOT
+        500,  // SAMPLER_FIELD_SD_INSERTED
+        250,  // SAMPLER_FIELD_BRIGHTNESS
+        500,  // SAMPLER_FIELD_WIFI_STRENGTH
+        2000, // SAMPLER_FIELD_HOSTNAME
+        5000  // SAMPLER_FIELD_STORAGE
+    };
+
+    static LiveInfo snapshot;
+    static std::atomic<u32> sequence;
+    static LightEvent stopEvent;
+    static std::atomic<bool> stopRequested;
+    static Thread thread;
+
+    // Used instead of the thread when it couldn't be created, Read() then samples whatever is due on the caller's
+    // thread. The telemetry push reads from a thread of its own, hence the lock.
+    static bool fallback = false;
+    static LightLock fallbackLock;
+    static LiveInfo fallbackInfo;
+    static u64 fallbackNext[SAMPLER_FIELD_MAX];
+
+    static void Sample(SamplerField field, LiveInfo &info) {
+        Result ret = 0;
+
+        switch (field) {
+            case SAMPLER_FIELD_BATTERY_PERCENTAGE:
+                ret = MCUHWC_GetBatteryLevel(std::addressof(info.batteryPercentage));
+                break;
+
+            case SAMPLER_FIELD_BATTERY_CHARGING: {
+                u8 status = 0;
+                ret = PTMU_GetBatteryChargeState(std::addressof(status));
+                info.batteryCharging = status != 0;
+                break;
+            }
+
+            case SAMPLER_FIELD_BATTERY_VOLTAGE:
+                ret = MCUHWC_GetBatteryVoltage(std::addressof(info.batteryVoltage));
+                break;
+
+            case SAMPLER_FIELD_BATTERY_TEMPERATURE:
+                ret = MCUHWC::GetBatteryTemperature(std::addressof(info.batteryTemperature));
+                break;
+
+            case SAMPLER_FIELD_ADAPTER_STATE:
+                ret = PTMU_GetAdapterState(std::addressof(info.adapterConnected));
+                break;
+
+            case SAMPLER_FIELD_MCU_FIRMWARE:
+                if (R_SUCCEEDED(ret = MCUHWC_GetFwVerHigh(std::addressof(info.mcuFwVerHigh)))) {
+                    ret = MCUHWC_GetFwVerLow(std::addressof(info.mcuFwVerLow));
+                }
+                break;
+
+            case SAMPLER_FIELD_AUDIO_JACK:
+                info.audioJackInserted = Hardware::GetAudioJackStatus();
+                break;
+
+            case SAMPLER_FIELD_CARD_SLOT:
+                info.cardSlotInserted = Hardware::GetCardSlotStatus();
+                break;
+
+            case SAMPLER_FIELD_SD_INSERTED:
+                info.sdInserted = Hardware::IsSdInserted();
+                break;
+
+            case SAMPLER_FIELD_BRIGHTNESS:
+                info.brightness = Hardware::GetBrightness(GSPLCD_SCREEN_TOP);
+                break;
+
+            case SAMPLER_FIELD_WIFI_STRENGTH:
+                info.wifiStrength = osGetWifiStrength();
+                break;
+
+            case SAMPLER_FIELD_HOSTNAME:
+                if (gethostname(info.hostname, sizeof(info.hostname)) != 0) {
+                    info.hostname[0] = '\0';
+                    ret = -1;
+                }
+                break;
+
+            case SAMPLER_FIELD_STORAGE:
+                Storage::Refresh(info.storage);
+                break;
+
+            default:
+                return;
+        }
+
+        if (R_FAILED(ret)) {
+            info.valid &= ~BIT(field);
+        }
+        else {
+            info.valid |= BIT(field);
+        }
+    }
+
+    // Seqlock writer, the sequence is odd while the snapshot is being rewritten.
+    static void Publish(const LiveInfo &info) {
+        u32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(std::addressof(snapshot), std::addressof(info), sizeof(LiveInfo));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Samples every field that is due and returns when the next one will be, U64_MAX when none ever will.
+    static u64 Update(LiveInfo &info, u64 *next, bool &updated) {
+        u64 now = osGetTime();
+        u64 wake = U64_MAX;
+        updated = false;
+
+        for (int i = 0; i < SAMPLER_FIELD_MAX; i++) {
+            if (now >= next[i]) {
+                Sampler::Sample(static_cast<SamplerField>(i), info);
+                updated = true;
+                next[i] = samplerPeriods[i]? now + samplerPeriods[i] : U64_MAX;
+            }
+
+            if (next[i] < wake) {
+                wake = next[i];
+            }
+        }
+
+        if (updated) {
+            BatteryLog::Record(info);
+        }
+
+        return wake;
+    }
+
+    static void Worker(void *arg) {
+        LiveInfo info = { 0 };
+        u64 next[SAMPLER_FIELD_MAX] = { 0 };
+
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            bool updated = false;
+            u64 wake = Sampler::Update(info, next, updated);
+
+            if (updated) {
+                Sampler::Publish(info);
+            }
+
+            if (wake == U64_MAX) {
+                LightEvent_Wait(std::addressof(stopEvent));
+            }
+            else {
+                u64 current = osGetTime();
+                LightEvent_WaitTimeout(std::addressof(stopEvent), wake > current? (wake - current) * 1000000ULL : 0);
+            }
+        }
+    }
+
+    void Start(void) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        sequence.store(0, std::memory_order_relaxed);
+        stopRequested.store(false, std::memory_order_relaxed);
+        LightEvent_Init(std::addressof(stopEvent), RESET_ONESHOT);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        thread = threadCreate(Sampler::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false);
+
+        if (!thread) {
+            Log::Error("%s(threadCreate) failed, sampling on the reader's thread\n", __func__);
+            LightLock_Init(std::addressof(fallbackLock));
+            std::memset(std::addressof(fallbackInfo), 0, sizeof(LiveInfo));
+            std::memset(fallbackNext, 0, sizeof(fallbackNext));
+            fallback = true;
+        }
+    }
+
+    void Stop(void) {
+        fallback = false;
+
+        if (!thread) {
+            return;
+        }
+
+        stopRequested.store(true, std::memory_order_relaxed);
+        LightEvent_Signal(std::addressof(stopEvent));
+        threadJoin(thread, U64_MAX);
+        threadFree(thread);
+        thread = nullptr;
+    }
+
+    // Seqlock reader. The sampler runs below the render loop on the same core, so spinning on an odd sequence
+    // could wait on a writer that never gets scheduled. Give up after a few tries and keep the previous values.
+    bool Read(LiveInfo &info) {
+        LiveInfo copy;
+
+        if (fallback) {
+            bool updated = false;
+            LightLock_Lock(std::addressof(fallbackLock));
+            Sampler::Update(fallbackInfo, fallbackNext, updated);
+            info = fallbackInfo;
+            LightLock_Unlock(std::addressof(fallbackLock));
+            return true;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            u32 begin = sequence.load(std::memory_order_acquire);
+
+            if ((begin == 0) || (begin & 1)) {
+                continue;
+            }
+
+            std::memcpy(std::addressof(copy), std::addressof(snapshot), sizeof(LiveInfo));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == begin) {
+                info = copy;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,200 @@
+#include <3ds.h>
+#include <cstddef>
+#include <cstring>
+
+#include "schema.h"
+
+namespace Schema {
+#define SCHEMA_NAMED(name, kind, type, member, flags) { name, kind, flags, offsetof(type, member), sizeof(type::member) }
+#define SCHEMA_FIELD(kind, type, member, flags) SCHEMA_NAMED(#member, kind, type, member, flags)
+
+    static const u8 persisted = FIELD_FLAG_PERSISTED, secret = FIELD_FLAG_PRIVATE, hidden = FIELD_FLAG_PERSISTED | FIELD_FLAG_PRIVATE;
+
+    static const FieldInfo kernelFields[] = {
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, kernelVersion, persisted),
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, firmVersion, persisted),
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, systemVersion, persisted),
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, initialVersion, persisted),
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, sdmcCid, hidden),
+        SCHEMA_FIELD(FIELD_STRING, KernelInfo, nandCid, hidden),
+        SCHEMA_FIELD(FIELD_UNSIGNED, KernelInfo, deviceId, hidden)
+    };
+
+    static const FieldInfo systemFields[] = {
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, model, persisted),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, hardware, persisted),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, region, persisted),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, language, persisted),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemInfo, localFriendCodeSeed, hidden),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, nandLocalFriendCodeSeed, hidden),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, macAddress, hidden),
+        SCHEMA_FIELD(FIELD_STRING, SystemInfo, serialNumber, hidden),
+        SCHEMA_FIELD(FIELD_SIGNED, SystemInfo, checkDigit, hidden),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemInfo, soapId, hidden)
+    };
+
+    static const FieldInfo nnidFields[] = {
+        SCHEMA_FIELD(FIELD_UNSIGNED, NNIDInfo, persistentID, hidden),
+        SCHEMA_FIELD(FIELD_UNSIGNED, NNIDInfo, transferableIdBase, hidden),
+        SCHEMA_FIELD(FIELD_STRING, NNIDInfo, accountId, persisted),
+        SCHEMA_FIELD(FIELD_STRING, NNIDInfo, countryName, hidden),
+        SCHEMA_FIELD(FIELD_UNSIGNED, NNIDInfo, principalID, hidden),
+        SCHEMA_FIELD(FIELD_STRING, NNIDInfo, nfsPassword, secret)
+    };
+
+    static const FieldInfo configFields[] = {
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, username, persisted),
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, birthday, hidden),
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, eulaVersion, persisted),
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, parentalPin, secret),
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, parentalEmail, secret),
+        SCHEMA_FIELD(FIELD_STRING, ConfigInfo, parentalSecretAnswer, secret)
+    };
+
+    static const FieldInfo hardwareFields[] = {
+        SCHEMA_FIELD(FIELD_STRING, HardwareInfo, screenUpper, persisted),
+        SCHEMA_FIELD(FIELD_STRING, HardwareInfo, screenLower, persisted),
+        SCHEMA_FIELD(FIELD_STRING, HardwareInfo, soundOutputMode, persisted)
+    };
+
+    static const FieldInfo wifiFields[] = {
+        SCHEMA_FIELD(FIELD_BOOL, WifiInfo, slot[0], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, ssid[0], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, passphrase[0], secret),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, securityMode[0], persisted),
+        SCHEMA_FIELD(FIELD_BOOL, WifiInfo, slot[1], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, ssid[1], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, passphrase[1], secret),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, securityMode[1], persisted),
+        SCHEMA_FIELD(FIELD_BOOL, WifiInfo, slot[2], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, ssid[2], persisted),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, passphrase[2], secret),
+        SCHEMA_FIELD(FIELD_CHARS, WifiInfo, securityMode[2], persisted)
+    };
+
+    // Storage changes while running, the sampler keeps it current instead of the snapshot.
+    static const FieldInfo storageFields[] = {
+        SCHEMA_NAMED("ctrNandUsedSize", FIELD_UNSIGNED, StorageInfo, usedSize[SYSTEM_MEDIATYPE_CTR_NAND], 0),
+        SCHEMA_NAMED("ctrNandTotalSize", FIELD_UNSIGNED, StorageInfo, totalSize[SYSTEM_MEDIATYPE_CTR_NAND], 0),
+        SCHEMA_NAMED("twlNandUsedSize", FIELD_UNSIGNED, StorageInfo, usedSize[SYSTEM_MEDIATYPE_TWL_NAND], 0),
+        SCHEMA_NAMED("twlNandTotalSize", FIELD_UNSIGNED, StorageInfo, totalSize[SYSTEM_MEDIATYPE_TWL_NAND], 0),
+        SCHEMA_NAMED("sdUsedSize", FIELD_UNSIGNED, StorageInfo, usedSize[SYSTEM_MEDIATYPE_SD], 0),
+        SCHEMA_NAMED("sdTotalSize", FIELD_UNSIGNED, StorageInfo, totalSize[SYSTEM_MEDIATYPE_SD], 0),
+        SCHEMA_NAMED("twlPhotoUsedSize", FIELD_UNSIGNED, StorageInfo, usedSize[SYSTEM_MEDIATYPE_TWL_PHOTO], 0),
+        SCHEMA_NAMED("twlPhotoTotalSize", FIELD_UNSIGNED, StorageInfo, totalSize[SYSTEM_MEDIATYPE_TWL_PHOTO], 0)
+    };
+
+    static const FieldInfo miscFields[] = {
+        SCHEMA_FIELD(FIELD_UNSIGNED, MiscInfo, sdTitleCount, persisted),
+        SCHEMA_FIELD(FIELD_UNSIGNED, MiscInfo, nandTitleCount, persisted),
+        SCHEMA_FIELD(FIELD_UNSIGNED, MiscInfo, ticketCount, persisted),
+        SCHEMA_FIELD(FIELD_STRING, MiscInfo, manufacturingDate, persisted)
+    };
+
+    // Read from the MCU, these include LED and button state that changes while running.
+    static const FieldInfo systemStateFields[] = {
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, consoleInfo, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, pmicVendorCode, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, batteryVendorCode, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, mgicVersionMajor, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, mgicVersionMinor, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, rcomp, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, ntcRead, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, systemModel, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, redPowerLedMode, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, bluePowerLedIntensity, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, rgbLedRedIntensity, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, rgbLedGreenIntensity, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, rgbLedBlueIntensity, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, wifiLedBrightness, 0),
+        SCHEMA_FIELD(FIELD_UNSIGNED, SystemStateInfo, rawButtonState, 0)
+    };
+
+#undef SCHEMA_NAMED
+#undef SCHEMA_FIELD
+
+    static const GroupInfo schemaGroups[] = {
+        { PROBE_KERNEL_INFO, "kernel", offsetof(ProbeResults, kernelInfo), kernelFields, sizeof(kernelFields) / sizeof(FieldInfo) },
+        { PROBE_SYSTEM_INFO, "system", offsetof(ProbeResults, systemInfo), systemFields, sizeof(systemFields) / sizeof(FieldInfo) },
+        { PROBE_NNID_INFO, "nnid", offsetof(ProbeResults, nnidInfo), nnidFields, sizeof(nnidFields) / sizeof(FieldInfo) },
+        { PROBE_CONFIG_INFO, "config", offsetof(ProbeResults, configInfo), configFields, sizeof(configFields) / sizeof(FieldInfo) },
+        { PROBE_HARDWARE_INFO, "hardware", offsetof(ProbeResults, hardwareInfo), hardwareFields, sizeof(hardwareFields) / sizeof(FieldInfo) },
+        { PROBE_WIFI_INFO, "wifi", offsetof(ProbeResults, wifiInfo), wifiFields, sizeof(wifiFields) / sizeof(FieldInfo) },
+        { PROBE_STORAGE_INFO, "storage", offsetof(ProbeResults, storageInfo), storageFields, sizeof(storageFields) / sizeof(FieldInfo) },
+        { PROBE_MISC_INFO, "misc", offsetof(ProbeResults, miscInfo), miscFields, sizeof(miscFields) / sizeof(FieldInfo) },
+        { PROBE_SYSTEM_STATE_INFO, "systemState", offsetof(ProbeResults, systemStateInfo), systemStateFields, sizeof(systemStateFields) / sizeof(FieldInfo) }
+    };
+
+    const GroupInfo *GetGroups(u32 &count) {
+        count = sizeof(schemaGroups) / sizeof(GroupInfo);
+        return schemaGroups;
+    }
+
+    const GroupInfo *GetGroup(ProbeId id) {
+        for (const GroupInfo &group : schemaGroups) {
+            if (group.id == id) {
+                return std::addressof(group);
+            }
+        }
+
+        return nullptr;
+    }
+
+    u8 *GetField(ProbeResults &results, const GroupInfo &group, const FieldInfo &field) {
+        return reinterpret_cast<u8 *>(std::addressof(results)) + group.offset + field.offset;
+    }
+
+    const u8 *GetField(const ProbeResults &results, const GroupInfo &group, const FieldInfo &field) {
+        return reinterpret_cast<const u8 *>(std::addressof(results)) + group.offset + field.offset;
+    }
+
+    const char *GetString(const u8 *member) {
+        const char *string = nullptr;
+        std::memcpy(std::addressof(string), member, sizeof(const char *));
+        return string;
+    }
+
+    void SetString(u8 *member, const char *string) {
+        std::memcpy(member, std::addressof(string), sizeof(const char *));
+    }
+
+    u64 GetUnsigned(const u8 *member, u32 size) {
+        switch (size) {
+            case 1:
+                return *member;
+
+            case 2: {
+                u16 value = 0;
+                std::memcpy(std::addressof(value), member, size);
+                return value;
+            }
+
+            case 4: {
+                u32 value = 0;
+                std::memcpy(std::addressof(value), member, size);
+                return value;
+            }
+
+            case 8: {
+                u64 value = 0;
+                std::memcpy(std::addressof(value), member, size);
+                return value;
+            }
+
+            default:
+                return 0;
+        }
+    }
+
+    s64 GetSigned(const u8 *member, u32 size) {
+        u64 value = Schema::GetUnsigned(member, size);
+        u32 bits = size * 8;
+
+        // Sign extend from the member's width
+        if ((bits < 64) && (value & (1ULL << (bits - 1)))) {
+            value |= ~0ULL << bits;
+        }
+
+        return static_cast<s64>(value);
+    }
+}
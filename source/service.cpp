@@ -3,13 +3,14 @@
 
 #include "config.h"
 #include "hardware.h"
+#include "ipcstats.h"
 #include "kernel.h"
 #include "misc.h"
 #include "nnid.h"
 #include "service.h"
 #include "storage.h"
 #include "system.h"
-#include "utils.h"
+#include "trace.h"
 #include "wifi.h"
 
 namespace ACI {
@@ -65,6 +66,11 @@ namespace ACTU {
         if (R_FAILED(ret)) {
             AtomicDecrement(std::addressof(actRefCount));
         }
+#if defined BUILD_TRACE
+        else {
+            IPCStats::Register("act", std::addressof(actHandle));
+        }
+#endif
         
         return ret;
     }
@@ -126,6 +132,7 @@ namespace Service {
     }
 
     KernelInfo GetKernelInfo(void) {
+        TRACE_SCOPE("Service::GetKernelInfo");
         KernelInfo info = { 0 };
         info.kernelVersion = Kernel::GetVersion(VERSION_INFO_KERNEL);
         info.firmVersion = Kernel::GetVersion(VERSION_INFO_FIRM);
@@ -138,6 +145,7 @@ namespace Service {
     }
 
     SystemInfo GetSystemInfo(void) {
+        TRACE_SCOPE("Service::GetSystemInfo");
         SystemInfo info = { 0 };
         info.model = System::GetModel();
         info.hardware = System::GetRunningHW();
@@ -153,6 +161,7 @@ namespace Service {
     }
     
     NNIDInfo GetNNIDInfo(void) {
+        TRACE_SCOPE("Service::GetNNIDInfo");
         NNIDInfo info = { 0 };
         info.persistentID = NNID::GetPersistentId();
         info.transferableIdBase = NNID::GetTransferableIdBase();
@@ -164,6 +173,7 @@ namespace Service {
     }
 
     ConfigInfo GetConfigInfo(void) {
+        TRACE_SCOPE("Service::GetConfigInfo");
         ConfigInfo info = { 0 };
         info.username = Config::GetUsername();
         info.birthday = Config::GetBirthday();
@@ -175,6 +185,7 @@ namespace Service {
     }
 
     HardwareInfo GetHardwareInfo(void) {
+        TRACE_SCOPE("Service::GetHardwareInfo");
         HardwareInfo info = { 0 };
 
         gspLcdScreenType top, bottom;
@@ -199,6 +210,7 @@ namespace Service {
     }
 
     MiscInfo GetMiscInfo(void) {
+        TRACE_SCOPE("Service::GetMiscInfo");
         MiscInfo info = { 0 };
         info.sdTitleCount = Misc::GetTitleCount(MEDIATYPE_SD);
         info.nandTitleCount = Misc::GetTitleCount(MEDIATYPE_NAND);
@@ -208,6 +220,7 @@ namespace Service {
     }
 
     WifiInfo GetWifiInfo(void) {
+        TRACE_SCOPE("Service::GetWifiInfo");
         WifiInfo info = { 0 };
 
         for (u32 i = 0; i < 3; i++) {
@@ -223,20 +236,14 @@ namespace Service {
     }
 
     StorageInfo GetStorageInfo(void) {
+        TRACE_SCOPE("Service::GetStorageInfo");
         StorageInfo info = { 0 };
-        
-        for (int i = 0; i < 4; i++) {
-            info.usedSize[i] = Storage::GetUsedStorage(static_cast<FS_SystemMediaType>(i));
-            info.totalSize[i] = Storage::GetTotalStorage(static_cast<FS_SystemMediaType>(i));
-            Utils::GetSizeString(info.freeSizeString[i], Storage::GetFreeStorage(static_cast<FS_SystemMediaType>(i)));
-            Utils::GetSizeString(info.usedSizeString[i], Storage::GetUsedStorage(static_cast<FS_SystemMediaType>(i)));
-            Utils::GetSizeString(info.totalSizeString[i], Storage::GetTotalStorage(static_cast<FS_SystemMediaType>(i)));
-        }
-
+        Storage::Refresh(info);
         return info;
     }
 
     SystemStateInfo GetSystemStateInfo(void) {
+        TRACE_SCOPE("Service::GetSystemStateInfo");
         SystemStateInfo info = { 0 };
 
         if (R_FAILED(MCUHWC_ReadRegister(0x7F, std::addressof(info), sizeof(SystemStateInfo)))) {
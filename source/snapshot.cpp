@@ -0,0 +1,271 @@
+#include <3ds.h>
+#include <cstring>
+
+#include "log.h"
+#include "schema.h"
+#include "snapshot.h"
+
+// Snapshot file layout, all values little endian:
+//   Header  { u32 magic "3DSI", u16 version, u16 reserved, u32 payload size, u32 payload CRC-32 }
+//   Payload { u16 tag, u16 length, u8 data[length] } records, tag is (ProbeId << 8) | field index.
+// Strings are stored without their NUL terminator. Unknown tags are skipped, so fields can be appended to a group
+// without a version bump; removing or reordering fields needs one.
+
+namespace Snapshot {
+    typedef struct {
+        u32 magic;
+        u16 version;
+        u16 reserved;
+        u32 size;
+        u32 crc;
+    } Header;
+
+    static const u32 snapshotMagic = 0x49534433; // "3DSI"
+    static const u16 snapshotVersion = 1;
+
+    // Holds the file while it is read or written, and the strings restored from it for the lifetime of the app.
+    static u8 snapshotBuffer[0x1000];
+    static char snapshotPool[0x1000];
+    static u32 snapshotPoolSize = 0;
+
+    static u32 GetCrc32(const u8 *data, u32 size) {
+        u32 crc = 0xFFFFFFFF;
+
+        for (u32 i = 0; i < size; i++) {
+            crc ^= data[i];
+
+            for (int j = 0; j < 8; j++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+
+        return ~crc;
+    }
+
+    static const char *AddString(const u8 *data, u32 length) {
+        if (snapshotPoolSize + length + 1 > sizeof(snapshotPool)) {
+            return "";
+        }
+
+        char *string = snapshotPool + snapshotPoolSize;
+        std::memcpy(string, data, length);
+        string[length] = '\0';
+        snapshotPoolSize += length + 1;
+        return string;
+    }
+
+    // Restores the groups found in the snapshot at path, returns a ProbeId bit mask of them.
+    u32 Load(const char *path, ProbeResults &results) {
+        std::FILE *file = std::fopen(path, "rb");
+        if (!file) {
+            return 0;
+        }
+
+        Header header = { 0 };
+        size_t read = std::fread(std::addressof(header), 1, sizeof(Header), file);
+        bool valid = (read == sizeof(Header)) && (header.magic == snapshotMagic) && (header.version == snapshotVersion) &&
+            (header.size <= sizeof(snapshotBuffer)) && (std::fread(snapshotBuffer, 1, header.size, file) == header.size) &&
+            (Snapshot::GetCrc32(snapshotBuffer, header.size) == header.crc);
+
+        std::fclose(file);
+
+        if (!valid) {
+            Log::Error("%s: %s is not a valid snapshot\n", __func__, path);
+            return 0;
+        }
+
+        u32 mask = 0;
+        snapshotPoolSize = 0;
+
+        for (u32 position = 0; position + 4 <= header.size;) {
+            u16 tag = snapshotBuffer[position] | (snapshotBuffer[position + 1] << 8);
+            u16 length = snapshotBuffer[position + 2] | (snapshotBuffer[position + 3] << 8);
+            const u8 *data = snapshotBuffer + position + 4;
+            position += 4 + length;
+
+            if (position > header.size) {
+                break;
+            }
+
+            const GroupInfo *group = Schema::GetGroup(static_cast<ProbeId>(tag >> 8));
+            if ((!group) || ((tag & 0xFF) >= group->count)) {
+                continue;
+            }
+
+            // Strings that aren't in the file, secrets included, read as empty rather than nullptr.
+            if (!(mask & BIT(group->id))) {
+                for (u32 i = 0; i < group->count; i++) {
+                    if (group->fields[i].type == FIELD_STRING) {
+                        Schema::SetString(Schema::GetField(results, *group, group->fields[i]), "");
+                    }
+                }
+
+                mask |= BIT(group->id);
+            }
+
+            const FieldInfo &field = group->fields[tag & 0xFF];
+            u8 *member = Schema::GetField(results, *group, field);
+
+            if (field.type == FIELD_STRING) {
+                Schema::SetString(member, Snapshot::AddString(data, length));
+            }
+            else if (length == field.size) {
+                std::memcpy(member, data, length);
+            }
+        }
+
+        return mask;
+    }
+
+    static bool IsEqual(const FieldInfo &field, const u8 *a, const u8 *b) {
+        if (field.type == FIELD_STRING) {
+            const char *stringA = Schema::GetString(a), *stringB = Schema::GetString(b);
+            return (stringA == stringB) || ((stringA) && (stringB) && (std::strcmp(stringA, stringB) == 0));
+        }
+
+        return std::memcmp(a, b, field.size) == 0;
+    }
+
+    // Copies the fields of a freshly probed group that differ from results, returns how many persisted fields did.
+    u32 Merge(ProbeId id, ProbeResults &results, const ProbeResults &fresh) {
+        const GroupInfo *group = Schema::GetGroup(id);
+        if (!group) {
+            return 0;
+        }
+
+        u32 changed = 0;
+
+        for (u32 i = 0; i < group->count; i++) {
+            const FieldInfo &field = group->fields[i];
+            u8 *member = Schema::GetField(results, *group, field);
+            const u8 *freshMember = Schema::GetField(fresh, *group, field);
+
+            if (!Snapshot::IsEqual(field, member, freshMember)) {
+                std::memcpy(member, freshMember, field.size);
+                changed += (field.flags & FIELD_FLAG_PERSISTED)? 1 : 0;
+            }
+        }
+
+        return changed;
+    }
+
+    static bool Append(u32 &size, u16 tag, const void *data, u32 length) {
+        if ((length > 0xFFFF) || (size + 4 + length > sizeof(snapshotBuffer))) {
+            return false;
+        }
+
+        u8 *record = snapshotBuffer + size;
+        record[0] = tag & 0xFF;
+        record[1] = tag >> 8;
+        record[2] = length & 0xFF;
+        record[3] = length >> 8;
+        std::memcpy(record + 4, data, length);
+        size += 4 + length;
+        return true;
+    }
+
+    // Writes the groups in mask to a temporary file first, so an interrupted write never replaces a good snapshot.
+    bool Save(const char *path, const ProbeResults &results, u32 mask) {
+        u32 size = 0, count = 0;
+        const GroupInfo *groups = Schema::GetGroups(count);
+
+        for (u32 g = 0; g < count; g++) {
+            const GroupInfo &group = groups[g];
+
+            if (!(mask & BIT(group.id))) {
+                continue;
+            }
+
+            for (u32 i = 0; i < group.count; i++) {
+                const FieldInfo &field = group.fields[i];
+                const u8 *member = Schema::GetField(results, group, field);
+                u16 tag = (group.id << 8) | i;
+                bool appended = true;
+
+                if (!(field.flags & FIELD_FLAG_PERSISTED)) {
+                    continue;
+                }
+
+                if (field.type == FIELD_STRING) {
+                    const char *string = Schema::GetString(member);
+
+                    if (string) {
+                        appended = Snapshot::Append(size, tag, string, std::strlen(string));
+                    }
+                }
+                else {
+                    appended = Snapshot::Append(size, tag, member, field.size);
+                }
+
+                if (!appended) {
+                    Log::Error("%s: %s.%s doesn't fit\n", __func__, group.name, field.name);
+                    return false;
+                }
+            }
+        }
+
+        Header header = { snapshotMagic, snapshotVersion, 0, size, Snapshot::GetCrc32(snapshotBuffer, size) };
+        char tempPath[256];
+        std::snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+        std::FILE *file = std::fopen(tempPath, "wb");
+        if (!file) {
+            Log::Error("%s: failed to open %s\n", __func__, tempPath);
+            return false;
+        }
+
+        bool written = (std::fwrite(std::addressof(header), 1, sizeof(Header), file) == sizeof(Header)) &&
+            (std::fwrite(snapshotBuffer, 1, size, file) == size);
+
+        if ((std::fclose(file) != 0) || (!written)) {
+            std::remove(tempPath);
+            return false;
+        }
+
+        std::remove(path);
+        return std::rename(tempPath, path) == 0;
+    }
+
+    void Print(std::FILE *file, const ProbeResults &results, u32 mask) {
+        u32 count = 0;
+        const GroupInfo *groups = Schema::GetGroups(count);
+
+        for (u32 g = 0; g < count; g++) {
+            const GroupInfo &group = groups[g];
+
+            if (!(mask & BIT(group.id))) {
+                continue;
+            }
+
+            for (u32 i = 0; i < group.count; i++) {
+                const FieldInfo &field = group.fields[i];
+                const u8 *member = Schema::GetField(results, group, field);
+
+                if (!(field.flags & FIELD_FLAG_PERSISTED)) {
+                    continue;
+                }
+
+                std::fprintf(file, "%s.%s = ", group.name, field.name);
+
+                if (field.type == FIELD_STRING) {
+                    const char *string = Schema::GetString(member);
+                    std::fprintf(file, "\"%s\"\n", string? string : "");
+                    continue;
+                }
+
+                if (field.type == FIELD_CHARS) {
+                    std::fprintf(file, "\"%.*s\"\n", static_cast<int>(field.size), reinterpret_cast<const char *>(member));
+                    continue;
+                }
+
+                if (field.type == FIELD_SIGNED) {
+                    std::fprintf(file, "%lld\n", static_cast<long long>(Schema::GetSigned(member, field.size)));
+                    continue;
+                }
+
+                unsigned long long value = Schema::GetUnsigned(member, field.size);
+                std::fprintf(file, "%llu (0x%llX)\n", value, value);
+            }
+        }
+    }
+}
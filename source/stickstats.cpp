@@ -0,0 +1,61 @@
+#include <cmath>
+#include <cstring>
+
+#include "stickstats.h"
+
+namespace StickStats {
+    void Init(StickInfo &stats, u32 deadZone) {
+        std::memset(std::addressof(stats), 0, sizeof(StickInfo));
+        stats.deadZone = deadZone;
+    }
+
+    void Add(StickInfo &stats, s16 x, s16 y) {
+        stats.count++;
+
+        double deltaX = x - stats.meanX, deltaY = y - stats.meanY;
+        stats.meanX += deltaX / stats.count;
+        stats.meanY += deltaY / stats.count;
+        stats.m2X += deltaX * (x - stats.meanX);
+        stats.m2Y += deltaY * (y - stats.meanY);
+
+        if (stats.count == 1) {
+            stats.minX = stats.maxX = x;
+            stats.minY = stats.maxY = y;
+        }
+        else {
+            stats.minX = x < stats.minX? x : stats.minX;
+            stats.maxX = x > stats.maxX? x : stats.maxX;
+            stats.minY = y < stats.minY? y : stats.minY;
+            stats.maxY = y > stats.maxY? y : stats.maxY;
+        }
+
+        // Compared squared, the radius itself is only needed when it grows.
+        u32 squared = static_cast<u32>((x * x) + (y * y));
+        bool outside = squared > stats.deadZone * stats.deadZone;
+
+        if (squared > stats.maxRadius * stats.maxRadius) {
+            stats.maxRadius = static_cast<u32>(std::sqrt(static_cast<double>(squared)));
+        }
+
+        if (outside) {
+            stats.outside++;
+            stats.excursions += stats.wasOutside? 0 : 1;
+        }
+
+        stats.wasOutside = outside;
+
+        s32 column = (x < -range? -range : (x >= range? range - 1 : x)) + range;
+        s32 row = (y < -range? -range : (y >= range? range - 1 : y)) + range;
+        u32 &cell = stats.occupancy[row / 10][column / 10];
+        stats.coveredCells += cell == 0? 1 : 0;
+        cell++;
+    }
+
+    double GetStdDevX(const StickInfo &stats) {
+        return stats.count > 1? std::sqrt(stats.m2X / (stats.count - 1)) : 0.0;
+    }
+
+    double GetStdDevY(const StickInfo &stats) {
+        return stats.count > 1? std::sqrt(stats.m2Y / (stats.count - 1)) : 0.0;
+    }
+}
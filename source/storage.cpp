@@ -1,32 +1,43 @@
 #include <3ds.h>
+#include <cstring>
 #include <memory>
 
 #include "log.h"
+#include "storage.h"
+#include "utils.h"
 
 namespace Storage {
-    static FS_ArchiveResource GetResource(FS_SystemMediaType mediaType) {
-        Result ret = 0;
-        FS_ArchiveResource resource = {0};
+    // One FSUSER_GetArchiveResource per media type, free/used/total are all derived from the same cluster counts.
+    // Sizes and strings are only rebuilt when the counts differ from the ones info was last built from.
+    bool Refresh(StorageInfo &info) {
+        bool changed = false;
 
-        if (R_FAILED(ret = FSUSER_GetArchiveResource(std::addressof(resource), mediaType))) {
-            Log::Error("%s(%d) failed: 0x%x\n", __func__, mediaType, ret);
-            return resource;
-        }
+        for (int i = 0; i < 4; i++) {
+            Result ret = 0;
+            FS_ArchiveResource resource = {0};
 
-        return resource;
-    }
+            if (R_FAILED(ret = FSUSER_GetArchiveResource(std::addressof(resource), static_cast<FS_SystemMediaType>(i)))) {
+                std::memset(std::addressof(resource), 0, sizeof(FS_ArchiveResource));
+            }
 
-    u64 GetFreeStorage(FS_SystemMediaType mediaType) {
-        FS_ArchiveResource resource = Storage::GetResource(mediaType);
-        return ((static_cast<u64>(resource.freeClusters) * static_cast<u64>(resource.clusterSize)));
-    }
+            if ((info.totalSizeString[i][0] != '\0') && (std::memcmp(std::addressof(resource), std::addressof(info.resource[i]), sizeof(FS_ArchiveResource)) == 0)) {
+                continue;
+            }
 
-    u64 GetTotalStorage(FS_SystemMediaType mediaType) {
-        FS_ArchiveResource resource = Storage::GetResource(mediaType);
-        return ((static_cast<u64>(resource.totalClusters) * static_cast<u64>(resource.clusterSize)));
-    }
+            if (R_FAILED(ret)) {
+                Log::Error("%s(%d) failed: 0x%x\n", __func__, i, ret);
+            }
+
+            u64 freeSize = static_cast<u64>(resource.freeClusters) * static_cast<u64>(resource.clusterSize);
+            info.resource[i] = resource;
+            info.totalSize[i] = static_cast<u64>(resource.totalClusters) * static_cast<u64>(resource.clusterSize);
+            info.usedSize[i] = info.totalSize[i] - freeSize;
+            Utils::GetSizeString(info.freeSizeString[i], freeSize);
+            Utils::GetSizeString(info.usedSizeString[i], info.usedSize[i]);
+            Utils::GetSizeString(info.totalSizeString[i], info.totalSize[i]);
+            changed = true;
+        }
 
-    u64 GetUsedStorage(FS_SystemMediaType mediaType) {
-        return Storage::GetTotalStorage(mediaType) - Storage::GetFreeStorage(mediaType);
+        return changed;
     }
 }
@@ -5,9 +5,11 @@
 #include "fs.h"
 #include "log.h"
 #include "system.h"
+#include "trace.h"
 
 namespace System {
     const char *GetModel(void) {
+        TRACE_SCOPE("System::GetModel");
         Result ret = 0;
         const char *models[] = {
             "OLD 3DS - CTR",
@@ -28,6 +30,7 @@ namespace System {
     }
 
     const char *GetRegion(void) {
+        TRACE_SCOPE("System::GetRegion");
         Result ret = 0;
         const char *regions[] = {
             "JPN",
@@ -49,6 +52,7 @@ namespace System {
     }
 
     const char *GetFirmRegion(void) {
+        TRACE_SCOPE("System::GetFirmRegion");
         Result ret = 0;
         const char *regions[] = {
             "J",
@@ -70,6 +74,7 @@ namespace System {
     }
 
     bool IsCoppacsSupported(void) {
+        TRACE_SCOPE("System::IsCoppacsSupported");
         Result ret = 0;
         u8 isCoppacs = 0;
 
@@ -82,6 +87,7 @@ namespace System {
     }
 
     const char *GetLanguage(void) {
+        TRACE_SCOPE("System::GetLanguage");
         Result ret = 0;
         const char *languages[] = {
             "Japanese",
@@ -108,6 +114,7 @@ namespace System {
     }
 
     const char *GetMacAddress(void) {
+        TRACE_SCOPE("System::GetMacAddress");
         u8 *addr = OS_SharedConfig->wifi_macaddr;
         static char macAddress[0x12];
         std::snprintf(macAddress, 0x12, "%02X:%02X:%02X:%02X:%02X:%02X", *addr, *(addr + 1), *(addr + 2), *(addr + 3), *(addr + 4), *(addr + 5));
@@ -115,6 +122,7 @@ namespace System {
     }
 
     const char *GetRunningHW(void) {
+        TRACE_SCOPE("System::GetRunningHW");
         const char *runningHW[] = {
             "unknown",
             "product",
@@ -132,10 +140,12 @@ namespace System {
     }
 
     const char *IsDebugUnit(void) {
+        TRACE_SCOPE("System::IsDebugUnit");
         return OS_KernelConfig->unit_info? "" : "(Debug Unit)";
     }
 
     u64 GetLocalFriendCodeSeed(void) {
+        TRACE_SCOPE("System::GetLocalFriendCodeSeed");
         Result ret = 0;
         u64 seed = 0;
 
@@ -148,6 +158,7 @@ namespace System {
     }
 
     const char *GetNandLocalFriendCodeSeed(void) {
+        TRACE_SCOPE("System::GetNandLocalFriendCodeSeed");
         Result ret = 0;
         Handle handle;
         u32 bytesread = 0;
@@ -193,6 +204,7 @@ namespace System {
     }
     
     u8 *GetSerialNumber(void) {
+        TRACE_SCOPE("System::GetSerialNumber");
         Result ret = 0;
         static u8 serial[15];
         
@@ -205,6 +217,7 @@ namespace System {
     }
     
     int GetCheckDigit(const u8* serialNumber) {
+        TRACE_SCOPE("System::GetCheckDigit");
         int oddSum = 0, evenSum = 0, index = 1;
         
         for (int i = 0; serialNumber[i] != '\0'; i++) {
@@ -227,6 +240,7 @@ namespace System {
     }
 
     u64 GetSoapId(void) {
+        TRACE_SCOPE("System::GetSoapId");
         Result ret = 0;
         u32 id = 0;
 
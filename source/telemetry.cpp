@@ -0,0 +1,307 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "net.h"
+#include "telemetry.h"
+
+// Push side of fleet collection. Samples are appended to a datagram in memory that goes out with a single send() on a
+// connected UDP socket once it holds config.batch samples, or once its first sample is flushInterval old. Every
+// datagram takes the next sequence number whether or not its send() succeeds, so the collector sees a loss on either
+// end as a gap. Nothing is retransmitted, and the socket is non-blocking so a full send buffer drops a datagram rather
+// than stalling the sampling thread.
+
+namespace Telemetry {
+    static int telemetrySocket = -1;
+    static TelemetryConfig telemetryConfig;
+    static u8 telemetryDatagram[maxDatagram];
+    static u32 telemetryCount = 0;
+    static u32 telemetrySequence = 0;
+    static u64 telemetryOpened = 0;
+    static u64 telemetryBatchStart = 0;
+    static TelemetryStats telemetryStats;
+
+    // Copy of telemetryStats for GetStats(), refreshed after every send.
+    static LightLock telemetryLock;
+    static bool telemetryLockReady = false;
+    static TelemetryStats telemetrySharedStats;
+
+    static Thread telemetryThread = nullptr;
+    static char telemetryHost[64];
+    static LightEvent telemetryStopEvent;
+    static std::atomic<bool> telemetryCancel;
+
+    // Frame times recorded by the UI thread while a session is open, taken and reset by every sample.
+    static std::atomic<bool> telemetryFrames;
+    static std::atomic<u32> frameCount, frameTotal, frameMax;
+
+    static void InitLock(void) {
+        if (!telemetryLockReady) {
+            LightLock_Init(std::addressof(telemetryLock));
+            telemetryLockReady = true;
+        }
+    }
+
+    static void PublishStats(void) {
+        Telemetry::InitLock();
+        LightLock_Lock(std::addressof(telemetryLock));
+        telemetrySharedStats = telemetryStats;
+        LightLock_Unlock(std::addressof(telemetryLock));
+    }
+
+    static u32 GetFreeMiB(const StorageInfo &info, FS_SystemMediaType media) {
+        return static_cast<u32>((info.totalSize[media] - info.usedSize[media]) >> 20);
+    }
+
+    void GetDefaultConfig(TelemetryConfig &config) {
+        config.host = "";
+        config.port = defaultPort;
+        config.period = 1000;
+        config.batch = maxSamples;
+        config.flushInterval = 10000;
+    }
+
+    void MakeSample(TelemetrySample &sample, const LiveInfo &info, u32 time) {
+        std::memset(std::addressof(sample), 0, sizeof(TelemetrySample));
+        sample.time = time;
+        sample.valid = static_cast<u16>(info.valid);
+        sample.flags = (info.batteryCharging? TELEMETRY_FLAG_CHARGING : 0) | (info.adapterConnected? TELEMETRY_FLAG_ADAPTER : 0) |
+            (info.sdInserted? TELEMETRY_FLAG_SD_INSERTED : 0);
+        sample.batteryPercentage = info.batteryPercentage;
+        sample.batteryVoltage = info.batteryVoltage;
+        sample.batteryTemperature = info.batteryTemperature;
+        sample.wifiStrength = info.wifiStrength;
+
+        if (info.valid & BIT(SAMPLER_FIELD_STORAGE)) {
+            sample.sdFree = Telemetry::GetFreeMiB(info.storage, SYSTEM_MEDIATYPE_SD);
+            sample.nandFree = Telemetry::GetFreeMiB(info.storage, SYSTEM_MEDIATYPE_CTR_NAND);
+        }
+    }
+
+    // Called by the UI loop once per frame with the time since the previous one.
+    void RecordFrame(u64 ticks) {
+        if (!telemetryFrames.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        u32 time = static_cast<u32>(std::min(static_cast<double>(ticks) / CPU_TICKS_PER_USEC, 65535.0));
+        u32 max = frameMax.load(std::memory_order_relaxed);
+        frameTotal.fetch_add(time, std::memory_order_relaxed);
+        frameCount.fetch_add(1, std::memory_order_relaxed);
+
+        while ((time > max) && (!frameMax.compare_exchange_weak(max, time, std::memory_order_relaxed))) {
+        }
+    }
+
+    // The three counters aren't taken together, a frame recorded in between lands in the next sample's max or average.
+    static void TakeFrames(TelemetrySample &sample) {
+        u32 count = frameCount.exchange(0, std::memory_order_relaxed);
+        u32 total = frameTotal.exchange(0, std::memory_order_relaxed);
+        u32 max = frameMax.exchange(0, std::memory_order_relaxed);
+
+        if (count) {
+            sample.frameTimeAvg = static_cast<u16>(std::min<u32>(total / count, 0xFFFF));
+            sample.frameTimeMax = static_cast<u16>(max);
+        }
+    }
+
+    Result Open(const TelemetryConfig &config) {
+        struct sockaddr_in address;
+        Result ret = 0;
+
+        Telemetry::Close();
+
+        if ((config.batch == 0) || (config.batch > maxSamples) || (config.period == 0)) {
+            return -EINVAL;
+        }
+
+        if (R_FAILED(ret = Net::Resolve(config.host, config.port, address))) {
+            return ret;
+        }
+
+        if ((telemetrySocket = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+            Log::Error("%s(socket) failed: %d\n", __func__, errno);
+            return -errno;
+        }
+
+        // A connected socket takes send() and gets the ICMP errors of a collector that isn't listening.
+        if ((fcntl(telemetrySocket, F_SETFL, fcntl(telemetrySocket, F_GETFL, 0) | O_NONBLOCK) != 0) ||
+            (connect(telemetrySocket, reinterpret_cast<struct sockaddr *>(std::addressof(address)), sizeof(address)) != 0)) {
+            ret = -errno;
+            Log::Error("%s(connect) failed: %d\n", __func__, -ret);
+            close(telemetrySocket);
+            telemetrySocket = -1;
+            return ret;
+        }
+
+        telemetryConfig = config;
+        telemetryConfig.host = nullptr;
+        telemetryCount = 0;
+        telemetrySequence = 0;
+        telemetryOpened = osGetTime();
+        std::memset(std::addressof(telemetryStats), 0, sizeof(TelemetryStats));
+        telemetryStats.session = static_cast<u32>(svcGetSystemTick()) ^ static_cast<u32>(telemetryOpened * 2654435761ULL);
+        Telemetry::PublishStats();
+
+        frameCount.store(0, std::memory_order_relaxed);
+        frameTotal.store(0, std::memory_order_relaxed);
+        frameMax.store(0, std::memory_order_relaxed);
+        telemetryFrames.store(true, std::memory_order_relaxed);
+        return 0;
+    }
+
+    // Appends a sample and sends the datagram once it is full. Partly filled ones are sent by Flush().
+    Result Add(const TelemetrySample &sample) {
+        if (telemetrySocket < 0) {
+            return -ENOTCONN;
+        }
+
+        if (telemetryCount == 0) {
+            telemetryBatchStart = osGetTime();
+        }
+
+        std::memcpy(telemetryDatagram + sizeof(TelemetryHeader) + (telemetryCount * sizeof(TelemetrySample)), std::addressof(sample), sizeof(TelemetrySample));
+        telemetryCount++;
+        telemetryStats.samples++;
+        return telemetryCount >= telemetryConfig.batch? Telemetry::Flush() : 0;
+    }
+
+    Result Flush(void) {
+        Result ret = 0;
+
+        if ((telemetrySocket < 0) || (telemetryCount == 0)) {
+            return 0;
+        }
+
+        TelemetryHeader header = { magic, version, static_cast<u16>(telemetryCount), telemetryStats.session, telemetrySequence++ };
+        u32 length = sizeof(TelemetryHeader) + (telemetryCount * sizeof(TelemetrySample));
+        std::memcpy(telemetryDatagram, std::addressof(header), sizeof(TelemetryHeader));
+        telemetryCount = 0;
+        telemetryStats.datagrams++;
+
+        if (send(telemetrySocket, telemetryDatagram, length, Net::sendFlags) == static_cast<ssize_t>(length)) {
+            telemetryStats.bytes += length;
+        }
+        else {
+            ret = -errno;
+
+            // Only the first of a run of failures is logged, a collector that went away fails every send.
+            if (telemetryStats.result != ret) {
+                Log::Error("%s(send) failed: %d\n", __func__, -ret);
+            }
+
+            telemetryStats.errors++;
+        }
+
+        telemetryStats.result = ret;
+        Telemetry::PublishStats();
+        return ret;
+    }
+
+    // Sends what is left of the current datagram.
+    void Close(void) {
+        if (telemetrySocket < 0) {
+            return;
+        }
+
+        Telemetry::Flush();
+        telemetryFrames.store(false, std::memory_order_relaxed);
+        close(telemetrySocket);
+        telemetrySocket = -1;
+    }
+
+    // Wakes for whichever comes first, the next sample or the age limit of the datagram being filled.
+    static void Worker(void *arg) {
+        static LiveInfo info;
+        TelemetrySample sample;
+        u64 next = osGetTime();
+
+        while (!telemetryCancel.load(std::memory_order_relaxed)) {
+            u64 now = osGetTime();
+
+            if (now >= next) {
+                Sampler::Read(info);
+                Telemetry::MakeSample(sample, info, static_cast<u32>(now - telemetryOpened));
+                Telemetry::TakeFrames(sample);
+                Telemetry::Add(sample);
+                next = std::max(next + telemetryConfig.period, now);
+            }
+
+            u64 flush = telemetryBatchStart + telemetryConfig.flushInterval;
+
+            if (telemetryCount && (now >= flush)) {
+                Telemetry::Flush();
+            }
+
+            u64 wake = telemetryCount? std::min(next, flush) : next;
+            u64 current = osGetTime();
+            LightEvent_WaitTimeout(std::addressof(telemetryStopEvent), wake > current? (wake - current) * 1000000ULL : 0);
+        }
+    }
+
+    // Opens the socket on the calling thread so a bad address is reported here, then samples on a thread below its
+    // priority. The host name is copied, config.host needn't outlive the session.
+    bool Start(const TelemetryConfig &config) {
+        TelemetryConfig copy = config;
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        Telemetry::Stop();
+        std::snprintf(telemetryHost, sizeof(telemetryHost), "%s", config.host? config.host : "");
+        copy.host = telemetryHost;
+
+        if (R_FAILED(ret = Telemetry::Open(copy))) {
+            telemetryStats.result = ret;
+            Telemetry::PublishStats();
+            return false;
+        }
+
+        telemetryCancel.store(false, std::memory_order_relaxed);
+        LightEvent_Init(std::addressof(telemetryStopEvent), RESET_ONESHOT);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(telemetryThread = threadCreate(Telemetry::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            Telemetry::Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Returns straight away, the samples of the unfinished datagram are sent.
+    void Stop(void) {
+        if (!telemetryThread) {
+            return;
+        }
+
+        telemetryCancel.store(true, std::memory_order_relaxed);
+        LightEvent_Signal(std::addressof(telemetryStopEvent));
+        threadJoin(telemetryThread, U64_MAX);
+        threadFree(telemetryThread);
+        telemetryThread = nullptr;
+        Telemetry::Close();
+    }
+
+    bool IsRunning(void) {
+        return telemetryThread != nullptr;
+    }
+
+    void GetStats(TelemetryStats &stats) {
+        Telemetry::InitLock();
+        LightLock_Lock(std::addressof(telemetryLock));
+        stats = telemetrySharedStats;
+        LightLock_Unlock(std::addressof(telemetryLock));
+    }
+}
@@ -0,0 +1,229 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "log.h"
+#include "tickets.h"
+#include "writer.h"
+
+namespace Tickets {
+    // AM_GetTicketList pages are copied through the IPC buffer, 256 IDs keeps each call at 2 KiB.
+    static const u32 ticketPageSize = 256;
+
+    static Thread ticketThread = nullptr;
+    static std::atomic<bool> ticketRunning;
+    static Result ticketResult = 0;
+    static TicketJoinCounts ticketCounts;
+    static u64 *ticketIds = nullptr, *ticketTitles = nullptr, *ticketOrphans = nullptr, *ticketMissing = nullptr;
+
+    // Both lists sorted ascending and free of duplicates. One pass over each, every step retires the smaller ID:
+    // a ticket behind the title cursor has no title, a title behind the ticket cursor has no ticket. orphans and
+    // missing must hold ticketCount and titleCount entries. Returns the number of matches.
+    u32 Join(const u64 *tickets, u32 ticketCount, const u64 *titles, u32 titleCount, u64 *orphans, u64 *missing, TicketJoinCounts &counts) {
+        u32 i = 0, j = 0;
+
+        counts.tickets = ticketCount;
+        counts.titles = titleCount;
+        counts.matched = counts.orphanTickets = counts.missingTickets = 0;
+
+        while ((i < ticketCount) && (j < titleCount)) {
+            if (tickets[i] < titles[j]) {
+                orphans[counts.orphanTickets++] = tickets[i++];
+            }
+            else if (titles[j] < tickets[i]) {
+                missing[counts.missingTickets++] = titles[j++];
+            }
+            else {
+                counts.matched++;
+                i++;
+                j++;
+            }
+        }
+
+        while (i < ticketCount) {
+            orphans[counts.orphanTickets++] = tickets[i++];
+        }
+
+        while (j < titleCount) {
+            missing[counts.missingTickets++] = titles[j++];
+        }
+
+        return counts.matched;
+    }
+
+    static u32 SortUnique(u64 *ids, u32 count) {
+        std::sort(ids, ids + count);
+        return static_cast<u32>(std::unique(ids, ids + count) - ids);
+    }
+
+    static void Free(void) {
+        delete[] ticketIds;
+        delete[] ticketTitles;
+        delete[] ticketOrphans;
+        delete[] ticketMissing;
+        ticketIds = ticketTitles = ticketOrphans = ticketMissing = nullptr;
+    }
+
+    static Result ReadTickets(u32 &count) {
+        Result ret = 0;
+        u32 total = 0;
+
+        if (R_FAILED(ret = AM_GetTicketCount(std::addressof(total)))) {
+            Log::Error("%s(AM_GetTicketCount) failed: 0x%x\n", __func__, ret);
+            return ret;
+        }
+
+        ticketIds = new u64[total? total : 1];
+        count = 0;
+
+        // Tickets can be added or removed between pages, a short page ends the listing.
+        while (count < total) {
+            u32 read = 0, page = std::min(ticketPageSize, total - count);
+
+            if (R_FAILED(ret = AM_GetTicketList(std::addressof(read), page, count, ticketIds + count))) {
+                Log::Error("%s(AM_GetTicketList) failed: 0x%x\n", __func__, ret);
+                return ret;
+            }
+
+            count += std::min(read, page);
+
+            if (read < page) {
+                break;
+            }
+        }
+
+        return 0;
+    }
+
+    // Title IDs only, sizes and versions aren't needed for the join.
+    static Result ReadTitles(u32 &count) {
+        const FS_MediaType media[] = { MEDIATYPE_NAND, MEDIATYPE_SD };
+        Result ret = 0;
+        u32 counts[2] = { 0 }, total = 0;
+
+        for (u32 i = 0; i < 2; i++) {
+            if (R_FAILED(ret = AM_GetTitleCount(media[i], std::addressof(counts[i])))) {
+                Log::Error("%s(AM_GetTitleCount) failed: 0x%x\n", __func__, ret);
+                return ret;
+            }
+
+            total += counts[i];
+        }
+
+        ticketTitles = new u64[total? total : 1];
+        count = 0;
+
+        for (u32 i = 0; i < 2; i++) {
+            u32 read = 0;
+
+            if (R_FAILED(ret = AM_GetTitleList(std::addressof(read), media[i], counts[i], ticketTitles + count))) {
+                Log::Error("%s(AM_GetTitleList) failed: 0x%x\n", __func__, ret);
+                return ret;
+            }
+
+            count += std::min(read, counts[i]);
+        }
+
+        return 0;
+    }
+
+    static void Worker(void *arg) {
+        u32 tickets = 0, titles = 0;
+
+        // Service::Exit() closes AM once probing is done, the reference taken here keeps it open for the listing.
+        if (R_FAILED(ticketResult = amInit())) {
+            Log::Error("%s(amInit) failed: 0x%x\n", __func__, ticketResult);
+            ticketRunning.store(false, std::memory_order_release);
+            return;
+        }
+
+        if (R_SUCCEEDED(ticketResult = Tickets::ReadTickets(tickets)) && R_SUCCEEDED(ticketResult = Tickets::ReadTitles(titles))) {
+            tickets = Tickets::SortUnique(ticketIds, tickets);
+            titles = Tickets::SortUnique(ticketTitles, titles);
+            ticketOrphans = new u64[tickets? tickets : 1];
+            ticketMissing = new u64[titles? titles : 1];
+            Tickets::Join(ticketIds, tickets, ticketTitles, titles, ticketOrphans, ticketMissing, ticketCounts);
+        }
+
+        amExit();
+        ticketRunning.store(false, std::memory_order_release);
+    }
+
+    bool Start(void) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        Tickets::Stop();
+        Tickets::Free();
+        std::memset(std::addressof(ticketCounts), 0, sizeof(ticketCounts));
+        ticketResult = 0;
+        ticketRunning.store(true, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(ticketThread = threadCreate(Tickets::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            ticketRunning.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    // The listing itself can't be interrupted, this waits for it to finish.
+    void Stop(void) {
+        if (!ticketThread) {
+            return;
+        }
+
+        threadJoin(ticketThread, U64_MAX);
+        threadFree(ticketThread);
+        ticketThread = nullptr;
+    }
+
+    bool IsRunning(void) {
+        return ticketRunning.load(std::memory_order_acquire);
+    }
+
+    // The getters below are only valid once IsRunning() returns false.
+    Result GetResult(void) {
+        return ticketResult;
+    }
+
+    void GetCounts(TicketJoinCounts &counts) {
+        counts = ticketCounts;
+    }
+
+    const u64 *GetOrphans(void) {
+        return ticketOrphans;
+    }
+
+    const u64 *GetMissing(void) {
+        return ticketMissing;
+    }
+
+    Result Export(const char *path) {
+        static FileWriter writer;
+        Result ret = 0;
+
+        if (R_FAILED(ret = Writer::Open(writer, WRITER_BACKEND_FS, path))) {
+            return ret;
+        }
+
+        Writer::Printf(writer, "# tickets %lu, titles %lu, matched %lu\n", ticketCounts.tickets, ticketCounts.titles, ticketCounts.matched);
+        Writer::Printf(writer, "kind,id\n");
+
+        for (u32 i = 0; i < ticketCounts.orphanTickets; i++) {
+            Writer::Printf(writer, "orphan_ticket,%016llX\n", static_cast<unsigned long long>(ticketOrphans[i]));
+        }
+
+        for (u32 i = 0; i < ticketCounts.missingTickets; i++) {
+            Writer::Printf(writer, "missing_ticket,%016llX\n", static_cast<unsigned long long>(ticketMissing[i]));
+        }
+
+        return Writer::Close(writer);
+    }
+}
@@ -0,0 +1,223 @@
+#include <3ds.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "hardware.h"
+#include "log.h"
+#include "titles.h"
+
+namespace Titles {
+    // AM_GetTitleInfo round trips are the slow part, each one describes up to this many titles.
+    static const u32 titleInfoBatch = 64;
+    static const FS_MediaType titleMedia[] = { MEDIATYPE_NAND, MEDIATYPE_SD, MEDIATYPE_GAME_CARD };
+    static const char *titleSortNames[TITLE_SORT_MAX] = { "title ID", "size", "category", "version" };
+
+    static Thread titleThread = nullptr;
+    static TitleTable titleTable;
+    static std::atomic<bool> titleRunning, titleCancel;
+    static std::atomic<u32> titleDone;
+    static u32 titleTotal = 0;
+
+    static void Free(TitleTable &table) {
+        delete[] table.ids;
+        delete[] table.sizes;
+        delete[] table.versions;
+        delete[] table.categories;
+        delete[] table.media;
+        delete[] table.order;
+        std::memset(std::addressof(table), 0, sizeof(TitleTable));
+    }
+
+    static void Allocate(TitleTable &table, u32 capacity) {
+        table.ids = new u64[capacity];
+        table.sizes = new u64[capacity];
+        table.versions = new u16[capacity];
+        table.categories = new u16[capacity];
+        table.media = new u8[capacity];
+        table.order = new u32[capacity];
+    }
+
+    // Appends the titles of one media type. AM_GetTitleList has no offset, so the IDs come in one call straight into
+    // the ID column. Sizes and versions follow in titleInfoBatch sized AM_GetTitleInfo calls.
+    static void ReadMedia(TitleTable &table, FS_MediaType media, u32 expected) {
+        Result ret = 0;
+        u32 first = table.count, read = 0;
+
+        if (R_FAILED(ret = AM_GetTitleList(std::addressof(read), media, expected, table.ids + first))) {
+            Log::Error("%s(AM_GetTitleList) failed: 0x%x\n", __func__, ret);
+            table.mediaResults[media] = ret;
+            return;
+        }
+
+        read = std::min(read, expected);
+
+        for (u32 i = 0; (i < read) && !titleCancel.load(std::memory_order_relaxed); i += titleInfoBatch) {
+            AM_TitleEntry entries[titleInfoBatch];
+            u32 batch = std::min(titleInfoBatch, read - i);
+
+            if (R_FAILED(ret = AM_GetTitleInfo(media, batch, table.ids + first + i, entries))) {
+                Log::Error("%s(AM_GetTitleInfo) failed: 0x%x\n", __func__, ret);
+                std::memset(entries, 0, sizeof(entries));
+                table.errors += batch;
+            }
+
+            for (u32 j = 0; j < batch; j++) {
+                u32 index = first + i + j;
+                table.sizes[index] = entries[j].size;
+                table.versions[index] = entries[j].version;
+                table.categories[index] = static_cast<u16>(table.ids[index] >> 32);
+                table.media[index] = media;
+                table.order[index] = index;
+                table.mediaSizes[media] += entries[j].size;
+            }
+
+            table.count += batch;
+            table.mediaCounts[media] += batch;
+            titleDone.fetch_add(batch, std::memory_order_relaxed);
+        }
+    }
+
+    static void Worker(void *arg) {
+        Result ret = 0;
+        u32 counts[3] = { 0 }, total = 0;
+
+        // Service::Exit() closes AM once probing is done, the reference taken here keeps it open for the listing.
+        if (R_FAILED(ret = amInit())) {
+            Log::Error("%s(amInit) failed: 0x%x\n", __func__, ret);
+            titleTable.result = ret;
+            Titles::Allocate(titleTable, 1);
+            titleRunning.store(false, std::memory_order_release);
+            return;
+        }
+
+        for (u32 i = 0; i < 3; i++) {
+            // No game card inserted is the common case, not an error.
+            if ((titleMedia[i] == MEDIATYPE_GAME_CARD) && (!Hardware::GetCardSlotStatus())) {
+                continue;
+            }
+
+            if (R_FAILED(ret = AM_GetTitleCount(titleMedia[i], std::addressof(counts[i])))) {
+                Log::Error("%s(AM_GetTitleCount) failed: 0x%x\n", __func__, ret);
+                titleTable.mediaResults[titleMedia[i]] = ret;
+                counts[i] = 0;
+            }
+
+            total += counts[i];
+        }
+
+        titleTotal = total;
+        Titles::Allocate(titleTable, total? total : 1);
+
+        for (u32 i = 0; (i < 3) && !titleCancel.load(std::memory_order_relaxed); i++) {
+            if (counts[i]) {
+                Titles::ReadMedia(titleTable, titleMedia[i], counts[i]);
+            }
+        }
+
+        amExit();
+        Titles::Sort(TITLE_SORT_ID);
+        titleRunning.store(false, std::memory_order_release);
+    }
+
+    // Builds the table on a thread below the caller's priority, the UI reads it once IsRunning() returns false.
+    bool Start(void) {
+        Result ret = 0;
+        s32 priority = 0x30;
+
+        Titles::Stop();
+        Titles::Free(titleTable);
+        titleTotal = 0;
+        titleDone.store(0, std::memory_order_relaxed);
+        titleCancel.store(false, std::memory_order_relaxed);
+        titleRunning.store(true, std::memory_order_relaxed);
+
+        if (R_FAILED(ret = svcGetThreadPriority(std::addressof(priority), CUR_THREAD_HANDLE))) {
+            Log::Error("%s(svcGetThreadPriority) failed: 0x%x\n", __func__, ret);
+        }
+
+        if (!(titleThread = threadCreate(Titles::Worker, nullptr, 0x4000, priority < 0x3F? priority + 1 : priority, -2, false))) {
+            Log::Error("%s(threadCreate) failed\n", __func__);
+            titleRunning.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Stop(void) {
+        if (!titleThread) {
+            return;
+        }
+
+        titleCancel.store(true, std::memory_order_relaxed);
+        threadJoin(titleThread, U64_MAX);
+        threadFree(titleThread);
+        titleThread = nullptr;
+    }
+
+    bool IsRunning(void) {
+        return titleRunning.load(std::memory_order_acquire);
+    }
+
+    float GetProgress(void) {
+        return titleTotal? static_cast<float>(titleDone.load(std::memory_order_relaxed)) / titleTotal : 0.f;
+    }
+
+    // Only valid once IsRunning() returns false.
+    const TitleTable &GetTable(void) {
+        return titleTable;
+    }
+
+    // Sorts the permutation, not the rows. Ties fall back to the title ID so the order is stable between sorts.
+    void Sort(TitleSortKey key) {
+        const TitleTable &table = titleTable;
+        u32 *begin = table.order, *end = table.order + table.count;
+
+        switch (key) {
+            case TITLE_SORT_SIZE:
+                std::sort(begin, end, [&table](u32 a, u32 b) {
+                    return table.sizes[a] != table.sizes[b]? table.sizes[a] > table.sizes[b] : table.ids[a] < table.ids[b];
+                });
+                break;
+
+            case TITLE_SORT_CATEGORY:
+                std::sort(begin, end, [&table](u32 a, u32 b) {
+                    return table.categories[a] != table.categories[b]? table.categories[a] < table.categories[b] : table.ids[a] < table.ids[b];
+                });
+                break;
+
+            case TITLE_SORT_VERSION:
+                std::sort(begin, end, [&table](u32 a, u32 b) {
+                    return table.versions[a] != table.versions[b]? table.versions[a] > table.versions[b] : table.ids[a] < table.ids[b];
+                });
+                break;
+
+            default:
+                std::sort(begin, end, [&table](u32 a, u32 b) {
+                    return table.ids[a] < table.ids[b];
+                });
+                break;
+        }
+    }
+
+    const char *GetSortName(TitleSortKey key) {
+        return key < TITLE_SORT_MAX? titleSortNames[key] : "";
+    }
+
+    const char *GetMediaName(FS_MediaType media) {
+        switch (media) {
+            case MEDIATYPE_NAND:
+                return "NAND";
+
+            case MEDIATYPE_SD:
+                return "SD";
+
+            case MEDIATYPE_GAME_CARD:
+                return "Game card";
+
+            default:
+                return "unknown";
+        }
+    }
+}
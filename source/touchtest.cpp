@@ -0,0 +1,90 @@
+#include <cmath>
+#include <cstring>
+
+#include "touchtest.h"
+#include "writer.h"
+
+namespace TouchTest {
+    void Init(TouchInfo &info) {
+        std::memset(std::addressof(info), 0, sizeof(TouchInfo));
+    }
+
+    // Each press ends on the pen being lifted, the grid test takes the mean position of the press as its hit.
+    void Add(TouchInfo &info, const TouchSample &sample) {
+        if (sample.x == touchPenUp) {
+            if (info.gridRunning && info.penDown && info.pressSamples && (info.target < gridColumns * gridRows)) {
+                u16 x = 0, y = 0;
+                TouchTest::GetTarget(info.target, x, y);
+                info.errorX[info.target / gridColumns][info.target % gridColumns] = static_cast<s16>(static_cast<s32>(info.pressX / info.pressSamples) - x);
+                info.errorY[info.target / gridColumns][info.target % gridColumns] = static_cast<s16>(static_cast<s32>(info.pressY / info.pressSamples) - y);
+                info.target++;
+                info.gridRunning = info.target < gridColumns * gridRows;
+            }
+
+            info.penDown = false;
+            info.pressSamples = info.pressX = info.pressY = 0;
+            return;
+        }
+
+        u32 column = (sample.x < 320? sample.x : 319) / 8, row = (sample.y < 240? sample.y : 239) / 8;
+        info.coveredCells += info.coverage[row][column] == 0? 1 : 0;
+        info.coverage[row][column] += info.coverage[row][column] < 0xFFFF? 1 : 0;
+        info.samples++;
+        info.penDown = true;
+        info.pressSamples++;
+        info.pressX += sample.x;
+        info.pressY += sample.y;
+    }
+
+    void StartGrid(TouchInfo &info) {
+        info.gridRunning = true;
+        info.target = 0;
+        info.pressSamples = info.pressX = info.pressY = 0;
+        std::memset(info.errorX, 0, sizeof(info.errorX));
+        std::memset(info.errorY, 0, sizeof(info.errorY));
+    }
+
+    // Targets sit at the centre of each 64x60 grid cell.
+    void GetTarget(u32 index, u16 &x, u16 &y) {
+        x = 32 + ((index % gridColumns) * 64);
+        y = 30 + ((index / gridColumns) * 60);
+    }
+
+    // Cells no stroke has crossed yet. Only meaningful once the whole panel has been painted over.
+    u32 GetDeadCells(const TouchInfo &info) {
+        return (30 * 40) - info.coveredCells;
+    }
+
+    float GetError(const TouchInfo &info, u32 index) {
+        float x = info.errorX[index / gridColumns][index % gridColumns], y = info.errorY[index / gridColumns][index % gridColumns];
+        return std::sqrt((x * x) + (y * y));
+    }
+
+    Result Export(const TouchInfo &info, const char *path) {
+        static FileWriter writer;
+        Result ret = 0;
+
+        if (R_FAILED(ret = Writer::Open(writer, WRITER_BACKEND_FS, path))) {
+            return ret;
+        }
+
+        Writer::Printf(writer, "# samples %lu, cells touched %lu of 1200\n", info.samples, info.coveredCells);
+        Writer::Printf(writer, "kind,x,y,error_x,error_y\n");
+
+        for (u32 i = 0; i < info.target; i++) {
+            u16 x = 0, y = 0;
+            TouchTest::GetTarget(i, x, y);
+            Writer::Printf(writer, "target,%u,%u,%d,%d\n", x, y, info.errorX[i / gridColumns][i % gridColumns], info.errorY[i / gridColumns][i % gridColumns]);
+        }
+
+        for (u32 row = 0; row < 30; row++) {
+            for (u32 column = 0; column < 40; column++) {
+                if (!info.coverage[row][column]) {
+                    Writer::Printf(writer, "untouched,%lu,%lu,,\n", column * 8, row * 8);
+                }
+            }
+        }
+
+        return Writer::Close(writer);
+    }
+}
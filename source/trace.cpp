@@ -0,0 +1,66 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "trace.h"
+
+#if defined BUILD_TRACE
+namespace Trace {
+    typedef struct {
+        const char *name;
+        u64 begin;
+        u64 end;
+        u32 thread;
+    } Event;
+
+    // Must be a power of two, the oldest events are overwritten once the ring is full.
+    static const u32 traceCapacity = 4096;
+    static Event traceEvents[traceCapacity];
+    static std::atomic<u32> traceCount;
+    static u64 traceBase;
+
+    void Init(void) {
+        traceBase = svcGetSystemTick();
+        traceCount.store(0, std::memory_order_release);
+    }
+
+    void Record(const char *name, u64 begin, u64 end) {
+        u32 index = traceCount.fetch_add(1, std::memory_order_relaxed);
+        Event &event = traceEvents[index & (traceCapacity - 1)];
+        event.name = name;
+        event.begin = begin;
+        event.end = end;
+        // The TLS pointer is unique per thread and, unlike svcGetThreadId, doesn't need a syscall.
+        event.thread = static_cast<u32>(reinterpret_cast<uintptr_t>(getThreadLocalStorage()));
+    }
+
+    static double GetMicroseconds(u64 ticks) {
+        return static_cast<double>(ticks) / CPU_TICKS_PER_USEC;
+    }
+
+    bool Dump(const char *path) {
+        std::FILE *file = std::fopen(path, "w");
+        if (!file) {
+            return false;
+        }
+
+        static char buffer[0x4000];
+        std::setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+
+        u32 count = traceCount.load(std::memory_order_acquire);
+        u32 first = count > traceCapacity? count - traceCapacity : 0;
+
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%u},\"traceEvents\":[\n", static_cast<unsigned>(first));
+
+        for (u32 i = first; i < count; i++) {
+            const Event &event = traceEvents[i & (traceCapacity - 1)];
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", (i == first)? "" : ",\n",
+                event.name, static_cast<unsigned>(event.thread), Trace::GetMicroseconds(event.begin - traceBase),
+                Trace::GetMicroseconds(event.end - event.begin));
+        }
+
+        std::fputs("\n]}\n", file);
+        return std::fclose(file) == 0;
+    }
+}
+#endif
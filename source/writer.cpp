@@ -0,0 +1,185 @@
+#include <3ds.h>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fs.h"
+#include "log.h"
+#include "writer.h"
+
+namespace Writer {
+    Result Open(FileWriter &writer, WriterBackend backend, const char *path) {
+        Result ret = 0;
+
+        writer.backend = backend;
+        writer.handle = 0;
+        writer.fd = -1;
+        writer.offset = 0;
+        writer.length = 0;
+        writer.result = 0;
+
+        if (backend == WRITER_BACKEND_POSIX) {
+            if ((writer.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+                Log::Error("%s(open) failed: %s\n", __func__, path);
+                return writer.result = -1;
+            }
+
+            return 0;
+        }
+
+        if (R_FAILED(ret = FS::OpenArchive(std::addressof(writer.archive), ARCHIVE_SDMC))) {
+            Log::Error("%s(FS::OpenArchive) failed: 0x%x\n", __func__, ret);
+            return writer.result = ret;
+        }
+
+        if (R_FAILED(ret = FSUSER_OpenFile(std::addressof(writer.handle), writer.archive, fsMakePath(PATH_ASCII, path), FS_OPEN_WRITE | FS_OPEN_CREATE, 0))) {
+            Log::Error("%s(FSUSER_OpenFile) failed: 0x%x\n", __func__, ret);
+            FS::CloseArchive(writer.archive);
+            return writer.result = ret;
+        }
+
+        // Opening doesn't truncate, drop what a longer previous file left behind.
+        if (R_FAILED(ret = FSFILE_SetSize(writer.handle, 0))) {
+            Log::Error("%s(FSFILE_SetSize) failed: 0x%x\n", __func__, ret);
+            FSFILE_Close(writer.handle);
+            FS::CloseArchive(writer.archive);
+            return writer.result = ret;
+        }
+
+        return 0;
+    }
+
+    // Output that doesn't fit in capacity fails the writer, writer.offset is the size written once it is closed.
+    Result OpenMemory(FileWriter &writer, void *data, u32 capacity) {
+        writer.backend = WRITER_BACKEND_MEMORY;
+        writer.handle = 0;
+        writer.fd = -1;
+        writer.memory = static_cast<u8 *>(data);
+        writer.capacity = capacity;
+        writer.offset = 0;
+        writer.length = 0;
+        writer.result = 0;
+        return 0;
+    }
+
+    static void Flush(FileWriter &writer) {
+        if ((R_FAILED(writer.result)) || (writer.length == 0)) {
+            writer.length = 0;
+            return;
+        }
+
+        if (writer.backend == WRITER_BACKEND_MEMORY) {
+            if (writer.offset + writer.length > writer.capacity) {
+                Log::Error("%s: output exceeds 0x%lx bytes\n", __func__, writer.capacity);
+                writer.result = -1;
+                writer.length = 0;
+                return;
+            }
+
+            std::memcpy(writer.memory + writer.offset, writer.buffer, writer.length);
+        }
+        else if (writer.backend == WRITER_BACKEND_POSIX) {
+            for (u32 written = 0; written < writer.length;) {
+                ssize_t ret = write(writer.fd, writer.buffer + written, writer.length - written);
+
+                if (ret <= 0) {
+                    Log::Error("%s(write) failed\n", __func__);
+                    writer.result = -1;
+                    break;
+                }
+
+                written += ret;
+            }
+        }
+        else {
+            Result ret = 0;
+            u32 bytesWritten = 0;
+
+            if (R_FAILED(ret = FSFILE_Write(writer.handle, std::addressof(bytesWritten), writer.offset, writer.buffer, writer.length, 0))) {
+                Log::Error("%s(FSFILE_Write) failed: 0x%x\n", __func__, ret);
+                writer.result = ret;
+            }
+        }
+
+        writer.offset += writer.length;
+        writer.length = 0;
+    }
+
+    void Write(FileWriter &writer, const void *data, u32 size) {
+        const u8 *bytes = static_cast<const u8 *>(data);
+
+        while (size > 0) {
+            if (writer.length == sizeof(writer.buffer)) {
+                Writer::Flush(writer);
+            }
+
+            u32 chunk = sizeof(writer.buffer) - writer.length;
+            chunk = size < chunk? size : chunk;
+            std::memcpy(writer.buffer + writer.length, bytes, chunk);
+            writer.length += chunk;
+            bytes += chunk;
+            size -= chunk;
+        }
+    }
+
+    // Formats straight into the scratch buffer, flushing first if the output doesn't fit in what is left of it.
+    void Printf(FileWriter &writer, const char *format, ...) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            u32 available = sizeof(writer.buffer) - writer.length;
+            va_list args;
+            va_start(args, format);
+            int length = std::vsnprintf(reinterpret_cast<char *>(writer.buffer + writer.length), available, format, args);
+            va_end(args);
+
+            if (length < 0) {
+                return;
+            }
+
+            if (static_cast<u32>(length) < available) {
+                writer.length += length;
+                return;
+            }
+
+            // Longer than the whole buffer, keep what fit
+            if (writer.length == 0) {
+                writer.length = available - 1;
+                return;
+            }
+
+            Writer::Flush(writer);
+        }
+    }
+
+    Result Close(FileWriter &writer) {
+        Writer::Flush(writer);
+
+        if (writer.backend == WRITER_BACKEND_MEMORY) {
+            return writer.result;
+        }
+
+        if (writer.backend == WRITER_BACKEND_POSIX) {
+            if ((writer.fd >= 0) && (close(writer.fd) != 0) && (R_SUCCEEDED(writer.result))) {
+                writer.result = -1;
+            }
+
+            writer.fd = -1;
+            return writer.result;
+        }
+
+        if (writer.handle) {
+            Result ret = 0;
+
+            if (R_FAILED(ret = FSFILE_Close(writer.handle))) {
+                Log::Error("%s(FSFILE_Close) failed: 0x%x\n", __func__, ret);
+                writer.result = R_FAILED(writer.result)? writer.result : ret;
+            }
+
+            FS::CloseArchive(writer.archive);
+            writer.handle = 0;
+        }
+
+        return writer.result;
+    }
+}
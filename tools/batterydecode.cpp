@@ -0,0 +1,70 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include "batterylog.h"
+
+// Prints a battery recording pulled from a device as CSV.
+//   batterydecode <3dsident_battery.bin>
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <3dsident_battery.bin>\n", argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::fprintf(stderr, "%s: can't open\n", argv[1]);
+        return 1;
+    }
+
+    BatteryLogHeader header;
+
+    if ((std::fread(std::addressof(header), sizeof(header), 1, file) != 1) || (std::memcmp(header.magic, "3DSB", 4) != 0) || (header.version != 1)) {
+        std::fprintf(stderr, "%s: not a battery recording\n", argv[1]);
+        std::fclose(file);
+        return 1;
+    }
+
+    // The console clock has no time zone, so times are printed as they were on the console.
+    const u64 epochDelta = 2208988800ULL;
+    std::time_t start = static_cast<std::time_t>((header.startTime / 1000) - epochDelta);
+
+    static u8 data[0x10000];
+    static BatterySample samples[0x10000];
+    BatteryBlockHeader block;
+    u32 blocks = 0;
+
+    std::printf("time,elapsed_s,percentage,voltage_v,temperature_c,charging,adapter\n");
+
+    while (std::fread(std::addressof(block), sizeof(block), 1, file) == 1) {
+        if (std::fread(data, 1, block.length, file) != block.length) {
+            std::fprintf(stderr, "%s: truncated after %lu blocks\n", argv[1], static_cast<unsigned long>(blocks));
+            break;
+        }
+
+        u32 count = BatteryLog::DecodeBlock(data, block.length, 0, samples, block.count);
+
+        if (count != block.count) {
+            std::fprintf(stderr, "%s: block %lu holds %u of %u samples\n", argv[1], static_cast<unsigned long>(blocks), count, block.count);
+        }
+
+        for (u32 i = 0; i < count; i++) {
+            const BatterySample &sample = samples[i];
+            std::time_t time = start + sample.time;
+            char timestamp[32];
+            std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", std::gmtime(std::addressof(time)));
+
+            std::printf("%s,%lu,%u,%.3f,%u,%u,%u\n", timestamp, static_cast<unsigned long>(sample.time), sample.percentage,
+                5.0 * (static_cast<double>(sample.voltage) / 256.0), sample.temperature, (sample.flags & BATTERY_SAMPLE_CHARGING)? 1 : 0,
+                (sample.flags & BATTERY_SAMPLE_ADAPTER)? 1 : 0);
+        }
+
+        blocks++;
+    }
+
+    std::fclose(file);
+    return 0;
+}
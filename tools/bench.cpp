@@ -0,0 +1,342 @@
+#include <3ds.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "kernel.h"
+#include "logscanner.h"
+#include "system.h"
+#include "utils.h"
+
+// Host microbenchmarks for the pure helpers. Results are printed as JSON, one object per benchmark/input pair.
+//   bench [filter] [--min-time-ms N]
+
+static u64 benchAllocations = 0;
+
+void *operator new(size_t size) {
+    benchAllocations++;
+
+    if (void *ptr = std::malloc(size? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    benchAllocations++;
+
+    if (void *ptr = std::malloc(size? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept {
+    std::free(ptr);
+}
+
+namespace Bench {
+    static const char *filter = nullptr;
+    static double minTimeMs = 200.0;
+    static bool first = true;
+
+    template<typename T> static inline void DoNotOptimize(const T &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template<typename F> static void Run(const char *name, const char *input, u64 bytes, F &&fn) {
+        if (filter && !std::strstr(name, filter)) {
+            return;
+        }
+
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up, then grow the iteration count until a run lasts long enough to be measured reliably.
+        fn();
+
+        u64 iterations = 1;
+        double elapsedNs = 0.0;
+        u64 allocations = 0;
+
+        while (true) {
+            u64 allocationsBefore = benchAllocations;
+            auto start = Clock::now();
+
+            for (u64 i = 0; i < iterations; i++) {
+                fn();
+            }
+
+            elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            allocations = benchAllocations - allocationsBefore;
+
+            if ((elapsedNs >= minTimeMs * 1e6) || (iterations >= (1ULL << 40))) {
+                break;
+            }
+
+            double scale = elapsedNs > 0.0? (minTimeMs * 1e6 * 1.2) / elapsedNs : 10.0;
+            iterations = static_cast<u64>(static_cast<double>(iterations) * (scale < 10.0? (scale > 1.5? scale : 1.5) : 10.0)) + 1;
+        }
+
+        double nsPerOp = elapsedNs / static_cast<double>(iterations);
+        std::printf("%s    {\"name\": \"%s\", \"input\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f",
+            first? "" : ",\n", name, input, static_cast<unsigned long long>(iterations), nsPerOp,
+            static_cast<double>(allocations) / static_cast<double>(iterations));
+
+        if (bytes) {
+            std::printf(", \"mb_per_s\": %.2f", (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (nsPerOp / 1e9));
+        }
+
+        std::printf("}");
+        first = false;
+    }
+}
+
+// Shaped like the TWL NAND product.log, with the keys Kernel::GetInitalVersion looks for at the very end.
+static std::string MakeProductLog(size_t size) {
+    std::string log;
+    const char *line = "2014/03/14 12:34:56 cid:0123456789ABCDEF region:USA nand:0x3AF00000 status:ok\n";
+
+    while (log.size() + std::strlen(line) < size) {
+        log.append(line);
+    }
+
+    log.append("nup:11 cup:9.0.0 preInstall:1, nup:11\n");
+    return log;
+}
+
+static void BenchGetSizeString(void) {
+    char string[32];
+    const struct { const char *input; u64 size; } cases[] = {
+        { "512 B", 512ULL },
+        { "7.5 GiB", 8053063680ULL },
+        { "U64_MAX", U64_MAX }
+    };
+
+    for (const auto &c : cases) {
+        Bench::Run("Utils::GetSizeString", c.input, 0, [&]() {
+            Utils::GetSizeString(string, c.size);
+            Bench::DoNotOptimize(string);
+        });
+    }
+}
+
+static void BenchGetSubstring(void) {
+    const std::string small = MakeProductLog(512), large = MakeProductLog(64 * 1024);
+    const std::string missing(64 * 1024, 'x');
+    std::string partial;
+
+    // Adversarial: every position starts a partial match of "cup:".
+    while (partial.size() < 64 * 1024) {
+        partial.append("cu");
+    }
+
+    const struct { const char *input; const std::string &log; } cases[] = {
+        { "product.log 512 B", small },
+        { "product.log 64 KiB", large },
+        { "no match 64 KiB", missing },
+        { "partial matches 64 KiB", partial }
+    };
+
+    for (const auto &c : cases) {
+        Bench::Run("Utils::GetSubstring", c.input, c.log.size(), [&]() {
+            std::string value = Utils::GetSubstring(c.log, "cup:", " preInstall:");
+            Bench::DoNotOptimize(value);
+        });
+    }
+
+    // The call sites pass the raw file buffer, which copies it into a temporary std::string first.
+    Bench::Run("Utils::GetSubstring", "product.log 64 KiB from char *", large.size(), [&]() {
+        std::string value = Utils::GetSubstring(large.c_str(), "cup:", " preInstall:");
+        Bench::DoNotOptimize(value);
+    });
+}
+
+static void BenchLogScanner(void) {
+    const std::string small = MakeProductLog(512), large = MakeProductLog(1024 * 1024);
+    std::string partial;
+
+    while (partial.size() < 1024 * 1024) {
+        partial.append("cu");
+    }
+
+    const struct { const char *input; const std::string &log; } cases[] = {
+        { "product.log 512 B", small },
+        { "product.log 1 MiB", large },
+        { "partial matches 1 MiB", partial }
+    };
+
+    for (const auto &c : cases) {
+        hostFileData = c.log.data();
+        hostFileSize = c.log.size();
+
+        // The previous implementation read the whole file into a new[] buffer and ran GetSubstring three times.
+        Bench::Run("Kernel::GetInitalVersion", c.input, c.log.size(), []() {
+            const char *version = Kernel::GetInitalVersion();
+            Bench::DoNotOptimize(version);
+        });
+
+        Bench::Run("LogScanner::Feed", c.input, c.log.size(), [&]() {
+            LogScanner::Field fields[] = {
+                { "cup:", { " preInstall:", "," } },
+                { "nup:", { " cup:", nullptr } }
+            };
+
+            LogScanner::Reset(fields, 2);
+            LogScanner::Feed(fields, 2, c.log.data(), c.log.size());
+            Bench::DoNotOptimize(fields[0].length[0]);
+        });
+    }
+
+    hostFileData = nullptr;
+    hostFileSize = 0;
+}
+
+static void BenchGraph(void) {
+    static GraphSeries series;
+    std::vector<float> history(1 << 20);
+
+    for (size_t i = 0; i < history.size(); i++) {
+        history[i] = 3.7f + 0.5f * static_cast<float>((i * 2654435761u) & 0xFF) / 255.f;
+    }
+
+    Graph::Init(series, 400, 1, 3.2f, 4.4f);
+    float value = 3.7f;
+
+    Bench::Run("Graph::Push", "400 columns", 0, [&]() {
+        Graph::Push(series, value);
+        value = value > 4.2f? 3.3f : value + 0.01f;
+    });
+
+    // Decimating a long history has to reproduce the extremes of every column it folds together.
+    Graph::Init(series, 400, 1, 3.2f, 4.4f);
+    Graph::Load(series, history.data(), history.size());
+
+    for (u32 i = 0; i < series.count; i++) {
+        const GraphColumn &column = Graph::GetColumn(series, i);
+        float min = 10.f, max = 0.f;
+
+        for (u32 j = i * series.samplesPerColumn; (j < (i + 1) * series.samplesPerColumn) && (j < history.size()); j++) {
+            min = history[j] < min? history[j] : min;
+            max = history[j] > max? history[j] : max;
+        }
+
+        if ((column.min != min) || (column.max != max)) {
+            std::fprintf(stderr, "Graph::Load: column %u is [%f, %f], expected [%f, %f]\n", i, column.min, column.max, min, max);
+            std::exit(1);
+        }
+    }
+
+    const struct { const char *input; u32 count; } cases[] = {
+        { "4096 samples", 4096 },
+        { "1M samples", static_cast<u32>(history.size()) }
+    };
+
+    for (const auto &c : cases) {
+        Bench::Run("Graph::Load", c.input, c.count * sizeof(float), [&]() {
+            Graph::Init(series, 400, 1, 3.2f, 4.4f);
+            Graph::Load(series, history.data(), c.count);
+            Bench::DoNotOptimize(series.columns[0]);
+        });
+    }
+}
+
+static void BenchUTF16ToUTF8(void) {
+    std::vector<u16> username = { 'N', 'i', 'n', 't', 'e', 'n', 'd', 'o', '3', 0 };
+    std::vector<u16> ascii(4096, 'a'), cjk(4096, 0x4E16), surrogates;
+    ascii.push_back(0);
+    cjk.push_back(0);
+
+    for (int i = 0; i < 2048; i++) {
+        surrogates.push_back(0xD83D);
+        surrogates.push_back(0xDE00);
+    }
+
+    surrogates.push_back(0);
+
+    const struct { const char *input; const std::vector<u16> &data; } cases[] = {
+        { "username 9 units", username },
+        { "ASCII 4096 units", ascii },
+        { "CJK 4096 units", cjk },
+        { "surrogate pairs 4096 units", surrogates }
+    };
+
+    std::vector<u8> out;
+
+    for (const auto &c : cases) {
+        size_t length = c.data.size() * 3;
+        out.assign(length + 1, 0);
+
+        Bench::Run("Utils::UTF16ToUTF8", c.input, (c.data.size() - 1) * sizeof(u16), [&]() {
+            Utils::UTF16ToUTF8(out.data(), c.data.data(), length);
+            Bench::DoNotOptimize(out[0]);
+        });
+    }
+}
+
+static void BenchGetCheckDigit(void) {
+    const u8 *serial = reinterpret_cast<const u8 *>("CW123456789");
+    std::string digits(4096, '7');
+
+    Bench::Run("System::GetCheckDigit", "serial 11 chars", 0, [&]() {
+        int digit = System::GetCheckDigit(serial);
+        Bench::DoNotOptimize(digit);
+    });
+
+    Bench::Run("System::GetCheckDigit", "digits 4096 chars", digits.size(), [&]() {
+        int digit = System::GetCheckDigit(reinterpret_cast<const u8 *>(digits.c_str()));
+        Bench::DoNotOptimize(digit);
+    });
+}
+
+static void BenchCid(void) {
+    Bench::Run("Kernel::GetSdmcCid", "16 bytes", 0, []() {
+        const char *cid = Kernel::GetSdmcCid();
+        Bench::DoNotOptimize(cid);
+    });
+
+    Bench::Run("Kernel::GetNandCid", "16 bytes", 0, []() {
+        const char *cid = Kernel::GetNandCid();
+        Bench::DoNotOptimize(cid);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if ((std::strcmp(argv[i], "--min-time-ms") == 0) && (i + 1 < argc)) {
+            Bench::minTimeMs = std::atof(argv[++i]);
+        }
+        else {
+            Bench::filter = argv[i];
+        }
+    }
+
+    std::printf("{\n  \"benchmarks\": [\n");
+    BenchGetSizeString();
+    BenchGetSubstring();
+    BenchLogScanner();
+    BenchGraph();
+    BenchUTF16ToUTF8();
+    BenchGetCheckDigit();
+    BenchCid();
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
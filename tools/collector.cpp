@@ -0,0 +1,265 @@
+#include <3ds.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <tuple>
+#include <unistd.h>
+
+#include "telemetry.h"
+
+// Reference collector for the Tools page telemetry push, Linux only. One socket takes the datagrams of any number of
+// consoles in batches of recvmmsg(), every sample becomes a CSV row in a fully buffered file, and each sender session
+// keeps its own sequence accounting: gaps count as lost, and a datagram that turns up after a gap was counted is moved
+// back from lost to late. Runs until interrupted or for --seconds, then prints the counts. The kernel's count of
+// datagrams dropped for want of receive buffer is reported too, raise --rcvbuf (and net.core.rmem_max) if it grows.
+//   collector [--port N] [--bind address] [--output telemetry.csv] [--rcvbuf bytes] [--seconds N]
+
+typedef std::chrono::steady_clock Clock;
+typedef std::tuple<u32, u16, u32> StreamKey;    // Source address, source port, session
+
+typedef struct {
+    u32 next;               // Sequence expected next
+    u64 seen;               // Bit n set when next - 1 - n has arrived
+    u64 datagrams;
+    u64 samples;
+    u64 lost;
+    u64 late;
+    u64 duplicates;
+} Stream;
+
+static const unsigned collectorBatch = 64;
+static const size_t collectorOutputBuffer = 4 * 1024 * 1024;
+static volatile std::sig_atomic_t collecting = 1;
+
+static void HandleSignal(int signal) {
+    collecting = 0;
+}
+
+// Updates the stream's counts for one datagram, false when it is a duplicate and its samples were already written.
+static bool Account(Stream &stream, u32 sequence) {
+    if (stream.datagrams == 0) {
+        stream.next = sequence;
+    }
+
+    if (sequence >= stream.next) {
+        u32 gap = sequence - stream.next;
+        stream.lost += gap;
+        stream.seen = gap >= 63? 1 : ((stream.seen << (gap + 1)) | 1);
+        stream.next = sequence + 1;
+        stream.datagrams++;
+        return true;
+    }
+
+    u32 age = stream.next - 1 - sequence;
+
+    if ((age < 64) && (stream.seen & (1ULL << age))) {
+        stream.duplicates++;
+        return false;
+    }
+
+    // Too old for the window to tell a duplicate from a straggler, those are counted as late.
+    if (age < 64) {
+        stream.seen |= 1ULL << age;
+    }
+
+    stream.lost -= stream.lost? 1 : 0;
+    stream.late++;
+    stream.datagrams++;
+    return true;
+}
+
+static void WriteSamples(FILE *output, const char *source, const TelemetryHeader &header, const TelemetrySample *samples, u64 received) {
+    for (u32 i = 0; i < header.count; i++) {
+        const TelemetrySample &sample = samples[i];
+        std::fprintf(output, "%llu,%s,%08x,%u,%u,%x,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", static_cast<unsigned long long>(received), source, header.session,
+            header.sequence, sample.time, sample.valid, sample.flags, sample.batteryPercentage, (sample.batteryVoltage * 5000) / 256,
+            sample.batteryTemperature, sample.wifiStrength, sample.frameTimeAvg, sample.frameTimeMax, sample.sdFree, sample.nandFree);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    sockaddr_in address;
+    const char *path = "telemetry.csv";
+    int receiveBuffer = 4 * 1024 * 1024, enable = 1;
+    unsigned seconds = 0;
+
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(Telemetry::defaultPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if ((argc % 2) != 1) {
+        std::fprintf(stderr, "usage: %s [--port N] [--bind address] [--output telemetry.csv] [--rcvbuf bytes] [--seconds N]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) {
+            address.sin_port = htons(static_cast<u16>(std::strtoul(argv[i + 1], nullptr, 0)));
+        }
+        else if ((std::strcmp(argv[i], "--bind") == 0) && (inet_pton(AF_INET, argv[i + 1], &address.sin_addr) == 1)) {
+            continue;
+        }
+        else if (std::strcmp(argv[i], "--output") == 0) {
+            path = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--rcvbuf") == 0) {
+            receiveBuffer = std::atoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::strtoul(argv[i + 1], nullptr, 0);
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option or bad address\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0) {
+        std::perror("socket");
+        return 1;
+    }
+
+    // The kernel caps SO_RCVBUF at net.core.rmem_max, SO_RCVBUFFORCE gets past that when running as root.
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &receiveBuffer, sizeof(receiveBuffer)) != 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+
+    if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        std::perror("bind");
+        close(fd);
+        return 1;
+    }
+
+    FILE *output = std::fopen(path, "w");
+
+    if (!output) {
+        std::perror(path);
+        close(fd);
+        return 1;
+    }
+
+    static char outputBuffer[collectorOutputBuffer];
+    std::setvbuf(output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    std::fprintf(output, "received_ms,source,session,sequence,time_ms,valid,flags,battery_percent,battery_mv,temperature_c,wifi,frame_avg_us,"
+        "frame_max_us,sd_free_mib,nand_free_mib\n");
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    socklen_t length = sizeof(receiveBuffer);
+    getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, &length);
+    std::printf("collecting on %s:%u into %s, %d byte receive buffer\n", inet_ntoa(address.sin_addr), ntohs(address.sin_port), path, receiveBuffer);
+    std::fflush(stdout);
+
+    // One extra byte per buffer so a datagram longer than the format allows shows up as one, rather than truncated.
+    static u8 buffers[collectorBatch][Telemetry::maxDatagram + 1];
+    static sockaddr_in peers[collectorBatch];
+    static char controls[collectorBatch][CMSG_SPACE(sizeof(u32))];
+    mmsghdr messages[collectorBatch];
+    iovec vectors[collectorBatch];
+
+    std::map<StreamKey, Stream> streams;
+    u64 datagrams = 0, samples = 0, malformed = 0, calls = 0;
+    u32 kernelDrops = 0;
+    Clock::time_point start = Clock::now(), deadline = start + std::chrono::seconds(seconds);
+
+    while (collecting && ((seconds == 0) || (Clock::now() < deadline))) {
+        pollfd pfd = { fd, POLLIN, 0 };
+
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < collectorBatch; i++) {
+            vectors[i] = { buffers[i], sizeof(buffers[i]) };
+            std::memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_name = &peers[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_control = controls[i];
+            messages[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+        }
+
+        int count = recvmmsg(fd, messages, collectorBatch, MSG_DONTWAIT, nullptr);
+
+        if (count < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                std::perror("recvmmsg");
+                break;
+            }
+
+            continue;
+        }
+
+        u64 received = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        calls++;
+
+        for (int i = 0; i < count; i++) {
+            const msghdr &message = messages[i].msg_hdr;
+            const u8 *data = buffers[i];
+            u32 size = messages[i].msg_len;
+            TelemetryHeader header;
+
+            for (cmsghdr *control = CMSG_FIRSTHDR(&message); control; control = CMSG_NXTHDR(const_cast<msghdr *>(&message), control)) {
+                if ((control->cmsg_level == SOL_SOCKET) && (control->cmsg_type == SO_RXQ_OVFL)) {
+                    std::memcpy(&kernelDrops, CMSG_DATA(control), sizeof(kernelDrops));
+                }
+            }
+
+            if (size >= sizeof(TelemetryHeader)) {
+                std::memcpy(&header, data, sizeof(TelemetryHeader));
+            }
+
+            if ((size < sizeof(TelemetryHeader)) || (header.magic != Telemetry::magic) || (header.version != Telemetry::version) ||
+                (header.count > Telemetry::maxSamples) || (size != sizeof(TelemetryHeader) + (header.count * sizeof(TelemetrySample)))) {
+                malformed++;
+                continue;
+            }
+
+            Stream &stream = streams[StreamKey(peers[i].sin_addr.s_addr, peers[i].sin_port, header.session)];
+            datagrams++;
+
+            if (Account(stream, header.sequence)) {
+                static TelemetrySample batch[Telemetry::maxSamples];
+                char source[24];
+                std::snprintf(source, sizeof(source), "%s:%u", inet_ntoa(peers[i].sin_addr), ntohs(peers[i].sin_port));
+                std::memcpy(batch, data + sizeof(TelemetryHeader), header.count * sizeof(TelemetrySample));
+                WriteSamples(output, source, header, batch, received);
+                stream.samples += header.count;
+                samples += header.count;
+            }
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::fclose(output);
+    close(fd);
+
+    u64 lost = 0;
+
+    for (const auto &[key, stream] : streams) {
+        in_addr source = { std::get<0>(key) };
+        lost += stream.lost;
+        std::printf("%s:%u session %08x: %llu datagrams, %llu samples, %llu lost, %llu late, %llu duplicates\n", inet_ntoa(source), ntohs(std::get<1>(key)),
+            std::get<2>(key), static_cast<unsigned long long>(stream.datagrams), static_cast<unsigned long long>(stream.samples),
+            static_cast<unsigned long long>(stream.lost), static_cast<unsigned long long>(stream.late), static_cast<unsigned long long>(stream.duplicates));
+    }
+
+    std::printf("%llu datagrams (%.0f/s, %.1f per recvmmsg), %llu samples, %llu lost, %llu malformed, %u dropped by the kernel\n",
+        static_cast<unsigned long long>(datagrams), elapsed > 0.0? datagrams / elapsed : 0.0, calls? static_cast<double>(datagrams) / calls : 0.0,
+        static_cast<unsigned long long>(samples), static_cast<unsigned long long>(lost), static_cast<unsigned long long>(malformed), kernelDrops);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "diskbench.h"
+
+// Runs the SD card benchmark engine against a scratch file on the host, so numbers from a card reader can be
+// compared with what the console measures.
+//   diskbench <scratch file> [--size MiB] [--block KiB] [--random-ops N] [--depth N]
+
+struct Thread_tag {
+    std::thread thread;
+};
+
+// Real threads in place of the stand-ins in stub.cpp, so requests are in flight at the queue depth asked for.
+Thread threadCreate(ThreadFunc entrypoint, void *arg, size_t stack_size, int prio, int core_id, bool detached) {
+    return new Thread_tag { std::thread(entrypoint, arg) };
+}
+
+Result threadJoin(Thread thread, u64 timeout_ns) {
+    thread->thread.join();
+    return 0;
+}
+
+void threadFree(Thread thread) {
+    delete thread;
+}
+
+int main(int argc, char *argv[]) {
+    DiskBenchConfig config;
+    DiskBench::GetDefaultConfig(config);
+    config.backend = WRITER_BACKEND_POSIX;
+
+    if ((argc < 2) || ((argc % 2) != 0)) {
+        std::fprintf(stderr, "usage: %s <scratch file> [--size MiB] [--block KiB] [--random-ops N] [--depth N]\n", argv[0]);
+        return 1;
+    }
+
+    config.path = argv[1];
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        u32 value = std::strtoul(argv[i + 1], nullptr, 0);
+
+        if (std::strcmp(argv[i], "--size") == 0) {
+            config.fileSize = value * 1024 * 1024;
+        }
+        else if (std::strcmp(argv[i], "--block") == 0) {
+            config.blockSize = value * 1024;
+        }
+        else if (std::strcmp(argv[i], "--random-ops") == 0) {
+            config.randomOps = value;
+        }
+        else if (std::strcmp(argv[i], "--depth") == 0) {
+            config.queueDepth = value;
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option\n", argv[i]);
+            return 1;
+        }
+    }
+
+    static DiskBenchResult results[DISK_TEST_MAX];
+    Result ret = DiskBench::Run(config, results);
+    u32 depth = std::clamp<u32>(config.queueDepth, 1, DiskBench::maxQueueDepth);
+    bool shallow = false;
+
+    std::printf("%-17s %10s %10s %6s %10s %10s %10s %10s\n", "test", "MB/s", "IOPS", "depth", "p50 us", "p90 us", "p99 us", "max us");
+
+    for (int i = 0; i < DISK_TEST_MAX; i++) {
+        const DiskBenchResult &result = results[i];
+
+        if (result.ops == 0) {
+            continue;
+        }
+
+        std::printf("%-17s %10.2f %10.0f %6lu %10lu %10lu %10lu %10lu\n", DiskBench::GetTestName(static_cast<DiskTest>(i)), result.mbPerSecond,
+            result.iops, static_cast<unsigned long>(result.queueDepth), static_cast<unsigned long>(result.latency50),
+            static_cast<unsigned long>(result.latency90), static_cast<unsigned long>(result.latency99), static_cast<unsigned long>(result.latencyMax));
+        shallow |= result.queueDepth < depth;
+    }
+
+    if (R_FAILED(ret)) {
+        std::fprintf(stderr, "benchmark failed: 0x%lx\n", static_cast<unsigned long>(ret));
+        return 1;
+    }
+
+    if (shallow) {
+        std::fprintf(stderr, "queue depth %lu not reached, workers couldn't be started\n", static_cast<unsigned long>(depth));
+        return 1;
+    }
+
+    return 0;
+}
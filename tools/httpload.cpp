@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// Load generator for httpserve or a console running the HTTP server. Keeps a number of keep-alive connections each
+// with one GET in flight for a fixed time, then reports requests per second and latency percentiles.
+//   httpload <address> [--port N] [--connections N] [--seconds N] [--path /live]
+
+typedef std::chrono::steady_clock Clock;
+
+typedef struct {
+    int fd;
+    Clock::time_point sent;
+    std::string response;
+} Client;
+
+static sockaddr_in serverAddress;
+static std::string request;
+
+static bool Connect(Client &client) {
+    if ((client.fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+        return false;
+    }
+
+    if (connect(client.fd, reinterpret_cast<const sockaddr *>(&serverAddress), sizeof(serverAddress)) != 0) {
+        close(client.fd);
+        client.fd = -1;
+        return false;
+    }
+
+    fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL, 0) | O_NONBLOCK);
+    client.response.clear();
+    client.sent = Clock::now();
+    return send(client.fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size());
+}
+
+// Size of the complete response at the front of the buffer, 0 while it is still arriving.
+static size_t GetResponseSize(const std::string &response, int &status) {
+    size_t end = response.find("\r\n\r\n"), length = response.find("Content-Length: ");
+
+    if ((end == std::string::npos) || (length == std::string::npos) || (length > end)) {
+        return 0;
+    }
+
+    status = std::atoi(response.c_str() + 9);
+    size_t size = end + 4 + std::strtoul(response.c_str() + length + 16, nullptr, 10);
+    return response.size() >= size? size : 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned port = 8080, connections = 8, seconds = 5;
+    std::string path = "/live";
+
+    if ((argc < 2) || ((argc % 2) != 0) || (inet_pton(AF_INET, argv[1], &serverAddress.sin_addr) != 1)) {
+        std::fprintf(stderr, "usage: %s <address> [--port N] [--connections N] [--seconds N] [--path /live]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) {
+            port = std::strtoul(argv[i + 1], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--connections") == 0) {
+            connections = std::max(1UL, std::strtoul(argv[i + 1], nullptr, 0));
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::strtoul(argv[i + 1], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--path") == 0) {
+            path = argv[i + 1];
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option\n", argv[i]);
+            return 1;
+        }
+    }
+
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(port);
+    request = "GET " + path + " HTTP/1.1\r\nHost: " + argv[1] + "\r\nUser-Agent: httpload\r\n\r\n";
+
+    std::vector<Client> clients(connections);
+    std::vector<pollfd> fds(connections);
+    std::vector<double> latencies;
+    unsigned long failures = 0, reconnects = 0, errors = 0;
+    unsigned long long bytes = 0;
+    char buffer[65536];
+
+    for (Client &client : clients) {
+        if (!Connect(client)) {
+            std::fprintf(stderr, "can't connect: %s\n", std::strerror(errno));
+            return 1;
+        }
+    }
+
+    Clock::time_point start = Clock::now(), deadline = start + std::chrono::seconds(seconds);
+
+    while (Clock::now() < deadline) {
+        for (size_t i = 0; i < clients.size(); i++) {
+            fds[i] = { clients[i].fd, POLLIN, 0 };
+        }
+
+        if (poll(fds.data(), fds.size(), 100) < 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < clients.size(); i++) {
+            Client &client = clients[i];
+            ssize_t received = 0;
+
+            if (!fds[i].revents) {
+                continue;
+            }
+
+            while ((received = recv(client.fd, buffer, sizeof(buffer), 0)) > 0) {
+                client.response.append(buffer, received);
+                bytes += received;
+            }
+
+            int status = 0;
+            size_t size = GetResponseSize(client.response, status);
+
+            if (size) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - client.sent).count());
+                errors += status != 200;
+                client.response.erase(0, size);
+                client.sent = Clock::now();
+
+                if (send(client.fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+                    continue;
+                }
+            }
+            else if ((received < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                continue;
+            }
+
+            // Closed by the server, or a send that failed: start over on a new connection.
+            close(client.fd);
+            failures += size == 0;
+            reconnects++;
+
+            if (!Connect(client)) {
+                std::fprintf(stderr, "can't reconnect: %s\n", std::strerror(errno));
+                return 1;
+            }
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (Client &client : clients) {
+        close(client.fd);
+    }
+
+    if (latencies.empty()) {
+        std::fprintf(stderr, "no responses\n");
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    size_t count = latencies.size();
+    std::printf("%zu requests in %.2f s over %u connections: %.0f requests/s, %.2f MB/s\n", count, elapsed, connections, count / elapsed,
+        bytes / elapsed / (1024.0 * 1024.0));
+    std::printf("latency p50 %.0f, p90 %.0f, p99 %.0f, max %.0f us\n", latencies[count / 2], latencies[(count * 90) / 100],
+        latencies[(count * 99) / 100], latencies[count - 1]);
+    std::printf("%lu non-200 responses, %lu reconnects, %lu dropped mid-response\n", errors, reconnects, failures);
+    return (errors || failures)? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#include <3ds.h>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "httpserver.h"
+#include "snapshot.h"
+
+// Runs the app's HTTP server loop on the host, serving a snapshot cache pulled from a device (or a made-up report with
+// every page filled in) and made-up live values republished every second, so it can be load-tested over loopback with
+// httpload.
+//   httpserve [--snapshot 3dsident_cache.bin] [--port N]
+
+static volatile std::sig_atomic_t serving = 1;
+
+static void HandleSignal(int signal) {
+    serving = 0;
+}
+
+// Values of the length a New 3DS XL reports, so /report.json is as large as the one served from a real snapshot.
+static u32 MakeResults(ProbeResults &results) {
+    static u8 serial[] = "CJF123456789";
+    const char *securityModes[3] = { "WPA2-PSK (AES)", "WPA-PSK (TKIP)", "Open" };
+
+    results.kernelInfo = { "2.57.0-0", "2.57.0-0", "11.17.0-50E", "9.0.0-20E", "0123456789abcdef0123456789abcdef",
+        "fedcba9876543210fedcba9876543210", 0x123456789ULL };
+    results.systemInfo = { "New 3DS XL", "Retail", "EUR", "English", 0x0123456789ABCDEFULL, "0123456789ABCDEF", "40:F4:07:12:34:56",
+        serial, 7, 0x0004000000123456ULL };
+    results.nnidInfo = { 0x80000123, 0x0123456789ABCDEFULL, "example_account", "United Kingdom", 0x12345678, "0123456789abcdef" };
+    results.configInfo = { "Example User", "12/03", "1.7", "1234", "parent@example.com", "example answer" };
+    results.hardwareInfo = { "IPS", "TN", "Stereo" };
+
+    for (int i = 0; i < 3; i++) {
+        results.wifiInfo.slot[i] = true;
+        std::snprintf(results.wifiInfo.ssid[i], sizeof(results.wifiInfo.ssid[i]), "Example network %d", i + 1);
+        std::snprintf(results.wifiInfo.passphrase[i], sizeof(results.wifiInfo.passphrase[i]), "example passphrase %d", i + 1);
+        std::snprintf(results.wifiInfo.securityMode[i], sizeof(results.wifiInfo.securityMode[i]), "%s", securityModes[i]);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        u64 total = 32000000000ULL >> i, used = total / 3;
+        results.storageInfo.resource[i] = { 512, 32768, static_cast<u32>(total / 32768), static_cast<u32>((total - used) / 32768) };
+        results.storageInfo.totalSize[i] = total;
+        results.storageInfo.usedSize[i] = used;
+        std::snprintf(results.storageInfo.totalSizeString[i], sizeof(results.storageInfo.totalSizeString[i]), "%.2f GB", total / 1e9);
+        std::snprintf(results.storageInfo.usedSizeString[i], sizeof(results.storageInfo.usedSizeString[i]), "%.2f GB", used / 1e9);
+        std::snprintf(results.storageInfo.freeSizeString[i], sizeof(results.storageInfo.freeSizeString[i]), "%.2f GB", (total - used) / 1e9);
+    }
+
+    results.miscInfo = { 187, 62, 412, "2015/01/15 10:42:05" };
+    results.systemStateInfo = { 0x02, 0x01, 0x03, 0x01, 0x02, 0x94, 0x60, 0x00, 0x00, 0x02, 0x01, 0xFF, 0x00, 0x80, 0x40, 0x20, 0x00, 0x10, 0x00 };
+    return BIT(PROBE_MAX) - 1;
+}
+
+int main(int argc, char *argv[]) {
+    static ProbeResults results;
+    static LiveInfo live;
+    u16 port = HttpServer::defaultPort;
+    u32 mask = 0;
+
+    if ((argc % 2) != 1) {
+        std::fprintf(stderr, "usage: %s [--snapshot 3dsident_cache.bin] [--port N]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) {
+            port = static_cast<u16>(std::strtoul(argv[i + 1], nullptr, 0));
+        }
+        else if ((std::strcmp(argv[i], "--snapshot") == 0) && ((mask = Snapshot::Load(argv[i + 1], results)) != 0)) {
+            continue;
+        }
+        else {
+            std::fprintf(stderr, "%s %s: unknown option or not a valid snapshot\n", argv[i], argv[i + 1]);
+            return 1;
+        }
+    }
+
+    if (R_FAILED(HttpServer::Open(port))) {
+        std::fprintf(stderr, "can't listen on port %u\n", port);
+        return 1;
+    }
+
+    if (!mask) {
+        mask = MakeResults(results);
+    }
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::printf("serving /report.json and /live on port %u\n", port);
+    std::fflush(stdout);
+
+    HttpServer::Publish(results, mask, false);
+    std::snprintf(live.hostname, sizeof(live.hostname), "127.0.0.1");
+    live.valid = BIT(SAMPLER_FIELD_BATTERY_PERCENTAGE) | BIT(SAMPLER_FIELD_BATTERY_VOLTAGE) | BIT(SAMPLER_FIELD_WIFI_STRENGTH) | BIT(SAMPLER_FIELD_HOSTNAME);
+    u64 next = 0;
+
+    while (serving) {
+        if (svcGetSystemTick() >= next) {
+            next = svcGetSystemTick() + SYSCLOCK_ARM11;
+            live.batteryPercentage = 100 - (live.batteryPercentage + 1) % 100;
+            live.batteryVoltage = 200 + (live.batteryPercentage % 20);
+            live.wifiStrength = live.batteryPercentage % 4;
+            HttpServer::PublishLive(live);
+        }
+
+        HttpServer::Poll(100);
+    }
+
+    HttpServerStats stats;
+    HttpServer::GetStats(stats);
+    HttpServer::Close();
+    std::printf("%lu connections, %lu requests, %lu errors, %llu bytes sent\n", static_cast<unsigned long>(stats.accepted),
+        static_cast<unsigned long>(stats.requests), static_cast<unsigned long>(stats.errors), static_cast<unsigned long long>(stats.bytes));
+    return 0;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+// Minimal stand-in for the libctru header, so the platform independent parts of 3DSident can be built and
+// measured on a Linux host. Only what those sources need is declared here.
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <sys/types.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef s32 Result;
+typedef u32 Handle;
+
+#define U64_MAX UINT64_MAX
+#define BIT(n) (1U << (n))
+#define R_SUCCEEDED(res) ((res) >= 0)
+#define R_FAILED(res) ((res) < 0)
+
+#define SYSCLOCK_ARM11 268111856
+#define CPU_TICKS_PER_MSEC (SYSCLOCK_ARM11 / 1000.0)
+#define CPU_TICKS_PER_USEC (SYSCLOCK_ARM11 / 1000000.0)
+
+// The ARM11 tick counter, emulated with the host monotonic clock.
+static inline u64 svcGetSystemTick(void) {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<u64>(ts.tv_sec) * SYSCLOCK_ARM11) + ((static_cast<u64>(ts.tv_nsec) * SYSCLOCK_ARM11) / 1000000000ULL);
+}
+
+static inline void *getThreadLocalStorage(void) {
+    static thread_local int storage;
+    return &storage;
+}
+
+// Threads and synchronization
+#define CUR_THREAD_HANDLE 0xFFFF8000
+
+typedef void (*ThreadFunc)(void *);
+typedef struct Thread_tag *Thread;
+
+typedef enum {
+    RESET_ONESHOT = 0,
+    RESET_STICKY = 1,
+    RESET_PULSE = 2
+} ResetType;
+
+typedef s32 LightLock;
+
+typedef struct {
+    s32 state;
+    LightLock lock;
+} LightEvent;
+
+Result svcGetThreadPriority(s32 *out, Handle handle);
+Thread threadCreate(ThreadFunc entrypoint, void *arg, size_t stack_size, int prio, int core_id, bool detached);
+Result threadJoin(Thread thread, u64 timeout_ns);
+void threadFree(Thread thread);
+void LightLock_Init(LightLock *lock);
+void LightLock_Lock(LightLock *lock);
+void LightLock_Unlock(LightLock *lock);
+void LightEvent_Init(LightEvent *event, ResetType reset_type);
+void LightEvent_Signal(LightEvent *event);
+int LightEvent_WaitTimeout(LightEvent *event, s64 timeout_in_ns);
+
+// Kernel and system version
+#define GET_VERSION_MAJOR(version) ((version) >> 24)
+#define GET_VERSION_MINOR(version) (((version) >> 16) & 0xFF)
+#define GET_VERSION_REVISION(version) (((version) >> 8) & 0xFF)
+
+typedef struct {
+    u8 build;
+    u8 minor;
+    u8 mainver;
+    u8 reserved_x3;
+    char region;
+    u8 reserved_x5[0x3];
+} OS_VersionBin;
+
+typedef struct {
+    u32 datetime_selector;
+    u32 running_hw;
+    u8 mcu_hwinfo;
+    u8 unk_x09[0x57];
+    u8 wifi_macaddr[6];
+    u8 wifi_strength;
+    u8 network_state;
+} osSharedConfig_s;
+
+typedef struct {
+    u32 unit_info;
+} osKernelConfig_s;
+
+extern osSharedConfig_s hostSharedConfig;
+extern osKernelConfig_s hostKernelConfig;
+#define OS_SharedConfig (&hostSharedConfig)
+#define OS_KernelConfig (&hostKernelConfig)
+
+// FSUSER_OpenFileDirectly opens this in-memory file (any path) when set, so file parsers can be measured.
+extern const char *hostFileData;
+extern u64 hostFileSize;
+
+u64 osGetTime(void);
+u32 osGetKernelVersion(void);
+Result osGetSystemVersionDataString(OS_VersionBin *nver, OS_VersionBin *cver, char *sysverstr, u32 sysverstr_maxsize);
+ssize_t utf16_to_utf8(u8 *out, const u16 *in, size_t len);
+
+// APT
+Result APT_CheckNew3DS(bool *out);
+
+// FS
+typedef u64 FS_Archive;
+
+typedef enum {
+    PATH_INVALID = 0,
+    PATH_EMPTY = 1,
+    PATH_BINARY = 2,
+    PATH_ASCII = 3,
+    PATH_UTF16 = 4
+} FS_PathType;
+
+typedef struct {
+    FS_PathType type;
+    u32 size;
+    const void *data;
+} FS_Path;
+
+typedef enum {
+    ARCHIVE_SDMC = 0x00000009,
+    ARCHIVE_NAND_CTR_FS = 0x1234567D,
+    ARCHIVE_NAND_TWL_FS = 0x1234567E
+} FS_ArchiveID;
+
+typedef enum {
+    MEDIATYPE_NAND = 0,
+    MEDIATYPE_SD = 1,
+    MEDIATYPE_GAME_CARD = 2
+} FS_MediaType;
+
+typedef enum {
+    SYSTEM_MEDIATYPE_CTR_NAND = 0,
+    SYSTEM_MEDIATYPE_TWL_NAND = 1,
+    SYSTEM_MEDIATYPE_SD = 2,
+    SYSTEM_MEDIATYPE_TWL_PHOTO = 3
+} FS_SystemMediaType;
+
+typedef struct {
+    u32 sectorSize;
+    u32 clusterSize;
+    u32 totalClusters;
+    u32 freeClusters;
+} FS_ArchiveResource;
+
+typedef enum {
+    AC_OPEN = 0,
+    AC_WEP_40BIT,
+    AC_WEP_104BIT,
+    AC_WEP_128BIT,
+    AC_WPA_TKIP,
+    AC_WPA2_TKIP,
+    AC_WPA_AES,
+    AC_WPA2_AES
+} acSecurityMode;
+
+enum {
+    FS_OPEN_READ = BIT(0),
+    FS_OPEN_WRITE = BIT(1),
+    FS_OPEN_CREATE = BIT(2)
+};
+
+enum {
+    FS_WRITE_FLUSH = BIT(0)
+};
+
+FS_Path fsMakePath(FS_PathType type, const void *path);
+Result FSUSER_OpenArchive(FS_Archive *archive, FS_ArchiveID id, FS_Path path);
+Result FSUSER_CloseArchive(FS_Archive archive);
+Result FSUSER_OpenFile(Handle *out, FS_Archive archive, FS_Path path, u32 openFlags, u32 attributes);
+Result FSUSER_OpenFileDirectly(Handle *out, FS_ArchiveID archiveId, FS_Path archivePath, FS_Path filePath, u32 openFlags, u32 attributes);
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 fileSize);
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path);
+Result FSUSER_GetSdmcCid(u8 *out, u32 length);
+Result FSUSER_GetNandCid(u8 *out, u32 length);
+Result FSFILE_Read(Handle handle, u32 *bytesRead, u64 offset, void *buffer, u32 size);
+Result FSFILE_Write(Handle handle, u32 *bytesWritten, u64 offset, const void *buffer, u32 size, u32 flags);
+Result FSFILE_GetSize(Handle handle, u64 *size);
+Result FSFILE_SetSize(Handle handle, u64 size);
+Result FSFILE_Close(Handle handle);
+Result FSFILE_Flush(Handle handle);
+
+// AM
+Result amInit(void);
+void amExit(void);
+Result AM_GetDeviceId(u32 *deviceID);
+Result AM_GetTitleCount(FS_MediaType mediatype, u32 *count);
+Result AM_GetTitleList(u32 *titlesRead, FS_MediaType mediatype, u32 titleCount, u64 *titleIds);
+Result AM_GetTicketCount(u32 *count);
+Result AM_GetTicketList(u32 *ticketsRead, u32 ticketCount, u32 skip, u64 *ticketIds);
+
+// CFG
+Result CFGU_GetSystemModel(u8 *model);
+Result CFGU_SecureInfoGetRegion(u8 *region);
+Result CFGU_GetRegionCanadaUSA(u8 *value);
+Result CFGU_GetSystemLanguage(u8 *language);
+Result CFGI_GetLocalFriendCodeSeed(u64 *seed);
+Result CFGI_SecureInfoGetSerialNumber(u8 *serial);
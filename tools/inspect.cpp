@@ -0,0 +1,25 @@
+#include <3ds.h>
+#include <cstdio>
+
+#include "snapshot.h"
+
+// Prints the fields stored in a snapshot cache pulled from a device (sdmc:/3ds/3dsident_cache.bin).
+//   inspect <path>
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <3dsident_cache.bin>\n", argv[0]);
+        return 1;
+    }
+
+    static ProbeResults results;
+    u32 mask = Snapshot::Load(argv[1], results);
+
+    if (!mask) {
+        std::fprintf(stderr, "%s: not a valid snapshot\n", argv[1]);
+        return 1;
+    }
+
+    Snapshot::Print(stdout, results, mask);
+    return 0;
+}
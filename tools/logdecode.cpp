@@ -0,0 +1,57 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "log.h"
+
+// Prints a binary 3dsident.log (written by trace builds) in the same layout as the text log.
+//   logdecode <3dsident.log> [min level 0-4]
+
+int main(int argc, char *argv[]) {
+    const char *levelNames[LOG_LEVEL_MAX] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+
+    if ((argc < 2) || (argc > 3)) {
+        std::fprintf(stderr, "usage: %s <3dsident.log> [min level 0-4]\n", argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::fprintf(stderr, "%s: can't open\n", argv[1]);
+        return 1;
+    }
+
+    int minLevel = argc == 3? std::atoi(argv[2]) : 0;
+    LogFileHeader header;
+
+    if ((std::fread(std::addressof(header), sizeof(header), 1, file) != 1) || (std::memcmp(header.magic, "3DSL", 4) != 0) || (header.version != 1)) {
+        std::fprintf(stderr, "%s: not a binary log\n", argv[1]);
+        std::fclose(file);
+        return 1;
+    }
+
+    LogRecordHeader record;
+    char text[0x10000];
+    u32 count = 0;
+
+    while (std::fread(std::addressof(record), sizeof(record), 1, file) == 1) {
+        if ((record.level >= LOG_LEVEL_MAX) || (std::fread(text, 1, record.length, file) != record.length)) {
+            std::fprintf(stderr, "%s: truncated or corrupt after %lu records\n", argv[1], static_cast<unsigned long>(count));
+            break;
+        }
+
+        count++;
+
+        if (record.level < minLevel) {
+            continue;
+        }
+
+        bool newline = (record.length == 0) || (text[record.length - 1] != '\n');
+        std::printf("[%11.6f] [%-5s] %.*s%s", static_cast<double>(record.tick - header.baseTick) / header.tickRate, levelNames[record.level],
+            static_cast<int>(record.length), text, newline? "\n" : "");
+    }
+
+    std::fclose(file);
+    return 0;
+}
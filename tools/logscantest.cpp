@@ -0,0 +1,129 @@
+#include <3ds.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "logscanner.h"
+
+// Checks LogScanner against multi-MB synthetic logs, with the interesting part of each one split at every possible
+// offset: two Feed() calls, ScanFile() with a 0x1000 byte chunk boundary in front of every byte, and the whole log one
+// byte at a time. Prints a line per case and exits non-zero if any scan disagrees with the expected values.
+//   logscantest
+
+typedef struct {
+    const char *name;
+    const char *region;             // Placed after the filler, at the end of the log when trailing is false
+    bool trailing;
+    LogScanner::Field fields[2];
+    u32 count;
+    const char *expected[2];        // nullptr when GetValue() should find nothing
+} ScanCase;
+
+static const size_t scanFillerSize = 2 * 1024 * 1024;
+static const u32 scanChunkSize = 0x1000;
+static u32 scanFailures = 0;
+
+// product.log lines full of partial matches of the keys, none of which complete.
+static std::string MakeFiller(size_t size) {
+    std::string log;
+    const char *line = "2014/03/14 12:34:56 cid:0123456789ABCDEF cu nu Comment region:USA nand:0x3AF00000 status:ok\n";
+
+    while (log.size() + std::strlen(line) < size) {
+        log.append(line);
+    }
+
+    return log;
+}
+
+static void Check(const ScanCase &c, LogScanner::Field *fields, const char *mode, size_t split) {
+    for (u32 i = 0; i < c.count; i++) {
+        const char *value = LogScanner::GetValue(fields[i]);
+
+        if ((value? !c.expected[i] || std::strcmp(value, c.expected[i]) != 0 : c.expected[i] != nullptr)) {
+            std::printf("FAIL %s: %s split at %zu, field %u got \"%s\" expected \"%s\"\n", c.name, mode, split, i, value? value : "(null)",
+                c.expected[i]? c.expected[i] : "(null)");
+            scanFailures++;
+        }
+    }
+}
+
+static u32 RunCase(const ScanCase &c, const std::string &filler) {
+    std::string log = filler + c.region + (c.trailing? filler : "");
+    size_t start = filler.size(), end = std::min(start + std::strlen(c.region) + 1, log.size());
+    LogScanner::Field fields[2];
+    u32 scans = 0, failures = scanFailures;
+
+    // Every split from just before the region to just after it, so each key, terminator and false start is cut
+    // everywhere it can be.
+    for (size_t split = start - 1; split <= end; split++, scans++) {
+        std::memcpy(fields, c.fields, sizeof(fields));
+        LogScanner::Reset(fields, c.count);
+
+        if (!LogScanner::Feed(fields, c.count, log.data(), static_cast<u32>(split))) {
+            LogScanner::Feed(fields, c.count, log.data() + split, static_cast<u32>(log.size() - split));
+        }
+
+        Check(c, fields, "Feed", split);
+    }
+
+    // ScanFile() reads fixed chunks from the start of the file, starting the file further into the filler moves the
+    // chunk boundaries across the region.
+    for (size_t split = start; split <= end; split++, scans++) {
+        size_t skip = split % scanChunkSize;
+        hostFileData = log.data() + skip;
+        hostFileSize = log.size() - skip;
+        std::memcpy(fields, c.fields, sizeof(fields));
+
+        if (R_FAILED(LogScanner::ScanFile(ARCHIVE_NAND_TWL_FS, "/sys/log/product.log", fields, c.count))) {
+            std::printf("FAIL %s: ScanFile failed\n", c.name);
+            scanFailures++;
+        }
+
+        Check(c, fields, "ScanFile", split);
+    }
+
+    hostFileData = nullptr;
+    hostFileSize = 0;
+
+    std::memcpy(fields, c.fields, sizeof(fields));
+    LogScanner::Reset(fields, c.count);
+
+    for (size_t i = 0; (i < log.size()) && (!LogScanner::Feed(fields, c.count, log.data() + i, 1)); i++) {
+    }
+
+    Check(c, fields, "bytewise", 0);
+    scans++;
+
+    std::printf("%s %s: %u scans of %zu bytes\n", scanFailures == failures? "ok  " : "FAIL", c.name, scans, log.size());
+    return scans;
+}
+
+int main(int argc, char *argv[]) {
+    const std::string filler = MakeFiller(scanFillerSize);
+    const ScanCase cases[] = {
+        { "match split across chunks", "nup:52 cup:11.17.0-50E preInstall:10, nup:52\n", true,
+            { { "cup:", { " preInstall:", "," } }, { "nup:", { " cup:", nullptr } } }, 2, { "11.17.0-50E", "52" } },
+        { "partial prefix false start", "cu cup cu:p cucupcup:9.0.0-20E pre preIn preInstall:1\nCommentUpdat CommentUpdated CommentUpdated=2014/06/12\n", true,
+            { { "cup:", { " preInstall:", "," } }, { "CommentUpdated=", { "\n", nullptr } } }, 2, { "9.0.0-20E pre preIn", "2014/06/12" } },
+        { "overlapping false start", "nunu nununup:7 cup:a->b--->\n", true,
+            { { "nunup:", { " ", nullptr } }, { "cup:", { "-->", nullptr } } }, 2, { "7", "a->b-" } },
+        { "missing terminator at EOF", "nup:52 cup:11.17.0-50E preInst", false,
+            { { "cup:", { " preInstall:", "," } }, { "CommentUpdated=", { "\n", nullptr } } }, 2, { nullptr, nullptr } },
+        { "missing terminator at EOF, fallback found", "nup:52 cup:11.17.0-50E,1 preInst", false,
+            { { "cup:", { " preInstall:", "," } }, { "nup:", { " cup:", nullptr } } }, 2, { "11.17.0-50E", "52" } },
+        { "fallback terminator", "nup:52 cup:11.17.0-50E,nup:52 preInsta", true,
+            { { "cup:", { " preInstall:", "," } }, { "nup:", { " cup:", nullptr } } }, 2, { "11.17.0-50E", "52" } },
+        { "terminator after fallback", "cup:1.0,x preInstall:2", true,
+            { { "cup:", { " preInstall:", "," } }, { "nup:", { " cup:", nullptr } } }, 2, { "1.0,x", nullptr } }
+    };
+
+    u32 scans = 0;
+
+    for (const auto &c : cases) {
+        scans += RunCase(c, filler);
+    }
+
+    std::printf("%u scans, %u failures\n", scans, scanFailures);
+    return scanFailures? 1 : 0;
+}
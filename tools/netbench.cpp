@@ -0,0 +1,74 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "netbench.h"
+
+// Runs the network test engine from the host against netserver, over loopback to check both ends or across the
+// LAN to get numbers to compare with what the console measures.
+//   netbench <host> [--port N] [--bytes MiB] [--buffer KiB] [--pings N] [--size bytes] [--interval ms]
+
+int main(int argc, char *argv[]) {
+    NetBenchConfig config;
+    NetBench::GetDefaultConfig(config);
+
+    if ((argc < 2) || ((argc % 2) != 0)) {
+        std::fprintf(stderr, "usage: %s <host> [--port N] [--bytes MiB] [--buffer KiB] [--pings N] [--size bytes] [--interval ms]\n", argv[0]);
+        return 1;
+    }
+
+    config.host = argv[1];
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        u32 value = std::strtoul(argv[i + 1], nullptr, 0);
+
+        if (std::strcmp(argv[i], "--port") == 0) {
+            config.port = static_cast<u16>(value);
+        }
+        else if (std::strcmp(argv[i], "--bytes") == 0) {
+            config.bytes = value * 1024 * 1024;
+        }
+        else if (std::strcmp(argv[i], "--buffer") == 0) {
+            config.bufferSize = value * 1024;
+        }
+        else if (std::strcmp(argv[i], "--pings") == 0) {
+            config.pings = value;
+        }
+        else if (std::strcmp(argv[i], "--size") == 0) {
+            config.pingSize = value;
+        }
+        else if (std::strcmp(argv[i], "--interval") == 0) {
+            config.pingInterval = value;
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option\n", argv[i]);
+            return 1;
+        }
+    }
+
+    static NetBenchResult results[NET_TEST_MAX];
+    Result ret = NetBench::Run(config, results);
+
+    for (int i = 0; i < NET_TEST_MAX; i++) {
+        const NetBenchResult &result = results[i];
+
+        if ((i == NET_TEST_UDP_PING) && result.sent) {
+            std::printf("%-13s %6lu/%-6lu %6.2f%% loss, rtt p50 %lu, p90 %lu, p99 %lu, max %lu us\n", NetBench::GetTestName(static_cast<NetTest>(i)),
+                static_cast<unsigned long>(result.received), static_cast<unsigned long>(result.sent), result.loss,
+                static_cast<unsigned long>(result.rtt50), static_cast<unsigned long>(result.rtt90), static_cast<unsigned long>(result.rtt99),
+                static_cast<unsigned long>(result.rttMax));
+        }
+        else if (result.bytes) {
+            std::printf("%-13s %10.2f Mbit/s, %llu bytes\n", NetBench::GetTestName(static_cast<NetTest>(i)), result.mbitPerSecond,
+                static_cast<unsigned long long>(result.bytes));
+        }
+    }
+
+    if (R_FAILED(ret)) {
+        std::fprintf(stderr, "test failed: %s\n", std::strerror(-ret));
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <3ds.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "netbench.h"
+
+// Companion server for the Tools page network test. One poll() loop serves any number of consoles: a TCP connection
+// opens with a NetBenchRequest and is then either drained and answered with the byte count (upload) or sent the
+// requested bytes and closed (download). UDP datagrams to the same port are echoed back unchanged.
+//   netserver [--port N] [--bind address]
+
+typedef enum {
+    STATE_HEADER = 0,
+    STATE_UPLOAD,
+    STATE_ACKNOWLEDGE,
+    STATE_DOWNLOAD
+} ConnectionState;
+
+typedef struct {
+    int fd;
+    ConnectionState state;
+    NetBenchRequest request;
+    u32 header;             // Bytes of the request read so far
+    u64 moved;
+    u32 acknowledged;       // Bytes of the count sent so far
+} Connection;
+
+static const u32 serverBufferSize = 1024 * 1024;
+static u8 serverBuffer[serverBufferSize];
+
+static int SetNonBlocking(int fd) {
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static int OpenSocket(int type, const sockaddr_in &address) {
+    int fd = socket(AF_INET, type, 0), reuse = 1;
+
+    if (fd < 0) {
+        std::perror("socket");
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if ((bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) || (SetNonBlocking(fd) != 0) ||
+        ((type == SOCK_STREAM) && (listen(fd, 8) != 0))) {
+        std::perror("bind");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void Echo(int fd) {
+    sockaddr_in peer;
+    socklen_t length = sizeof(peer);
+    ssize_t bytes = 0;
+
+    while ((bytes = recvfrom(fd, serverBuffer, serverBufferSize, 0, reinterpret_cast<sockaddr *>(&peer), &length)) >= 0) {
+        sendto(fd, serverBuffer, bytes, 0, reinterpret_cast<const sockaddr *>(&peer), length);
+        length = sizeof(peer);
+    }
+}
+
+// Makes as much progress as the socket allows without blocking. Returns false once the connection is finished with.
+static bool Service(Connection &connection) {
+    while (true) {
+        ssize_t bytes = 0;
+
+        if (connection.state == STATE_HEADER) {
+            bytes = recv(connection.fd, reinterpret_cast<u8 *>(&connection.request) + connection.header, sizeof(NetBenchRequest) - connection.header, 0);
+
+            if ((bytes > 0) && ((connection.header += bytes) == sizeof(NetBenchRequest))) {
+                if (connection.request.magic != NetBench::magic) {
+                    std::fprintf(stderr, "bad request, closing\n");
+                    return false;
+                }
+
+                connection.state = connection.request.mode == NET_TEST_TCP_UPLOAD? STATE_UPLOAD : STATE_DOWNLOAD;
+            }
+        }
+        else if (connection.state == STATE_UPLOAD) {
+            u64 left = connection.request.bytes - connection.moved;
+            bytes = left? recv(connection.fd, serverBuffer, left < serverBufferSize? left : serverBufferSize, 0) : 1;
+
+            if ((bytes > 0) && left && ((connection.moved += bytes) < connection.request.bytes)) {
+                continue;
+            }
+
+            if (bytes > 0) {
+                connection.state = STATE_ACKNOWLEDGE;
+            }
+        }
+        else if (connection.state == STATE_ACKNOWLEDGE) {
+            bytes = send(connection.fd, reinterpret_cast<u8 *>(&connection.moved) + connection.acknowledged, sizeof(connection.moved) - connection.acknowledged, MSG_NOSIGNAL);
+
+            if ((bytes > 0) && ((connection.acknowledged += bytes) == sizeof(connection.moved))) {
+                return false;
+            }
+        }
+        else {
+            u64 left = connection.request.bytes - connection.moved;
+
+            if (left == 0) {
+                return false;
+            }
+
+            bytes = send(connection.fd, serverBuffer, left < serverBufferSize? left : serverBufferSize, MSG_NOSIGNAL);
+
+            if (bytes > 0) {
+                connection.moved += bytes;
+            }
+        }
+
+        if (bytes == 0) {
+            return false;
+        }
+        else if (bytes < 0) {
+            return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(NetBench::defaultPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if ((argc % 2) != 1) {
+        std::fprintf(stderr, "usage: %s [--port N] [--bind address]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) {
+            address.sin_port = htons(static_cast<u16>(std::strtoul(argv[i + 1], nullptr, 0)));
+        }
+        else if ((std::strcmp(argv[i], "--bind") == 0) && (inet_pton(AF_INET, argv[i + 1], &address.sin_addr) == 1)) {
+            continue;
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option or bad address\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int listener = OpenSocket(SOCK_STREAM, address), echo = OpenSocket(SOCK_DGRAM, address);
+
+    if ((listener < 0) || (echo < 0)) {
+        return 1;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::memset(serverBuffer, 0x5A, serverBufferSize);
+    std::printf("listening on %s:%u (TCP and UDP)\n", inet_ntoa(address.sin_addr), ntohs(address.sin_port));
+    std::fflush(stdout);
+
+    std::vector<Connection> connections;
+    std::vector<pollfd> fds;
+
+    while (true) {
+        fds.clear();
+        fds.push_back({ listener, POLLIN, 0 });
+        fds.push_back({ echo, POLLIN, 0 });
+
+        for (const Connection &connection : connections) {
+            bool sending = (connection.state == STATE_ACKNOWLEDGE) || (connection.state == STATE_DOWNLOAD);
+            fds.push_back({ connection.fd, static_cast<short>(sending? POLLOUT : POLLIN), 0 });
+        }
+
+        if ((poll(fds.data(), fds.size(), -1) < 0) && (errno != EINTR)) {
+            std::perror("poll");
+            return 1;
+        }
+
+        if (fds[1].revents) {
+            Echo(echo);
+        }
+
+        // Connections are serviced back to front so finished ones can be swapped out without skipping any.
+        for (size_t i = connections.size(); i-- > 0;) {
+            if (fds[i + 2].revents && !Service(connections[i])) {
+                close(connections[i].fd);
+                connections[i] = connections.back();
+                connections.pop_back();
+            }
+        }
+
+        if (fds[0].revents) {
+            int fd = -1;
+
+            while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+                Connection connection;
+                std::memset(&connection, 0, sizeof(connection));
+                connection.fd = fd;
+                SetNonBlocking(fd);
+                connections.push_back(connection);
+            }
+        }
+    }
+}
@@ -0,0 +1,374 @@
+#include <3ds.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "probe.h"
+#include "snapshot.h"
+
+// Runs the probe worker on real host threads against stubbed services. Every Service::Get* fills its group with a
+// byte pattern unique to the run, so a group copied to the wrong place, torn by a concurrent Read() or left over from
+// an earlier run shows up. Prints a line per scenario and exits non-zero if any check fails.
+//   probetest
+
+typedef std::chrono::steady_clock Clock;
+
+struct Thread_tag {
+    std::thread thread;
+};
+
+static std::atomic<bool> hostThreads;
+static std::atomic<u8> probeSeed;
+static std::atomic<int> probeDelay, probeHold, probesStarted, probesFinished, serviceInits, serviceExits;
+static std::atomic<bool> probeHeld;
+static std::atomic<int> snapshotLoads, snapshotMerges, snapshotSaves;
+static u32 snapshotCached = 0, snapshotSaveMask = 0;
+static u8 snapshotSeed = 0;
+static u32 probeFailures = 0;
+
+// Real threads and a spinning LightLock in place of the single threaded ones in stub.cpp.
+Thread threadCreate(ThreadFunc entrypoint, void *arg, size_t stack_size, int prio, int core_id, bool detached) {
+    return hostThreads.load()? new Thread_tag { std::thread(entrypoint, arg) } : nullptr;
+}
+
+Result threadJoin(Thread thread, u64 timeout_ns) {
+    thread->thread.join();
+    return 0;
+}
+
+void threadFree(Thread thread) {
+    delete thread;
+}
+
+void LightLock_Init(LightLock *lock) {
+    std::atomic_ref<s32>(*lock).store(1);
+}
+
+void LightLock_Lock(LightLock *lock) {
+    std::atomic_ref<s32> ref(*lock);
+
+    for (s32 expected = 1; !ref.compare_exchange_weak(expected, 0, std::memory_order_acquire); expected = 1) {
+        std::this_thread::yield();
+    }
+}
+
+void LightLock_Unlock(LightLock *lock) {
+    std::atomic_ref<s32>(*lock).store(1, std::memory_order_release);
+}
+
+// Seed of the pattern a group holds, distinct for each group and run.
+static u8 GetSeed(u8 seed, ProbeId id) {
+    return static_cast<u8>(seed * 16 + id + 1);
+}
+
+template<typename T> static T Fill(ProbeId id) {
+    T value;
+    bool hold = probeHold.load() == id;
+    probesStarted++;
+
+    if (hold) {
+        probeHeld.store(true);
+    }
+
+    // The held probe stays in flight long enough for the test to call Stop() under it.
+    std::memset(std::addressof(value), GetSeed(probeSeed.load(), id), sizeof(T));
+    std::this_thread::sleep_for(std::chrono::milliseconds(hold? 100 : probeDelay.load()));
+    probesFinished++;
+    return value;
+}
+
+namespace Service {
+    void Init(void) {
+        serviceInits++;
+    }
+
+    void Exit(void) {
+        serviceExits++;
+    }
+
+    KernelInfo GetKernelInfo(void) {
+        return Fill<KernelInfo>(PROBE_KERNEL_INFO);
+    }
+
+    SystemInfo GetSystemInfo(void) {
+        return Fill<SystemInfo>(PROBE_SYSTEM_INFO);
+    }
+
+    NNIDInfo GetNNIDInfo(void) {
+        return Fill<NNIDInfo>(PROBE_NNID_INFO);
+    }
+
+    ConfigInfo GetConfigInfo(void) {
+        return Fill<ConfigInfo>(PROBE_CONFIG_INFO);
+    }
+
+    HardwareInfo GetHardwareInfo(void) {
+        return Fill<HardwareInfo>(PROBE_HARDWARE_INFO);
+    }
+
+    WifiInfo GetWifiInfo(void) {
+        return Fill<WifiInfo>(PROBE_WIFI_INFO);
+    }
+
+    StorageInfo GetStorageInfo(void) {
+        return Fill<StorageInfo>(PROBE_STORAGE_INFO);
+    }
+
+    MiscInfo GetMiscInfo(void) {
+        return Fill<MiscInfo>(PROBE_MISC_INFO);
+    }
+
+    SystemStateInfo GetSystemStateInfo(void) {
+        return Fill<SystemStateInfo>(PROBE_SYSTEM_STATE_INFO);
+    }
+}
+
+template<typename T> static bool IsFilled(const T &field, u8 seed) {
+    const u8 *bytes = reinterpret_cast<const u8 *>(std::addressof(field));
+
+    for (u32 i = 0; i < sizeof(T); i++) {
+        if (bytes[i] != seed) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Struct copies needn't keep padding bytes, so only the first and last fields of each group are compared. A copy at
+// the wrong offset or of the wrong size, or one torn by the worker, gets at least one of them wrong.
+static bool IsIntact(const ProbeResults &results, ProbeId id, u8 seed) {
+    switch (id) {
+        case PROBE_KERNEL_INFO:
+            return IsFilled(results.kernelInfo.kernelVersion, seed) && IsFilled(results.kernelInfo.deviceId, seed);
+
+        case PROBE_SYSTEM_INFO:
+            return IsFilled(results.systemInfo.model, seed) && IsFilled(results.systemInfo.soapId, seed);
+
+        case PROBE_NNID_INFO:
+            return IsFilled(results.nnidInfo.persistentID, seed) && IsFilled(results.nnidInfo.nfsPassword, seed);
+
+        case PROBE_CONFIG_INFO:
+            return IsFilled(results.configInfo.username, seed) && IsFilled(results.configInfo.parentalSecretAnswer, seed);
+
+        case PROBE_HARDWARE_INFO:
+            return IsFilled(results.hardwareInfo.screenUpper, seed) && IsFilled(results.hardwareInfo.soundOutputMode, seed);
+
+        case PROBE_WIFI_INFO:
+            return IsFilled(results.wifiInfo.ssid, seed) && IsFilled(results.wifiInfo.securityMode, seed);
+
+        case PROBE_STORAGE_INFO:
+            return IsFilled(results.storageInfo.resource, seed) && IsFilled(results.storageInfo.totalSizeString, seed);
+
+        case PROBE_MISC_INFO:
+            return IsFilled(results.miscInfo.sdTitleCount, seed) && IsFilled(results.miscInfo.manufacturingDate, seed);
+
+        case PROBE_SYSTEM_STATE_INFO:
+            return IsFilled(results.systemStateInfo.consoleInfo, seed) && IsFilled(results.systemStateInfo.rawButtonState, seed);
+
+        default:
+            return false;
+    }
+}
+
+static void CopyGroup(ProbeId id, ProbeResults &results, const ProbeResults &from) {
+    switch (id) {
+        case PROBE_KERNEL_INFO: results.kernelInfo = from.kernelInfo; break;
+        case PROBE_SYSTEM_INFO: results.systemInfo = from.systemInfo; break;
+        case PROBE_NNID_INFO: results.nnidInfo = from.nnidInfo; break;
+        case PROBE_CONFIG_INFO: results.configInfo = from.configInfo; break;
+        case PROBE_HARDWARE_INFO: results.hardwareInfo = from.hardwareInfo; break;
+        case PROBE_WIFI_INFO: results.wifiInfo = from.wifiInfo; break;
+        case PROBE_STORAGE_INFO: results.storageInfo = from.storageInfo; break;
+        case PROBE_MISC_INFO: results.miscInfo = from.miscInfo; break;
+        case PROBE_SYSTEM_STATE_INFO: results.systemStateInfo = from.systemStateInfo; break;
+        default: break;
+    }
+}
+
+// Stands in for the snapshot file: Load() hands out the groups in snapshotCached filled with snapshotSeed, Merge()
+// takes the fresh group whole and Save() only records the call.
+namespace Snapshot {
+    u32 Load(const char *path, ProbeResults &results) {
+        ProbeResults cached;
+        snapshotLoads++;
+        std::memset(std::addressof(results), 0, sizeof(ProbeResults));
+
+        for (int i = 0; i < PROBE_MAX; i++) {
+            if (snapshotCached & BIT(i)) {
+                std::memset(std::addressof(cached), GetSeed(snapshotSeed, static_cast<ProbeId>(i)), sizeof(ProbeResults));
+                CopyGroup(static_cast<ProbeId>(i), results, cached);
+            }
+        }
+
+        return snapshotCached;
+    }
+
+    u32 Merge(ProbeId id, ProbeResults &results, const ProbeResults &fresh) {
+        snapshotMerges++;
+        CopyGroup(id, results, fresh);
+        return 1;
+    }
+
+    bool Save(const char *path, const ProbeResults &results, u32 mask) {
+        snapshotSaves++;
+        snapshotSaveMask = mask;
+        return true;
+    }
+}
+
+static void Expect(const char *scenario, bool condition, const char *what) {
+    if (!condition) {
+        std::printf("FAIL %s: %s\n", scenario, what);
+        probeFailures++;
+    }
+}
+
+static void Prepare(u8 seed, int delay, int hold, u32 cached, bool threads) {
+    probeSeed.store(seed);
+    probeDelay.store(delay);
+    probeHold.store(hold);
+    probeHeld.store(false);
+    probesStarted.store(0);
+    probesFinished.store(0);
+    serviceInits.store(0);
+    serviceExits.store(0);
+    snapshotLoads.store(0);
+    snapshotMerges.store(0);
+    snapshotSaves.store(0);
+    snapshotCached = cached;
+    snapshotSaveMask = 0;
+    snapshotSeed = static_cast<u8>(seed + 8);
+    hostThreads.store(threads);
+}
+
+// Checks every group the mask claims against the pattern of this run, or of the snapshot for groups still cached.
+static bool CheckRead(u32 &mask, u32 cachedValid) {
+    static ProbeResults results;
+    mask = Probe::Read(results);
+
+    for (int i = 0; i < PROBE_MAX; i++) {
+        ProbeId id = static_cast<ProbeId>(i);
+
+        if ((mask & BIT(i)) && (!IsIntact(results, id, GetSeed(probeSeed.load(), id))) &&
+            ((!(cachedValid & BIT(i))) || (!IsIntact(results, id, GetSeed(snapshotSeed, id))))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool WaitFor(u32 expected, u32 cachedValid, u32 &reads, bool &intact) {
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    u32 mask = 0;
+
+    while (Clock::now() < deadline) {
+        intact &= CheckRead(mask, cachedValid);
+        reads++;
+
+        if (mask == expected) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void Report(const char *scenario, u32 failures, double elapsed) {
+    std::printf("%s %s: %d probes, %.1f ms\n", probeFailures == failures? "ok  " : "FAIL", scenario, probesFinished.load(), elapsed * 1000.0);
+}
+
+int main(int argc, char *argv[]) {
+    const u32 all = BIT(PROBE_MAX) - 1;
+
+    // Reads race the worker the whole way through, every group has to show up intact.
+    {
+        const char *scenario = "all probes, concurrent reads";
+        u32 failures = probeFailures, reads = 0;
+        bool intact = true;
+        Prepare(1, 2, -1, 0, true);
+        Clock::time_point start = Clock::now();
+
+        Probe::Start();
+        Expect(scenario, WaitFor(all, 0, reads, intact), "ready mask never filled");
+        Probe::Stop();
+        Expect(scenario, intact, "a read returned a group that wasn't intact");
+
+        u32 mask = 0;
+        Expect(scenario, CheckRead(mask, 0) && (mask == all), "results not intact after Stop()");
+        Expect(scenario, probesFinished.load() == PROBE_MAX, "not every probe ran once");
+        Expect(scenario, snapshotLoads.load() == 1, "snapshot not loaded once");
+        Expect(scenario, (serviceInits.load() == 1) && (serviceExits.load() == 1), "services not initialised and released once");
+        Expect(scenario, (snapshotSaves.load() == 1) && (snapshotSaveMask == all), "snapshot not saved once with every group");
+        Report(scenario, failures, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    // Cached groups are ready before the worker gets to them, and are merged rather than overwritten.
+    {
+        const char *scenario = "cached groups";
+        const u32 cached = BIT(PROBE_KERNEL_INFO) | BIT(PROBE_STORAGE_INFO);
+        u32 failures = probeFailures, reads = 0, mask = 0;
+        bool intact = true;
+        Prepare(2, 2, -1, cached, true);
+        Clock::time_point start = Clock::now();
+
+        Probe::Start();
+        intact &= CheckRead(mask, cached);
+        Expect(scenario, (mask & cached) == cached, "cached groups not ready straight away");
+        Expect(scenario, WaitFor(all, cached, reads, intact), "ready mask never filled");
+        Probe::Stop();
+        Expect(scenario, intact, "a read returned a group that wasn't intact");
+        Expect(scenario, CheckRead(mask, 0) && (mask == all), "cached groups not replaced by the fresh ones");
+        Expect(scenario, snapshotMerges.load() == 2, "cached groups not merged");
+        Expect(scenario, snapshotSaves.load() == 1, "changed snapshot not saved");
+        Report(scenario, failures, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    // Stop() while a slow probe is running waits for that probe, then the worker quits without starting another.
+    {
+        const char *scenario = "Stop() with a probe in flight";
+        u32 failures = probeFailures, mask = 0;
+        Prepare(3, 0, PROBE_CONFIG_INFO, 0, true);
+
+        Probe::Start();
+
+        while (!probeHeld.load()) {
+            std::this_thread::yield();
+        }
+
+        Clock::time_point start = Clock::now();
+        Probe::Stop();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        int started = probesStarted.load();
+        Expect(scenario, started == PROBE_CONFIG_INFO + 1, "worker kept probing after Stop()");
+        Expect(scenario, probesFinished.load() == started, "Stop() returned with a probe still running");
+        Expect(scenario, CheckRead(mask, 0) && (mask == BIT(started) - 1), "ready mask doesn't match the probes that ran");
+        Expect(scenario, serviceExits.load() == 1, "services not released");
+        Expect(scenario, snapshotSaves.load() == 0, "incomplete results saved");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Expect(scenario, probesStarted.load() == started, "a probe ran after Stop() returned");
+        Report(scenario, failures, elapsed);
+    }
+
+    // Without a thread Start() probes on the caller, everything is ready once it returns.
+    {
+        const char *scenario = "synchronous fallback";
+        u32 failures = probeFailures, mask = 0;
+        Prepare(4, 0, -1, 0, false);
+        Clock::time_point start = Clock::now();
+
+        Probe::Start();
+        Expect(scenario, CheckRead(mask, 0) && (mask == all), "results not ready when Start() returned");
+        Probe::Stop();
+        Expect(scenario, snapshotSaves.load() == 1, "snapshot not saved");
+        Report(scenario, failures, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    std::printf("%u failures\n", probeFailures);
+    return probeFailures? 1 : 0;
+}
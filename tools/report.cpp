@@ -0,0 +1,45 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstring>
+
+#include "export.h"
+#include "snapshot.h"
+
+// Converts a snapshot cache pulled from a device into a report, through the same exporter and POSIX writer
+// backend the app uses.
+//   report <3dsident_cache.bin> <json|csv|bin> <output> [--show-private]
+
+int main(int argc, char *argv[]) {
+    const char *formats[EXPORT_FORMAT_MAX] = { "json", "csv", "bin" };
+    int format = EXPORT_FORMAT_MAX;
+
+    for (int i = 0; (argc >= 4) && (i < EXPORT_FORMAT_MAX); i++) {
+        if (std::strcmp(argv[2], formats[i]) == 0) {
+            format = i;
+        }
+    }
+
+    if ((argc < 4) || (argc > 5) || (format == EXPORT_FORMAT_MAX)) {
+        std::fprintf(stderr, "usage: %s <3dsident_cache.bin> <json|csv|bin> <output> [--show-private]\n", argv[0]);
+        return 1;
+    }
+
+    static ProbeResults results;
+    u32 mask = Snapshot::Load(argv[1], results);
+
+    if (!mask) {
+        std::fprintf(stderr, "%s: not a valid snapshot\n", argv[1]);
+        return 1;
+    }
+
+    static FileWriter writer;
+    bool displayInfo = (argc == 5) && (std::strcmp(argv[4], "--show-private") == 0);
+
+    if (R_FAILED(Writer::Open(writer, WRITER_BACKEND_POSIX, argv[3]))) {
+        std::fprintf(stderr, "%s: can't open for writing\n", argv[3]);
+        return 1;
+    }
+
+    Export::Write(writer, static_cast<ExportFormat>(format), results, mask, displayInfo);
+    return R_SUCCEEDED(Writer::Close(writer))? 0 : 1;
+}
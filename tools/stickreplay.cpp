@@ -0,0 +1,69 @@
+#include <3ds.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "stickstats.h"
+
+// Runs a stick trace saved by the button tester (/3ds/3dsident_sticks.csv) through the same statistics the
+// device computes, so thresholds can be tuned against recorded units.
+//   stickreplay <3dsident_sticks.csv> [--dead-zone N]
+
+static void Print(const char *name, const StickInfo &info) {
+    std::printf("%s: %lu samples\n", name, static_cast<unsigned long>(info.count));
+    std::printf("  mean %+.2f, %+.2f  sd %.2f, %.2f  range x [%d, %d] y [%d, %d]\n", info.meanX, info.meanY, StickStats::GetStdDevX(info),
+        StickStats::GetStdDevY(info), info.minX, info.maxX, info.minY, info.maxY);
+    std::printf("  dead zone %lu: %.2f%% outside, %lu excursions, max radius %lu\n", static_cast<unsigned long>(info.deadZone),
+        info.count? (info.outside * 100.0) / info.count : 0.0, static_cast<unsigned long>(info.excursions), static_cast<unsigned long>(info.maxRadius));
+    std::printf("  %lu of 1024 occupancy cells visited\n", static_cast<unsigned long>(info.coveredCells));
+}
+
+int main(int argc, char *argv[]) {
+    u32 deadZone = 15;
+
+    if ((argc == 4) && (std::strcmp(argv[2], "--dead-zone") == 0)) {
+        deadZone = std::strtoul(argv[3], nullptr, 0);
+    }
+    else if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <3dsident_sticks.csv> [--dead-zone N]\n", argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = std::fopen(argv[1], "r");
+    if (!file) {
+        std::fprintf(stderr, "%s: can't open\n", argv[1]);
+        return 1;
+    }
+
+    static StickInfo pad, stick;
+    StickStats::Init(pad, deadZone);
+    StickStats::Init(stick, deadZone);
+
+    char line[128];
+    unsigned long long first = 0, last = 0;
+
+    while (std::fgets(line, sizeof(line), file)) {
+        unsigned long long tick = 0;
+        int padX = 0, padY = 0, stickX = 0, stickY = 0;
+
+        if (std::sscanf(line, "%llu,%d,%d,%d,%d", &tick, &padX, &padY, &stickX, &stickY) != 5) {
+            continue;
+        }
+
+        first = pad.count? first : tick;
+        last = tick;
+        StickStats::Add(pad, padX, padY);
+        StickStats::Add(stick, stickX, stickY);
+    }
+
+    std::fclose(file);
+
+    if (pad.count > 1) {
+        std::printf("%.3f s, %.1f samples/s\n", (last - first) / static_cast<double>(SYSCLOCK_ARM11),
+            (pad.count - 1) / ((last - first) / static_cast<double>(SYSCLOCK_ARM11)));
+    }
+
+    Print("Circle pad", pad);
+    Print("C stick", stick);
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include <3ds.h>
+#include <cstring>
+
+// Host definitions for the libctru functions declared in include/3ds.h. Services report failure, except where a
+// benchmark needs a successful call to reach the code it measures.
+
+static const Result stubResult = static_cast<Result>(0xD8E0FFFF);
+
+osSharedConfig_s hostSharedConfig = { 0, 1, 0, { 0 }, { 0x40, 0xF4, 0x07, 0x12, 0x34, 0x56 }, 3, 0 };
+osKernelConfig_s hostKernelConfig = { 1 };
+const char *hostFileData = nullptr;
+u64 hostFileSize = 0;
+
+u64 osGetTime(void) {
+    return 0;
+}
+
+u32 osGetKernelVersion(void) {
+    return (2 << 24) | (57 << 16) | (0 << 8);
+}
+
+Result osGetSystemVersionDataString(OS_VersionBin *nver, OS_VersionBin *cver, char *sysverstr, u32 sysverstr_maxsize) {
+    return stubResult;
+}
+
+// Same contract as libctru: converts up to the NUL terminator, writes at most len units and returns the
+// number of units the full conversion needs.
+ssize_t utf16_to_utf8(u8 *out, const u16 *in, size_t len) {
+    ssize_t rc = 0;
+
+    while (*in) {
+        u32 code = *in++;
+
+        if ((code >= 0xD800) && (code < 0xDC00)) {
+            if ((*in < 0xDC00) || (*in > 0xDFFF)) {
+                return -1;
+            }
+
+            code = 0x10000 + ((code - 0xD800) << 10) + (*in++ - 0xDC00);
+        }
+        else if ((code >= 0xDC00) && (code <= 0xDFFF)) {
+            return -1;
+        }
+
+        u8 encoded[4];
+        ssize_t units = 0;
+
+        if (code < 0x80) {
+            encoded[units++] = code;
+        }
+        else if (code < 0x800) {
+            encoded[units++] = 0xC0 | (code >> 6);
+            encoded[units++] = 0x80 | (code & 0x3F);
+        }
+        else if (code < 0x10000) {
+            encoded[units++] = 0xE0 | (code >> 12);
+            encoded[units++] = 0x80 | ((code >> 6) & 0x3F);
+            encoded[units++] = 0x80 | (code & 0x3F);
+        }
+        else {
+            encoded[units++] = 0xF0 | (code >> 18);
+            encoded[units++] = 0x80 | ((code >> 12) & 0x3F);
+            encoded[units++] = 0x80 | ((code >> 6) & 0x3F);
+            encoded[units++] = 0x80 | (code & 0x3F);
+        }
+
+        if (out && (static_cast<size_t>(rc + units) <= len)) {
+            std::memcpy(out, encoded, units);
+            out += units;
+        }
+
+        rc += units;
+    }
+
+    return rc;
+}
+
+Result svcGetThreadPriority(s32 *out, Handle handle) {
+    *out = 0x30;
+    return 0;
+}
+
+// No threads on the host, callers take their failure path (Log::Open reports an error and logging stays off). The
+// thread and lock functions are weak, a tool that needs real threads defines its own (see probetest.cpp).
+__attribute__((weak)) Thread threadCreate(ThreadFunc entrypoint, void *arg, size_t stack_size, int prio, int core_id, bool detached) {
+    return nullptr;
+}
+
+__attribute__((weak)) Result threadJoin(Thread thread, u64 timeout_ns) {
+    return stubResult;
+}
+
+__attribute__((weak)) void threadFree(Thread thread) {
+}
+
+// No locking needed while there are no threads.
+__attribute__((weak)) void LightLock_Init(LightLock *lock) {
+    *lock = 1;
+}
+
+__attribute__((weak)) void LightLock_Lock(LightLock *lock) {
+}
+
+__attribute__((weak)) void LightLock_Unlock(LightLock *lock) {
+}
+
+void LightEvent_Init(LightEvent *event, ResetType reset_type) {
+    event->state = reset_type == RESET_ONESHOT? -1 : -2;
+    event->lock = 0;
+}
+
+void LightEvent_Signal(LightEvent *event) {
+}
+
+int LightEvent_WaitTimeout(LightEvent *event, s64 timeout_in_ns) {
+    return 1;
+}
+
+Result APT_CheckNew3DS(bool *out) {
+    *out = false;
+    return 0;
+}
+
+FS_Path fsMakePath(FS_PathType type, const void *path) {
+    FS_Path fsPath = { type, 0, path };
+
+    if (type == PATH_ASCII) {
+        fsPath.size = std::strlen(static_cast<const char *>(path)) + 1;
+    }
+    else if (type == PATH_EMPTY) {
+        fsPath.size = 1;
+        fsPath.data = "";
+    }
+
+    return fsPath;
+}
+
+Result FSUSER_OpenArchive(FS_Archive *archive, FS_ArchiveID id, FS_Path path) {
+    return stubResult;
+}
+
+Result FSUSER_CloseArchive(FS_Archive archive) {
+    return stubResult;
+}
+
+Result FSUSER_OpenFile(Handle *out, FS_Archive archive, FS_Path path, u32 openFlags, u32 attributes) {
+    return stubResult;
+}
+
+Result FSUSER_OpenFileDirectly(Handle *out, FS_ArchiveID archiveId, FS_Path archivePath, FS_Path filePath, u32 openFlags, u32 attributes) {
+    if (!hostFileData) {
+        return stubResult;
+    }
+
+    *out = 1;
+    return 0;
+}
+
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 fileSize) {
+    return stubResult;
+}
+
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path) {
+    return stubResult;
+}
+
+Result FSUSER_GetSdmcCid(u8 *out, u32 length) {
+    for (u32 i = 0; i < length; i++) {
+        out[i] = 0x1B + (i * 0x1F);
+    }
+
+    return 0;
+}
+
+Result FSUSER_GetNandCid(u8 *out, u32 length) {
+    for (u32 i = 0; i < length; i++) {
+        out[i] = 0xFE - (i * 0x0D);
+    }
+
+    return 0;
+}
+
+Result FSFILE_Read(Handle handle, u32 *bytesRead, u64 offset, void *buffer, u32 size) {
+    if ((handle != 1) || (!hostFileData)) {
+        return stubResult;
+    }
+
+    u64 remaining = offset < hostFileSize? hostFileSize - offset : 0;
+    *bytesRead = remaining < size? static_cast<u32>(remaining) : size;
+    std::memcpy(buffer, hostFileData + offset, *bytesRead);
+    return 0;
+}
+
+Result FSFILE_Write(Handle handle, u32 *bytesWritten, u64 offset, const void *buffer, u32 size, u32 flags) {
+    return stubResult;
+}
+
+Result FSFILE_GetSize(Handle handle, u64 *size) {
+    if ((handle != 1) || (!hostFileData)) {
+        return stubResult;
+    }
+
+    *size = hostFileSize;
+    return 0;
+}
+
+Result FSFILE_SetSize(Handle handle, u64 size) {
+    return stubResult;
+}
+
+Result FSFILE_Close(Handle handle) {
+    return handle == 1? 0 : stubResult;
+}
+
+Result FSFILE_Flush(Handle handle) {
+    return stubResult;
+}
+
+Result amInit(void) {
+    return stubResult;
+}
+
+void amExit(void) {
+}
+
+Result AM_GetDeviceId(u32 *deviceID) {
+    return stubResult;
+}
+
+Result AM_GetTitleCount(FS_MediaType mediatype, u32 *count) {
+    return stubResult;
+}
+
+Result AM_GetTitleList(u32 *titlesRead, FS_MediaType mediatype, u32 titleCount, u64 *titleIds) {
+    return stubResult;
+}
+
+Result AM_GetTicketCount(u32 *count) {
+    return stubResult;
+}
+
+Result AM_GetTicketList(u32 *ticketsRead, u32 ticketCount, u32 skip, u64 *ticketIds) {
+    return stubResult;
+}
+
+Result CFGU_GetSystemModel(u8 *model) {
+    return stubResult;
+}
+
+Result CFGU_SecureInfoGetRegion(u8 *region) {
+    return stubResult;
+}
+
+Result CFGU_GetRegionCanadaUSA(u8 *value) {
+    return stubResult;
+}
+
+Result CFGU_GetSystemLanguage(u8 *language) {
+    return stubResult;
+}
+
+Result CFGI_GetLocalFriendCodeSeed(u64 *seed) {
+    return stubResult;
+}
+
+Result CFGI_SecureInfoGetSerialNumber(u8 *serial) {
+    return stubResult;
+}
@@ -0,0 +1,100 @@
+#include <3ds.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "telemetry.h"
+
+// Drives the telemetry push engine from the host at a fixed datagram rate with made-up values, to load a collector over
+// loopback or across the LAN far beyond what one console sends.
+//   telemetrysend <host> [--port N] [--rate datagrams/s] [--seconds N] [--batch samples]
+
+typedef std::chrono::steady_clock Clock;
+
+// The sampling thread in telemetry.cpp reads the sampler, but threads aren't available on the host and it never runs.
+namespace Sampler {
+    bool Read(LiveInfo &info) {
+        return false;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    TelemetryConfig config;
+    unsigned rate = 2000, seconds = 3;
+    Telemetry::GetDefaultConfig(config);
+
+    if ((argc < 2) || ((argc % 2) != 0)) {
+        std::fprintf(stderr, "usage: %s <host> [--port N] [--rate datagrams/s] [--seconds N] [--batch samples]\n", argv[0]);
+        return 1;
+    }
+
+    config.host = argv[1];
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        u32 value = std::strtoul(argv[i + 1], nullptr, 0);
+
+        if (std::strcmp(argv[i], "--port") == 0) {
+            config.port = static_cast<u16>(value);
+        }
+        else if (std::strcmp(argv[i], "--rate") == 0) {
+            rate = value;
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = value;
+        }
+        else if (std::strcmp(argv[i], "--batch") == 0) {
+            config.batch = value;
+        }
+        else {
+            std::fprintf(stderr, "%s: unknown option\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Result ret = Telemetry::Open(config);
+
+    if (R_FAILED(ret)) {
+        std::fprintf(stderr, "can't open: %s\n", std::strerror(-ret));
+        return 1;
+    }
+
+    LiveInfo info;
+    TelemetrySample sample;
+    std::memset(&info, 0, sizeof(info));
+    info.valid = BIT(SAMPLER_FIELD_BATTERY_PERCENTAGE) | BIT(SAMPLER_FIELD_BATTERY_VOLTAGE) | BIT(SAMPLER_FIELD_BATTERY_TEMPERATURE) |
+        BIT(SAMPLER_FIELD_WIFI_STRENGTH);
+
+    Clock::time_point start = Clock::now(), deadline = start + std::chrono::seconds(seconds);
+    u64 datagrams = 0, samples = 0;
+
+    // Catches up in bursts after each millisecond sleep, so the rate holds on average rather than per datagram.
+    while (Clock::now() < deadline) {
+        u64 due = static_cast<u64>(std::chrono::duration<double>(Clock::now() - start).count() * rate);
+
+        for (; datagrams < due; datagrams++) {
+            for (u32 i = 0; i < config.batch; i++, samples++) {
+                info.batteryPercentage = 100 - (samples % 100);
+                info.batteryVoltage = 200 + (samples % 20);
+                info.batteryTemperature = 25 + (samples % 10);
+                info.wifiStrength = samples % 4;
+                Telemetry::MakeSample(sample, info, static_cast<u32>(samples));
+                sample.frameTimeAvg = 16667;
+                sample.frameTimeMax = 16667 + (samples % 1000);
+                Telemetry::Add(sample);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    TelemetryStats stats;
+    Telemetry::Close();
+    Telemetry::GetStats(stats);
+    std::printf("session %08lx: %lu datagrams (%.0f/s), %lu samples, %llu bytes, %lu failed sends\n", static_cast<unsigned long>(stats.session),
+        static_cast<unsigned long>(stats.datagrams), stats.datagrams / elapsed, static_cast<unsigned long>(stats.samples),
+        static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long>(stats.errors));
+    return stats.errors? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#include <3ds.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "tickets.h"
+
+// Checks Tickets::Join against std::set_difference on synthetic ticket and title lists, and times it.
+//   ticketjoin [entries, default 100000] [seed]
+
+static std::vector<u64> MakeIds(std::mt19937_64 &random, const std::vector<u64> &shared, u32 count) {
+    std::vector<u64> ids(shared);
+
+    while (ids.size() < count) {
+        ids.push_back(0x0004000000000000ULL | (random() & 0x0000FFFFFFFFFFFFULL));
+    }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+int main(int argc, char *argv[]) {
+    u32 entries = argc > 1? std::strtoul(argv[1], nullptr, 0) : 100000;
+    std::mt19937_64 random(argc > 2? std::strtoull(argv[2], nullptr, 0) : 1);
+
+    // Most titles have their ticket, a few percent on either side don't.
+    std::vector<u64> shared;
+    for (u32 i = 0; i < (entries * 9) / 10; i++) {
+        shared.push_back(0x0004000000000000ULL | (random() & 0x0000FFFFFFFFFFFFULL));
+    }
+
+    std::vector<u64> tickets = MakeIds(random, shared, entries), titles = MakeIds(random, shared, entries - (entries / 20));
+    std::vector<u64> orphans(tickets.size()), missing(titles.size());
+    TicketJoinCounts counts;
+
+    u64 start = svcGetSystemTick();
+    Tickets::Join(tickets.data(), tickets.size(), titles.data(), titles.size(), orphans.data(), missing.data(), counts);
+    u64 ticks = svcGetSystemTick() - start;
+
+    std::vector<u64> expectedOrphans, expectedMissing, expectedMatched;
+    std::set_difference(tickets.begin(), tickets.end(), titles.begin(), titles.end(), std::back_inserter(expectedOrphans));
+    std::set_difference(titles.begin(), titles.end(), tickets.begin(), tickets.end(), std::back_inserter(expectedMissing));
+    std::set_intersection(tickets.begin(), tickets.end(), titles.begin(), titles.end(), std::back_inserter(expectedMatched));
+
+    bool ok = (counts.matched == expectedMatched.size()) && (counts.orphanTickets == expectedOrphans.size()) &&
+        (counts.missingTickets == expectedMissing.size()) &&
+        std::equal(expectedOrphans.begin(), expectedOrphans.end(), orphans.begin()) &&
+        std::equal(expectedMissing.begin(), expectedMissing.end(), missing.begin());
+
+    std::printf("tickets %lu, titles %lu: matched %lu, orphan tickets %lu, titles without ticket %lu in %.3f ms: %s\n",
+        static_cast<unsigned long>(counts.tickets), static_cast<unsigned long>(counts.titles), static_cast<unsigned long>(counts.matched),
+        static_cast<unsigned long>(counts.orphanTickets), static_cast<unsigned long>(counts.missingTickets), ticks / CPU_TICKS_PER_MSEC,
+        ok? "ok" : "MISMATCH");
+
+    return ok? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#include <cstdio>
+#include <thread>
+
+#include "trace.h"
+
+// Records nested spans from a few threads and exports them, load the output in chrome://tracing or Perfetto
+// to check the exporter.
+static void Work(int depth) {
+    TRACE_SCOPE("Work");
+
+    volatile u32 sum = 0;
+    for (u32 i = 0; i < 100000; i++) {
+        sum = sum + i;
+    }
+
+    if (depth > 0) {
+        Work(depth - 1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1? argv[1] : "3dsident_trace.json";
+    Trace::Init();
+
+    {
+        TRACE_SCOPE("main");
+        std::thread first(Work, 3), second(Work, 5);
+        Work(2);
+        first.join();
+        second.join();
+    }
+
+    if (!Trace::Dump(path)) {
+        std::fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+
+    std::printf("Wrote %s\n", path);
+    return 0;
+}